@@ -16,7 +16,6 @@
 # along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 from gnuradio import blocks
-from gnuradio import digital
 from gnuradio import gr
 import dvbt2
 import osmosdr
@@ -24,14 +23,19 @@ import sys
 
 def main(args):
     nargs = len(args)
+    outformat = dvbt2.OUTPUT_FC32
     if nargs == 1:
         infile  = args[0]
         outfile = None
     elif nargs == 2:
         infile  = args[0]
         outfile  = args[1]
+    elif nargs == 3 and args[2] in ('fc32', 'sc16', 'sc8'):
+        infile  = args[0]
+        outfile  = args[1]
+        outformat = {'fc32': dvbt2.OUTPUT_FC32, 'sc16': dvbt2.OUTPUT_SC16, 'sc8': dvbt2.OUTPUT_SC8}[args[2]]
     else:
-        sys.stderr.write("Usage: dvbt2-blade.py input_file [output_file]\n");
+        sys.stderr.write("Usage: dvbt2-blade.py input_file [output_file [fc32|sc16|sc8]]\n");
         sys.exit(1)
 
     version = dvbt2.VERSION_111
@@ -97,39 +101,16 @@ def main(args):
     elif fft_size == dvbt2.FFTSIZE_32K_T2GI:
         fftsize = 32768
 
-    if guard_interval == dvbt2.GI_1_32:
-        gi = fftsize / 32
-    elif guard_interval == dvbt2.GI_1_16:
-        gi = fftsize / 16
-    elif guard_interval == dvbt2.GI_1_8:
-        gi = fftsize / 8
-    elif guard_interval == dvbt2.GI_1_4:
-        gi = fftsize / 4
-    elif guard_interval == dvbt2.GI_1_128:
-        gi = fftsize / 128
-    elif guard_interval == dvbt2.GI_19_128:
-        gi = (fftsize * 19) / 128
-    elif guard_interval == dvbt2.GI_19_256:
-        gi = (fftsize * 19) / 256
-
     tb = gr.top_block()
 
     src = blocks.file_source(gr.sizeof_char, infile, True)
 
-    dvbt2_bbheader = dvbt2.bbheader_bb(frame_size, code_rate, input_mode, dvbt2.INBAND_OFF, fec_blocks, 4000000)
-    dvbt2_bbscrambler = dvbt2.bbscrambler_bb(frame_size, code_rate)
-    dvbt2_bch = dvbt2.bch_bb(frame_size, code_rate)
-    dvbt2_ldpc = dvbt2.ldpc_bb(frame_size, code_rate)
-    dvbt2_interleaver = dvbt2.interleaver_bb(frame_size, code_rate, constellation)
-    dvbt2_modulator = dvbt2.modulator_bc(frame_size, constellation, rotation)
-    dvbt2_cellinterleaver = dvbt2.cellinterleaver_cc(frame_size, constellation, fec_blocks, ti_blocks)
-    dvbt2_framemapper = dvbt2.framemapper_cc(frame_size, code_rate, constellation, rotation, fec_blocks, ti_blocks, carrier_mode, fft_size, guard_interval, l1_constellation, pilot_pattern, 2, data_symbols, papr_mode, version, mode, input_mode, dvbt2.RESERVED_OFF, dvbt2.L1_SCRAMBLED_OFF, dvbt2.INBAND_OFF)
-    dvbt2_freqinterleaver = dvbt2.freqinterleaver_cc(carrier_mode, fft_size, pilot_pattern, guard_interval, data_symbols, papr_mode, version, mode)
-    dvbt2_pilotgenerator = dvbt2.pilotgenerator_cc(carrier_mode, fft_size, pilot_pattern, guard_interval, data_symbols, papr_mode, version, mode, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_ON, equalization_bandwidth, fftsize)
-    dvbt2_paprtr = dvbt2.paprtr_cc(carrier_mode, fft_size, pilot_pattern, guard_interval, data_symbols, papr_mode, version, papr_vclip, papr_iterations, fftsize)
-    digital_ofdm_cyclic_prefixer = digital.ofdm_cyclic_prefixer(fftsize, fftsize+(gi), 0, "")
-    dvbt2_p1insertion = dvbt2.p1insertion_cc(carrier_mode, fft_size, guard_interval, data_symbols, mode, dvbt2.SHOWLEVELS_OFF, 3.31)
-    blocks_multiply_const = blocks.multiply_const_vcc((0.2, ))
+    dvbt2_gateway = dvbt2.gateway_bc(frame_size, code_rate, constellation, rotation, fec_blocks, ti_blocks, carrier_mode, fft_size, guard_interval, l1_constellation, pilot_pattern, 2, data_symbols, papr_mode, version, mode, input_mode, dvbt2.RESERVED_OFF, dvbt2.L1_SCRAMBLED_OFF, dvbt2.INBAND_OFF, 4000000, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_ON, equalization_bandwidth, papr_vclip, papr_iterations)
+    if outfile:
+        conditioner_format = outformat
+    else:
+        conditioner_format = dvbt2.OUTPUT_FC32
+    dvbt2_outputconditioner = dvbt2.outputconditioner_c(0.2, dvbt2.CLIPPING_ON, 1.0, conditioner_format)
 
     out = osmosdr.sink(args="bladerf=0,buffers=128,buflen=32768")
     out.set_sample_rate(samp_rate)
@@ -139,25 +120,23 @@ def main(args):
     out.set_bb_gain(txvga1_gain, 0)
     out.set_bandwidth(bandwidth, 0)
 
-    tb.connect(src, dvbt2_bbheader)
-    tb.connect(dvbt2_bbheader, dvbt2_bbscrambler)
-    tb.connect(dvbt2_bbscrambler, dvbt2_bch)
-    tb.connect(dvbt2_bch, dvbt2_ldpc)
-    tb.connect(dvbt2_ldpc, dvbt2_interleaver)
-    tb.connect(dvbt2_interleaver, dvbt2_modulator)
-    tb.connect(dvbt2_modulator, dvbt2_cellinterleaver)
-    tb.connect(dvbt2_cellinterleaver, dvbt2_framemapper)
-    tb.connect(dvbt2_framemapper, dvbt2_freqinterleaver)
-    tb.connect(dvbt2_freqinterleaver, dvbt2_pilotgenerator)
-    tb.connect(dvbt2_pilotgenerator, dvbt2_paprtr)
-    tb.connect(dvbt2_paprtr, digital_ofdm_cyclic_prefixer)
-    tb.connect(digital_ofdm_cyclic_prefixer, dvbt2_p1insertion)
-    tb.connect(dvbt2_p1insertion, blocks_multiply_const)
-    tb.connect(blocks_multiply_const, out)
-
-    if outfile:
-        dst = blocks.file_sink(gr.sizeof_gr_complex, outfile)
-        tb.connect(blocks_multiply_const, dst)
+    tb.connect(src, dvbt2_gateway)
+    tb.connect(dvbt2_gateway, dvbt2_outputconditioner)
+
+    if outfile and outformat != dvbt2.OUTPUT_FC32:
+        # the second output carries the same samples as complex float
+        if outformat == dvbt2.OUTPUT_SC16:
+            itemsize = gr.sizeof_short * 2
+        else:
+            itemsize = gr.sizeof_char * 2
+        dst = blocks.file_sink(itemsize, outfile)
+        tb.connect((dvbt2_outputconditioner, 0), dst)
+        tb.connect((dvbt2_outputconditioner, 1), out)
+    else:
+        tb.connect(dvbt2_outputconditioner, out)
+        if outfile:
+            dst = blocks.file_sink(gr.sizeof_gr_complex, outfile)
+            tb.connect(dvbt2_outputconditioner, dst)
 
     tb.run()
 
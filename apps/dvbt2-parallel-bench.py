@@ -0,0 +1,92 @@
+#!/usr/bin/env /usr/bin/python
+
+# Copyright 2015 Ron Economos (w6rz@comcast.net)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Throughput of the gateway with the parallel engine on 1 to N cores,
+# against the single thread engine. Same modulation as dvbt2-blade.py.
+
+from gnuradio import blocks
+from gnuradio import gr
+import dvbt2
+import multiprocessing
+import random
+import sys
+import time
+
+def run(args, engine, depth, cores, frames):
+    tb = gr.top_block()
+
+    random.seed(1)
+    data = []
+    for i in range(2000):
+        data += [0x47] + [random.randint(0, 255) for j in range(187)]
+    src = blocks.vector_source_b(data, True)
+
+    dvbt2_gateway = dvbt2.gateway_bc(*(args + (engine, depth, cores)))
+    head = blocks.head(gr.sizeof_gr_complex, dvbt2_gateway.output_multiple() * frames)
+    dst = blocks.null_sink(gr.sizeof_gr_complex)
+
+    tb.connect(src, dvbt2_gateway, head, dst)
+
+    start = time.time()
+    tb.run()
+    return time.time() - start
+
+def main(args):
+    nargs = len(args)
+    workers = multiprocessing.cpu_count()
+    frames = 40
+    depth = 2
+    if nargs > 3:
+        sys.stderr.write("Usage: dvbt2-parallel-bench.py [max_workers [frames [depth]]]\n");
+        sys.exit(1)
+    if nargs > 0:
+        workers = int(args[0])
+    if nargs > 1:
+        frames = int(args[1])
+    if nargs > 2:
+        depth = int(args[2])
+
+    version = dvbt2.VERSION_111
+    fft_size = dvbt2.FFTSIZE_4K
+    input_mode = dvbt2.INPUTMODE_NORMAL
+    frame_size = dvbt2.FECFRAME_NORMAL
+    code_rate = dvbt2.C2_3
+    data_symbols = 100
+    fec_blocks = 31
+    ti_blocks = 3
+    constellation = dvbt2.MOD_64QAM
+    rotation = dvbt2.ROTATION_ON
+    guard_interval = dvbt2.GI_1_32
+    mode = dvbt2.PREAMBLE_T2_SISO
+    carrier_mode = dvbt2.CARRIERS_NORMAL
+    pilot_pattern = dvbt2.PILOT_PP7
+    l1_constellation = dvbt2.L1_MOD_16QAM
+    papr_mode = dvbt2.PAPR_OFF
+    papr_vclip = 3.3
+    papr_iterations = 3
+
+    gateway_args = (frame_size, code_rate, constellation, rotation, fec_blocks, ti_blocks, carrier_mode, fft_size, guard_interval, l1_constellation, pilot_pattern, 2, data_symbols, papr_mode, version, mode, input_mode, dvbt2.RESERVED_OFF, dvbt2.L1_SCRAMBLED_OFF, dvbt2.INBAND_OFF, 4000000, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_ON, dvbt2.BANDWIDTH_8_0_MHZ, papr_vclip, papr_iterations, 2.5, 2.0, 1.4, 1)
+
+    single = run(gateway_args, dvbt2.ENGINE_SINGLE, depth, [], frames)
+    sys.stdout.write("engine    workers  frames/s  speedup\n")
+    sys.stdout.write("single          1  %8.2f  %7.2f\n" % (frames / single, 1.0))
+    for n in range(1, workers + 1):
+        elapsed = run(gateway_args, dvbt2.ENGINE_PARALLEL, depth, list(range(n)), frames)
+        sys.stdout.write("parallel %8d  %8.2f  %7.2f\n" % (n, frames / elapsed, single / elapsed))
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
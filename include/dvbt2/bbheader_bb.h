@@ -24,6 +24,7 @@
 
 #include <dvbt2/api.h>
 #include <dvbt2/dvbt2_config.h>
+#include <dvbt2/perf_block.h>
 #include <gnuradio/block.h>
 
 namespace gr {
@@ -34,7 +35,7 @@ namespace gr {
      * \ingroup dvbt2
      *
      */
-    class DVBT2_API bbheader_bb : virtual public gr::block
+    class DVBT2_API bbheader_bb : virtual public gr::block, public perf_block
     {
      public:
       typedef boost::shared_ptr<bbheader_bb> sptr;
@@ -47,7 +48,7 @@ namespace gr {
        * class. dvbt2::bbheader_bb::make is the public interface for
        * creating new instances.
        */
-      static sptr make(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_inputmode_t mode, dvbt2_inband_t inband, int fecblocks, int tsrate);
+      static sptr make(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_inputmode_t mode, dvbt2_inband_t inband, int fecblocks, int tsrate, dvbt2_npd_t npd = gr::dvbt2::NPD_OFF);
     };
 
   } // namespace dvbt2
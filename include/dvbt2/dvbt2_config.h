@@ -176,6 +176,7 @@ namespace gr {
     enum dvbt2_misogroup_t {
       MISO_TX1 = 0,
       MISO_TX2,
+      MISO_BOTH,
     };
 
     enum dvbt2_showlevels_t {
@@ -188,6 +189,11 @@ namespace gr {
       INBAND_ON,
     };
 
+    enum dvbt2_npd_t {
+      NPD_OFF = 0,
+      NPD_ON,
+    };
+
     enum dvbt2_equalization_t {
       EQUALIZATION_OFF = 0,
       EQUALIZATION_ON,
@@ -202,6 +208,24 @@ namespace gr {
       BANDWIDTH_10_0_MHZ,
     };
 
+    enum dvbt2_clipping_t {
+      CLIPPING_OFF = 0,
+      CLIPPING_ON,
+    };
+
+    enum dvbt2_outputformat_t {
+      OUTPUT_FC32 = 0,
+      OUTPUT_SC16,
+      OUTPUT_SC8,
+    };
+
+    enum dvbt2_engine_t {
+      ENGINE_SINGLE = 0,
+      ENGINE_PIPELINE_POLL,
+      ENGINE_PIPELINE_FUTEX,
+      ENGINE_PARALLEL,
+    };
+
   } // namespace dvbt2
 } // namespace gr
 
@@ -224,8 +248,12 @@ typedef gr::dvbt2::dvbt2_l1scrambled_t dvbt2_l1scrambled_t;
 typedef gr::dvbt2::dvbt2_misogroup_t dvbt2_misogroup_t;
 typedef gr::dvbt2::dvbt2_showlevels_t dvbt2_showlevels_t;
 typedef gr::dvbt2::dvbt2_inband_t dvbt2_inband_t;
+typedef gr::dvbt2::dvbt2_npd_t dvbt2_npd_t;
 typedef gr::dvbt2::dvbt2_equalization_t dvbt2_equalization_t;
 typedef gr::dvbt2::dvbt2_bandwidth_t dvbt2_bandwidth_t;
+typedef gr::dvbt2::dvbt2_clipping_t dvbt2_clipping_t;
+typedef gr::dvbt2::dvbt2_outputformat_t dvbt2_outputformat_t;
+typedef gr::dvbt2::dvbt2_engine_t dvbt2_engine_t;
 
 #endif /* INCLUDED_DVBT2_CONFIG_H */
 
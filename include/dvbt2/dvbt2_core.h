@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+/*
+ * Scheduler-free C interface of libgnuradio-dvbt2, the modulator
+ * chain without a flow graph. No flow graph or scheduler is started,
+ * but the library still links libgnuradio-runtime, libgnuradio-fft,
+ * VOLK and Boost, so those are needed to link and run. Parameters
+ * are set by name, as the block constructor parameters, and enum
+ * values by name, for example
+ *
+ *   dvbt2_core_params *p = dvbt2_core_params_new();
+ *   dvbt2_core_params_set(p, "fftsize", "32K");
+ *   dvbt2_core_encoder *e = dvbt2_core_encoder_new(p, 0, 2, NULL, 0);
+ *
+ * Each call to dvbt2_core_encode() then turns up to
+ * dvbt2_core_input_bytes() transport stream bytes into one T2 frame of
+ * dvbt2_core_output_samples() complex samples, interleaved I and Q
+ * floats. Encoders share nothing and may run on different threads, one
+ * thread per encoder at a time. Nothing is allocated after
+ * dvbt2_core_encoder_new().
+ */
+
+#ifndef INCLUDED_DVBT2_DVBT2_CORE_H
+#define INCLUDED_DVBT2_DVBT2_CORE_H
+
+#if defined(_MSC_VER)
+#  ifdef gnuradio_dvbt2_EXPORTS
+#    define DVBT2_CORE_API __declspec(dllexport)
+#  else
+#    define DVBT2_CORE_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__) && __GNUC__ >= 4
+#  define DVBT2_CORE_API __attribute__((visibility("default")))
+#else
+#  define DVBT2_CORE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct dvbt2_core_params dvbt2_core_params;
+typedef struct dvbt2_core_encoder dvbt2_core_encoder;
+
+/* Parameters with the dvbt2-blade.py defaults, NULL without memory. */
+DVBT2_CORE_API dvbt2_core_params *dvbt2_core_params_new(void);
+DVBT2_CORE_API void dvbt2_core_params_free(dvbt2_core_params *params);
+/* 0 when set, -1 for an unknown key or a bad value. */
+DVBT2_CORE_API int dvbt2_core_params_set(dvbt2_core_params *params, const char *key, const char *value);
+/* Output samples per second. */
+DVBT2_CORE_API double dvbt2_core_sample_rate(const dvbt2_core_params *params);
+
+/*
+ * engine is a dvbt2_engine_t value, 0 encodes in the calling thread.
+ * depth and cores[ncores] are as for the gateway_bc block. NULL
+ * without memory, or when the parameters are not a valid
+ * configuration, see t2_capacity::check().
+ */
+DVBT2_CORE_API dvbt2_core_encoder *dvbt2_core_encoder_new(const dvbt2_core_params *params, int engine, int depth, const int *cores, int ncores);
+DVBT2_CORE_API void dvbt2_core_encoder_free(dvbt2_core_encoder *encoder);
+DVBT2_CORE_API int dvbt2_core_input_bytes(const dvbt2_core_encoder *encoder);
+DVBT2_CORE_API int dvbt2_core_output_samples(const dvbt2_core_encoder *encoder);
+
+/* One frame, returns the bytes consumed. No frames may be in flight. */
+DVBT2_CORE_API int dvbt2_core_encode(dvbt2_core_encoder *encoder, const unsigned char *in, float *out);
+/* Starts a frame, returns the bytes consumed or -1 when full. */
+DVBT2_CORE_API int dvbt2_core_push(dvbt2_core_encoder *encoder, const unsigned char *in);
+/* The oldest frame, waits for it. 0 when done, -1 when none is in flight. */
+DVBT2_CORE_API int dvbt2_core_pop(dvbt2_core_encoder *encoder, float *out);
+/* Frames in flight. */
+DVBT2_CORE_API int dvbt2_core_frames(const dvbt2_core_encoder *encoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDED_DVBT2_DVBT2_CORE_H */
+
@@ -0,0 +1,80 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef INCLUDED_DVBT2_GATEWAY_BC_H
+#define INCLUDED_DVBT2_GATEWAY_BC_H
+
+#include <dvbt2/api.h>
+#include <dvbt2/dvbt2_config.h>
+#include <dvbt2/perf_block.h>
+#include <gnuradio/block.h>
+#include <vector>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*!
+     * \brief Complete T2 modulator, transport stream in, baseband out.
+     * \ingroup dvbt2
+     *
+     * Runs bbheader, bbscrambler, bch, ldpc, interleaver, modulator,
+     * cell interleaver, frame mapper, frequency interleaver, pilot
+     * generator, tone reservation (when enabled) and guard interval
+     * and P1 insertion in one block, one T2 frame per pass. The bit
+     * stages run one FEC block at a time through small scratch
+     * buffers. The parameters are the ones of the separate blocks
+     * and the output is bit identical to the separate blocks.
+     *
+     * \p misogroup selects MISO_TX1 or MISO_TX2, the Alamouti
+     * encoding is done internally.
+     *
+     * With ENGINE_SINGLE everything runs in the scheduler thread. The
+     * ENGINE_PIPELINE modes split the chain into stages on their own
+     * threads, joined by rings of \p depth frames, with the stage
+     * threads pinned to \p cores when given. POLL threads spin while they wait, FUTEX
+     * threads sleep. ENGINE_PARALLEL encodes whole T2 frames on a
+     * pool of workers, one per entry of \p cores (one per CPU when
+     * empty), with \p depth frames in flight per worker, and puts
+     * them back in order. The output is the same in all modes, only
+     * delayed by the frames in flight.
+     */
+    class DVBT2_API gateway_bc : virtual public gr::block, public perf_block
+    {
+     public:
+      typedef boost::shared_ptr<gateway_bc> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of dvbt2::gateway_bc.
+       *
+       * To avoid accidental use of raw pointers, dvbt2::gateway_bc's
+       * constructor is in a private implementation
+       * class. dvbt2::gateway_bc::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_constellation_t constellation, dvbt2_rotation_t rotation, int fecblocks, int tiblocks, dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, dvbt2_l1constellation_t l1constellation, dvbt2_pilotpattern_t pilotpattern, int t2frames, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_inputmode_t inputmode, dvbt2_reservedbiasbits_t reservedbiasbits, dvbt2_l1scrambled_t l1scrambled, dvbt2_inband_t inband, int tsrate, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, float vclip = 3.3, int iterations = 3, float acevclip = 2.5, float acegain = 2.0, float acelimit = 1.4, int aceiterations = 1, dvbt2_engine_t engine = ENGINE_SINGLE, int depth = 2, const std::vector<int> &cores = std::vector<int>());
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_GATEWAY_BC_H */
+
@@ -0,0 +1,62 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_DVBT2_GI_P1_INSERTION_CC_H
+#define INCLUDED_DVBT2_GI_P1_INSERTION_CC_H
+
+#include <dvbt2/api.h>
+#include <dvbt2/dvbt2_config.h>
+#include <dvbt2/perf_block.h>
+#include <gnuradio/block.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*!
+     * \brief Guard interval and P1 symbol insertion.
+     * \ingroup dvbt2
+     *
+     * Takes the OFDM symbols of each T2 frame as vectors and writes
+     * the P1 symbol followed by the guard interval and body of every
+     * symbol straight into the output stream. Replaces an OFDM cyclic
+     * prefixer followed by dvbt2::p1insertion_cc.
+     */
+    class DVBT2_API gi_p1_insertion_cc : virtual public gr::block, public perf_block
+    {
+     public:
+      typedef boost::shared_ptr<gi_p1_insertion_cc> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of dvbt2::gi_p1_insertion_cc.
+       *
+       * To avoid accidental use of raw pointers, dvbt2::gi_p1_insertion_cc's
+       * constructor is in a private implementation
+       * class. dvbt2::gi_p1_insertion_cc::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_preamble_t preamble);
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_GI_P1_INSERTION_CC_H */
+
@@ -24,6 +24,7 @@
 
 #include <dvbt2/api.h>
 #include <dvbt2/dvbt2_config.h>
+#include <dvbt2/perf_block.h>
 #include <gnuradio/sync_block.h>
 
 namespace gr {
@@ -34,7 +35,7 @@ namespace gr {
      * \ingroup dvbt2
      *
      */
-    class DVBT2_API miso_cc : virtual public gr::sync_block
+    class DVBT2_API miso_cc : virtual public gr::sync_block, public perf_block
     {
      public:
       typedef boost::shared_ptr<miso_cc> sptr;
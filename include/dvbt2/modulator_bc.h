@@ -24,6 +24,7 @@
 
 #include <dvbt2/api.h>
 #include <dvbt2/dvbt2_config.h>
+#include <dvbt2/perf_block.h>
 #include <gnuradio/block.h>
 
 namespace gr {
@@ -34,7 +35,7 @@ namespace gr {
      * \ingroup dvbt2
      *
      */
-    class DVBT2_API modulator_bc : virtual public gr::block
+    class DVBT2_API modulator_bc : virtual public gr::block, public perf_block
     {
      public:
       typedef boost::shared_ptr<modulator_bc> sptr;
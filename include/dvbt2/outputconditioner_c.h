@@ -0,0 +1,75 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_DVBT2_OUTPUTCONDITIONER_C_H
+#define INCLUDED_DVBT2_OUTPUTCONDITIONER_C_H
+
+#include <dvbt2/api.h>
+#include <dvbt2/dvbt2_config.h>
+#include <dvbt2/perf_block.h>
+#include <gnuradio/sync_block.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*!
+     * \brief Output gain, hard clipping and sample format conversion.
+     * \ingroup dvbt2
+     *
+     * Scales the transmitter output by \p gain, optionally hard clips
+     * the I and Q components at +/- \p cliplevel, and writes the result
+     * as complex float (OUTPUT_FC32), or as interleaved 16 bit (OUTPUT_SC16)
+     * or 8 bit (OUTPUT_SC8) integers where 1.0 is full scale.
+     *
+     * The optional second output carries the same conditioned samples
+     * as complex float, so an SDR sink and an integer file can share
+     * one conditioner.
+     */
+    class DVBT2_API outputconditioner_c : virtual public gr::sync_block, public perf_block
+    {
+     public:
+      typedef boost::shared_ptr<outputconditioner_c> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of dvbt2::outputconditioner_c.
+       *
+       * To avoid accidental use of raw pointers, dvbt2::outputconditioner_c's
+       * constructor is in a private implementation
+       * class. dvbt2::outputconditioner_c::make is the public interface for
+       * creating new instances.
+       */
+      static sptr make(float gain, dvbt2_clipping_t clipping, float cliplevel, dvbt2_outputformat_t format);
+
+      virtual void set_gain(float gain) = 0;
+      virtual float gain() const = 0;
+
+      //! Number of I and Q components clipped so far.
+      virtual uint64_t clipped_samples() const = 0;
+
+      //! Number of I and Q components processed so far.
+      virtual uint64_t total_samples() const = 0;
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_OUTPUTCONDITIONER_C_H */
+
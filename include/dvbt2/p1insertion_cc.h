@@ -24,17 +24,23 @@
 
 #include <dvbt2/api.h>
 #include <dvbt2/dvbt2_config.h>
+#include <dvbt2/perf_block.h>
 #include <gnuradio/block.h>
 
 namespace gr {
   namespace dvbt2 {
 
     /*!
-     * \brief <+description of block+>
+     * \brief P1 symbol insertion.
      * \ingroup dvbt2
      *
+     * With \p showlevels on, the largest positive and negative I and Q
+     * levels and the number of I and Q values beyond +/- \p vclip are
+     * collected. They are published as a dictionary on the optional
+     * "levels" message port after every frame, and can be read through
+     * the accessors below.
      */
-    class DVBT2_API p1insertion_cc : virtual public gr::block
+    class DVBT2_API p1insertion_cc : virtual public gr::block, public perf_block
     {
      public:
       typedef boost::shared_ptr<p1insertion_cc> sptr;
@@ -48,6 +54,18 @@ namespace gr {
        * creating new instances.
        */
       static sptr make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_preamble_t preamble, dvbt2_showlevels_t showlevels, float vclip);
+
+      virtual float real_positive_peak() const = 0;
+      virtual float real_negative_peak() const = 0;
+      virtual float imag_positive_peak() const = 0;
+      virtual float imag_negative_peak() const = 0;
+      virtual uint64_t real_positive_threshold_count() const = 0;
+      virtual uint64_t real_negative_threshold_count() const = 0;
+      virtual uint64_t imag_positive_threshold_count() const = 0;
+      virtual uint64_t imag_negative_threshold_count() const = 0;
+
+      //! Clear the levels and counts.
+      virtual void reset_levels() = 0;
     };
 
   } // namespace dvbt2
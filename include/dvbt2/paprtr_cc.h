@@ -24,17 +24,46 @@
 
 #include <dvbt2/api.h>
 #include <dvbt2/dvbt2_config.h>
+#include <dvbt2/perf_block.h>
 #include <gnuradio/sync_block.h>
 
 namespace gr {
   namespace dvbt2 {
 
     /*!
-     * \brief <+description of block+>
+     * \brief Tone reservation PAPR reduction.
      * \ingroup dvbt2
      *
+     * Each iteration searches the symbol for up to \p peaks samples
+     * above \p vclip that are at least \p separation samples apart,
+     * and cancels each of them with the reference kernel of the
+     * reserved tones. A symbol is done after \p iterations searches
+     * or once its largest peak is within \p tolerance of \p vclip.
+     *
+     * A non-zero \p budget limits the processing time spent on each
+     * T2 frame, in milliseconds. Iterations are then shared out over
+     * the remaining symbols of the frame, and an overrun is carried
+     * into the budget of the next frame. Symbols that were stopped
+     * short of convergence are counted by under_processed_symbols().
+     * The output then depends on timing, so the gateway block and
+     * t2_encoder, whose engines must match each other, always run with
+     * a budget of 0.
+     *
+     * With \p oversampling L greater than 1, peaks are searched for on
+     * an L times oversampled (zero-padded FFT) view of each symbol, so
+     * peaks between samples are cancelled as well. The corrected symbol
+     * is decimated back to the native rate.
+     *
+     * With \p nthreads greater than 1, the symbols of each T2 frame
+     * are shared out over a pool of worker threads, each with its own
+     * FFT plans and scratch buffers.
+     *
+     * Statistics are collected per thread and folded together once per
+     * T2 frame. They are published as a dictionary on the optional
+     * "stats" message port after every frame, and can be read through
+     * the accessors below.
      */
-    class DVBT2_API paprtr_cc : virtual public gr::sync_block
+    class DVBT2_API paprtr_cc : virtual public gr::sync_block, public perf_block
     {
      public:
       typedef boost::shared_ptr<paprtr_cc> sptr;
@@ -47,7 +76,45 @@ namespace gr {
        * class. dvbt2::paprtr_cc::make is the public interface for
        * creating new instances.
        */
-      static sptr make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, float vclip, int iterations, int vlength);
+      static sptr make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, float vclip, int iterations, int vlength, int peaks = 1, int separation = 1, float tolerance = 0.01, float budget = 0.0, int oversampling = 1, int nthreads = 1);
+
+      //! Number of symbols that tone reservation was applied to.
+      virtual uint64_t processed_symbols() const = 0;
+
+      //! Number of symbols stopped short by the frame budget.
+      virtual uint64_t under_processed_symbols() const = 0;
+
+      //! Average symbol PAPR in dB before tone reservation, on the oversampled view.
+      virtual float papr_before() const = 0;
+
+      //! Average symbol PAPR in dB after tone reservation, on the oversampled view.
+      virtual float papr_after() const = 0;
+
+      //! Number of tone reservation iterations run over all symbols.
+      virtual uint64_t total_iterations() const = 0;
+
+      //! Number of peaks cancelled over all symbols.
+      virtual uint64_t cancelled_peaks() const = 0;
+
+      //! Number of cancelled peaks whose step was cut back to keep the reserved tones within aMax.
+      virtual uint64_t limited_peaks() const = 0;
+
+      //! Largest sample magnitude seen before tone reservation, on the oversampled view.
+      virtual float peak_before() const = 0;
+
+      //! Largest sample magnitude seen after tone reservation, on the oversampled view.
+      virtual float peak_after() const = 0;
+
+      /*!
+       * CCDF of the output sample power relative to the mean power of
+       * its symbol. The power is rounded to the nearest 0.1 dB, and
+       * element k, for k > 0, is the fraction of output samples that
+       * round to k / 10 dB or more, up to 16 dB. Element 0 is 1.
+       */
+      virtual std::vector<float> ccdf() const = 0;
+
+      //! Clear all statistics.
+      virtual void reset_stats() = 0;
     };
 
   } // namespace dvbt2
@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef INCLUDED_DVBT2_PERF_BLOCK_H
+#define INCLUDED_DVBT2_PERF_BLOCK_H
+
+#include <dvbt2/api.h>
+#include <gnuradio/block.h>
+#include <stdint.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    class perf_monitor;
+
+    /*!
+     * \brief Counters of one block, as returned by perf_block::perf().
+     * \ingroup dvbt2
+     *
+     * A frame is output_multiple() items of the block, a FEC frame, an
+     * OFDM symbol or a T2 frame, depending on the block. Bucket k of
+     * the histogram counts work calls that took 2^k to 2^(k+1) - 1 ns,
+     * the last bucket also counts the longer ones.
+     *
+     * Time between two work calls is counted as blocked when the
+     * output buffer had no room for another frame at the end of the
+     * first call, and as starved otherwise.
+     */
+    struct DVBT2_API perf_stats
+    {
+      static const int BUCKETS = 32;
+
+      uint64_t work_calls;
+      uint64_t items;
+      uint64_t frames;
+      uint64_t work_ns;
+      uint64_t starved_ns;
+      uint64_t blocked_ns;
+      uint64_t histogram[BUCKETS];
+      //! True once the hardware counters below have been read.
+      bool hardware;
+      uint64_t cycles;
+      uint64_t instructions;
+      uint64_t cache_misses;
+
+      perf_stats();
+      double ns_per_frame() const;
+      double cycles_per_frame() const;
+    };
+
+    /*!
+     * \brief Always-on work counters, a base of every dvbt2 block.
+     * \ingroup dvbt2
+     *
+     * Counting costs two timer reads and one uncontended lock per work
+     * call. Calls made outside of a flow graph, as by gateway_bc and
+     * t2_encoder, are not counted.
+     *
+     * A message on the "perf_query" input port publishes the counters
+     * as a dictionary on the "perf" output port, and set_perf_interval()
+     * publishes them from the work thread every so often. Keys are the
+     * perf_stats members, plus "name" and the per frame averages.
+     *
+     * With set_hardware_counters(true), the CPU cycles, instructions
+     * and cache misses of the work thread are counted as well, through
+     * Linux perf events. Where these are not available, as with a high
+     * kernel.perf_event_paranoid, perf_stats::hardware stays false.
+     */
+    class DVBT2_API perf_block
+    {
+     private:
+      perf_monitor *monitor;
+
+      perf_block(const perf_block &);
+      perf_block &operator=(const perf_block &);
+
+     protected:
+      perf_block();
+      //! Registers the message ports, called by the block constructor.
+      void perf_attach(gr::block *block);
+      //! Called at the start and end of each work call.
+      void perf_begin();
+      void perf_end(int produced);
+
+     public:
+      virtual ~perf_block();
+
+      //! Counters since the start or the last reset_perf().
+      perf_stats perf() const;
+      void reset_perf();
+      //! Count CPU cycles, instructions and cache misses too.
+      void set_hardware_counters(bool enable);
+      //! Publish the counters every \p seconds, 0 to publish on query only.
+      void set_perf_interval(double seconds);
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_PERF_BLOCK_H */
+
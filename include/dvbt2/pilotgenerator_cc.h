@@ -24,17 +24,33 @@
 
 #include <dvbt2/api.h>
 #include <dvbt2/dvbt2_config.h>
+#include <dvbt2/perf_block.h>
 #include <gnuradio/block.h>
 
 namespace gr {
   namespace dvbt2 {
 
     /*!
-     * \brief <+description of block+>
+     * \brief Inserts the pilots and performs the IFFT.
      * \ingroup dvbt2
      *
+     * With PAPR_ACE or PAPR_BOTH, Active Constellation Extension is
+     * applied to the data cells of each data symbol. ACE is only
+     * allowed for non-rotated constellations, so it needs \p rotation
+     * ROTATION_OFF and \p constellation set to the one of the data
+     * cells. With ROTATION_ON, the default, ACE is left out with a
+     * warning and PAPR_BOTH runs tone reservation alone, as it did
+     * before ACE was implemented. \p acevclip is the
+     * clipping level on the normalised output, \p acegain the gain G
+     * applied to the clipping noise, and \p acelimit the largest
+     * magnitude an outer constellation component may be extended to.
+     *
+     * With \p misogroup MISO_BOTH and a MISO preamble the block takes
+     * the frequency interleaver output, does the Alamouti encoding
+     * and has two outputs, TX1 and TX2. The second output is
+     * modulated on its own thread.
      */
-    class DVBT2_API pilotgenerator_cc : virtual public gr::block
+    class DVBT2_API pilotgenerator_cc : virtual public gr::block, public perf_block
     {
      public:
       typedef boost::shared_ptr<pilotgenerator_cc> sptr;
@@ -47,7 +63,7 @@ namespace gr {
        * class. dvbt2::pilotgenerator_cc::make is the public interface for
        * creating new instances.
        */
-      static sptr make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, int vlength);
+      static sptr make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, int vlength, dvbt2_constellation_t constellation = gr::dvbt2::MOD_QPSK, dvbt2_rotation_t rotation = gr::dvbt2::ROTATION_ON, float acevclip = 2.5, float acegain = 2.0, float acelimit = 1.4, int aceiterations = 1);
     };
 
   } // namespace dvbt2
@@ -0,0 +1,96 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef INCLUDED_DVBT2_T2_ENCODER_H
+#define INCLUDED_DVBT2_T2_ENCODER_H
+
+#include <dvbt2/api.h>
+#include <dvbt2/t2_params.h>
+#include <gnuradio/gr_complex.h>
+#include <vector>
+
+namespace gr {
+  namespace dvbt2 {
+
+    class t2_chain;
+    class pipeline_engine;
+    class parallel_engine;
+
+    /*!
+     * \brief The modulator chain with plain buffers, one T2 frame per call.
+     * \ingroup dvbt2
+     *
+     * Turns transport stream bytes into complex baseband, the same as
+     * gateway_bc, which wraps it, without a flow graph or scheduler.
+     * All buffers are allocated by the constructor. Instances share
+     * nothing, so different instances can run on different threads,
+     * but one instance must be driven from one thread at a time.
+     *
+     * With ENGINE_SINGLE, encode() runs the chain in the calling
+     * thread. The other engines keep frames in flight on their own
+     * threads: push() starts a frame and pop() returns the oldest one.
+     * \p depth and \p cores are as for gateway_bc.
+     *
+     * The constructor throws std::bad_alloc when it runs out of memory,
+     * and std::invalid_argument for parameters a block refuses.
+     */
+    class DVBT2_API t2_encoder
+    {
+     private:
+      t2_chain *chain;
+      std::vector<t2_chain *> workers;
+      pipeline_engine *pipeline;
+      parallel_engine *parallel;
+      gr_complex *frame;
+      int pending;
+
+      void release();
+      t2_encoder(const t2_encoder &);
+      t2_encoder &operator=(const t2_encoder &);
+
+     public:
+      t2_encoder(const t2_params &params, dvbt2_engine_t engine = ENGINE_SINGLE, int depth = 2, const std::vector<int> &cores = std::vector<int>());
+      ~t2_encoder();
+
+      //! Transport stream bytes a frame may consume, at most.
+      int input_items() const;
+      //! Complex samples per frame.
+      int output_items() const;
+
+      //! Encodes one frame into out, returns the bytes consumed.
+      //! With a threaded engine, no frames may be in flight.
+      int encode(const unsigned char *in, gr_complex *out);
+      //! Starts a frame. Returns the bytes consumed, or -1 when no
+      //! more frames fit in flight.
+      int push(const unsigned char *in);
+      //! Copies the oldest frame to out, waiting for it if needed.
+      //! Returns false when no frame is in flight.
+      bool pop(gr_complex *out);
+      //! Frames pushed and not popped yet.
+      int frames() const;
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_T2_ENCODER_H */
+
@@ -0,0 +1,135 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef INCLUDED_DVBT2_T2_GEOMETRY_H
+#define INCLUDED_DVBT2_T2_GEOMETRY_H
+
+#include <dvbt2/api.h>
+#include <dvbt2/dvbt2_config.h>
+#include <dvbt2/t2_params.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*!
+     * \brief The cells and samples of a T2 frame.
+     * \ingroup dvbt2
+     *
+     * N_P2 and C_P2 are Table 45 of ETSI EN 302 755, C_DATA Table 42
+     * and N_FC and C_FC Table 43, less the reserved carriers with tone
+     * reservation. C_DATA is 0 for a pilot pattern the FFT size does
+     * not have, and N_FC and C_FC are 0 without a frame closing
+     * symbol. Every block that needs them takes them from here.
+     */
+    struct DVBT2_API t2_geometry
+    {
+      int fft_size;         //!< samples per OFDM symbol, without guard
+      int guard_interval;   //!< samples of the guard interval
+      int N_P2;
+      int C_P2;
+      int C_DATA;
+      int N_FC;
+      int C_FC;
+
+      t2_geometry(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, dvbt2_papr_t paprmode, dvbt2_preamble_t preamble);
+
+      static int fft_length(dvbt2_fftsize_t fftsize);
+      static int guard_length(dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval);
+      static int p2_symbols(dvbt2_fftsize_t fftsize);
+      //! Table 59, the pilot patterns allowed in SISO mode, and the
+      //! extended carrier mode only from 8K.
+      static bool allowed(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, dvbt2_pilotpattern_t pilotpattern);
+
+      //! Cells of the P2 and data symbols.
+      int frame_cells(int numdatasyms) const;
+      //! Samples of the frame with P1 and guard intervals.
+      int frame_samples(int numdatasyms) const;
+      //! Bits of the coded and modulated L1-post signalling, N_post
+      //! of clause 7.3.3.
+      int l1_post_bits(dvbt2_l1constellation_t l1constellation) const;
+      //! FEC blocks of cell_size cells the frame has room for after
+      //! the L1 signalling and the frame closing dummy cells.
+      int fec_capacity(int numdatasyms, int cell_size, dvbt2_l1constellation_t l1constellation) const;
+    };
+
+    /*!
+     * \brief Limits for t2_capacity::solve().
+     * \ingroup dvbt2
+     *
+     * The defaults are those of the standard: 250 ms frames, the L1
+     * field widths and a TI block in 2^19 + 2^15 cells of memory.
+     */
+    struct DVBT2_API t2_constraints
+    {
+      double max_frame_ms;
+      double min_frame_ms;
+      int max_fecblocks;
+      int max_ti_cells;
+      //! Limit on t2_capacity::memory_bytes, 0 for none.
+      double max_memory_bytes;
+
+      t2_constraints();
+    };
+
+    /*!
+     * \brief What a configuration carries and costs.
+     * \ingroup dvbt2
+     *
+     * Computed from the parameters alone, without building the chain.
+     * bitrate is the transport stream rate the modulator takes in, so
+     * the exact tsrate for the configuration; with high efficiency
+     * mode it is the average, as each sync byte is dropped.
+     */
+    struct DVBT2_API t2_capacity
+    {
+      int fec_capacity;             //!< FEC blocks the frame has room for
+      int frame_cells;
+      int frame_symbols;            //!< P2 and data symbols
+      int frame_samples;
+      int ti_cells;                 //!< cells of the largest TI block
+      double sample_rate;
+      double frame_seconds;
+      double bitrate;               //!< transport stream bits per second
+      double fecframes_per_second;  //!< bbheader to cellinterleaver
+      double symbols_per_second;    //!< freqinterleaver to paprtr
+      double cells_per_second;      //!< framemapper
+      //! The buffers that grow with the frame: the chain's cells and
+      //! symbols, the TI memory, the frame mapper's and one frame of
+      //! samples.
+      double memory_bytes;
+
+      explicit t2_capacity(const t2_params &params);
+
+      //! NULL when params is a valid configuration within
+      //! constraints, otherwise what is wrong with it.
+      const char *check(const t2_params &params, const t2_constraints &constraints = t2_constraints()) const;
+
+      //! Sets fecblocks, numdatasyms and tiblocks of params to the
+      //! combination with the highest bitrate within constraints, the
+      //! shortest frame of those. Returns false when none fits.
+      static bool solve(t2_params &params, const t2_constraints &constraints = t2_constraints());
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_T2_GEOMETRY_H */
@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef INCLUDED_DVBT2_T2_PARAMS_H
+#define INCLUDED_DVBT2_T2_PARAMS_H
+
+#include <dvbt2/api.h>
+#include <dvbt2/dvbt2_config.h>
+#include <stdio.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*!
+     * \brief The constructor parameters of the modulator chain.
+     * \ingroup dvbt2
+     *
+     * Every parameter has the name it has in the block constructors.
+     * set() takes enum values by their names, with or without the
+     * prefix (C2_3, MOD_64QAM or 64QAM, FFTSIZE_32K or 32K). The
+     * defaults are the dvbt2-blade.py settings.
+     */
+    struct DVBT2_API t2_params
+    {
+      dvbt2_framesize_t framesize;
+      dvbt2_code_rate_t rate;
+      dvbt2_constellation_t constellation;
+      dvbt2_rotation_t rotation;
+      int fecblocks;
+      int tiblocks;
+      dvbt2_extended_carrier_t carriermode;
+      dvbt2_fftsize_t fftsize;
+      dvbt2_guardinterval_t guardinterval;
+      dvbt2_l1constellation_t l1constellation;
+      dvbt2_pilotpattern_t pilotpattern;
+      int t2frames;
+      int numdatasyms;
+      dvbt2_papr_t paprmode;
+      dvbt2_version_t version;
+      dvbt2_preamble_t preamble;
+      dvbt2_inputmode_t inputmode;
+      dvbt2_reservedbiasbits_t reservedbiasbits;
+      dvbt2_l1scrambled_t l1scrambled;
+      dvbt2_inband_t inband;
+      int tsrate;
+      dvbt2_misogroup_t misogroup;
+      dvbt2_equalization_t equalization;
+      dvbt2_bandwidth_t bandwidth;
+      float vclip;
+      int iterations;
+      float acevclip;
+      float acegain;
+      float acelimit;
+      int aceiterations;
+
+      t2_params();
+
+      //! Sets parameter key from its text. Returns false for an
+      //! unknown key or a value that does not parse.
+      bool set(const char *key, const char *value);
+      //! Samples per second of the output for bandwidth.
+      double sample_rate() const;
+      //! Lists the parameters and their values on stream.
+      static void usage(FILE *stream);
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_T2_PARAMS_H */
+
@@ -0,0 +1,63 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef INCLUDED_DVBT2_TRACER_H
+#define INCLUDED_DVBT2_TRACER_H
+
+#include <dvbt2/api.h>
+#include <string>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*!
+     * \brief Opt-in timeline of the modulator, in Chrome trace format.
+     * \ingroup dvbt2
+     *
+     * While started, every work call of a block in a flow graph and
+     * every unit of the chain, FEC frame, TI block, OFDM symbol and T2
+     * frame, is recorded with its begin and end time. Each thread
+     * records into its own ring of \p events, without locks, so only
+     * the latest events of each thread are kept. The ring of a thread
+     * that exits goes to the next new thread, which clears it. Stopped,
+     * the cost is one test of a flag per unit.
+     *
+     * write() can be called at any time, also while recording, and
+     * writes Chrome trace event JSON, which chrome://tracing and the
+     * Perfetto UI (ui.perfetto.dev) open as one track per thread.
+     */
+    class DVBT2_API tracer
+    {
+     public:
+      //! Clears the trace and starts recording.
+      static void start(int events = 65536);
+      static void stop();
+      static bool enabled();
+      //! Returns false when \p filename cannot be written.
+      static bool write(const std::string &filename);
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_TRACER_H */
+
@@ -25,21 +25,24 @@
 #include <gnuradio/io_signature.h>
 #include "bbheader_bb_impl.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
 
 namespace gr {
   namespace dvbt2 {
 
     bbheader_bb::sptr
-    bbheader_bb::make(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_inputmode_t mode, dvbt2_inband_t inband, int fecblocks, int tsrate)
+    bbheader_bb::make(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_inputmode_t mode, dvbt2_inband_t inband, int fecblocks, int tsrate, dvbt2_npd_t npd)
     {
       return gnuradio::get_initial_sptr
-        (new bbheader_bb_impl(framesize, rate, mode, inband, fecblocks, tsrate));
+        (new bbheader_bb_impl(framesize, rate, mode, inband, fecblocks, tsrate, npd));
     }
 
     /*
      * The private constructor
      */
-    bbheader_bb_impl::bbheader_bb_impl(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_inputmode_t mode, dvbt2_inband_t inband, int fecblocks, int tsrate)
+    bbheader_bb_impl::bbheader_bb_impl(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_inputmode_t mode, dvbt2_inband_t inband, int fecblocks, int tsrate, dvbt2_npd_t npdmode)
       : gr::block("bbheader_bb",
               gr::io_signature::make(1, 1, sizeof(unsigned char)),
               gr::io_signature::make(1, 1, sizeof(unsigned char)))
@@ -108,7 +111,14 @@ namespace gr {
         f->sis_mis = SIS_MIS_SINGLE;
         f->ccm_acm = CCM;
         f->issyi   = ISSYI_NOT_ACTIVE;
-        f->npd     = NPD_NOT_ACTIVE;
+        if (npdmode == gr::dvbt2::NPD_ON)
+        {
+            f->npd     = NPD_ACTIVE;
+        }
+        else
+        {
+            f->npd     = NPD_NOT_ACTIVE;
+        }
         if (mode == gr::dvbt2::INPUTMODE_NORMAL)
         {
             f->upl     = 188 * 8;
@@ -129,8 +139,31 @@ namespace gr {
         fec_blocks = fecblocks;
         fec_block = 0;
         ts_rate = tsrate;
+        npd = f->npd;
+        dnp = 0;
+        // With null packet deletion each user packet ends with the DNP
+        // byte, which in normal mode also goes into its CRC-8.
+        if (npd == NPD_ACTIVE && mode == gr::dvbt2::INPUTMODE_NORMAL)
+        {
+            packet_length = 189;
+        }
+        else
+        {
+            packet_length = 188;
+        }
+        bbframe = NULL;
+        bbframe_bits = 0;
+        if (npd == NPD_ACTIVE)
+        {
+            bbframe = (unsigned char *) malloc(sizeof(unsigned char) * kbch);
+            if (bbframe == NULL) {
+                fprintf(stderr, "Baseband header 1st malloc, Out of memory.\n");
+                throw std::bad_alloc();
+            }
+        }
         extra = (((kbch - 80) / 8) / 187) + 1;
         set_output_multiple(kbch);
+        perf_attach(this);
     }
 
     /*
@@ -138,12 +171,24 @@ namespace gr {
      */
     bbheader_bb_impl::~bbheader_bb_impl()
     {
+        free(bbframe);
     }
 
     void
     bbheader_bb_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
     {
-        if (input_mode == gr::dvbt2::INPUTMODE_NORMAL)
+        if (npd == NPD_ACTIVE)
+        {
+            // Deleted null packets are consumed as they come, so this
+            // only asks for the user packets left to fill the BBFRAMEs,
+            // and for at least one packet.
+            ninput_items_required[0] = (((noutput_items - (bbframe_bits != 0 ? bbframe_bits : 80)) / 8) * 188) / packet_length;
+            if (ninput_items_required[0] < 188)
+            {
+                ninput_items_required[0] = 188;
+            }
+        }
+        else if (input_mode == gr::dvbt2::INPUTMODE_NORMAL)
         {
             ninput_items_required[0] = ((noutput_items - 80) / 8);
         }
@@ -256,7 +301,7 @@ void bbheader_bb_impl::add_bbheader(unsigned char *out, int count, int padding)
     if (temp == 0)
         temp = count;
     else
-        temp = (188 - count) * 8;
+        temp = (packet_length - count) * 8;
     for (int n = 15; n >= 0; n--)
     {
         m_frame[m_frame_offset_bits++] = temp & (1 << n) ? 1 : 0;
@@ -306,9 +351,25 @@ void bbheader_bb_impl::add_inband_type_b(unsigned char *out, int ts_rate)
     }
 }
 
+// Null packet deletion, clause 5.1.8 of ETSI EN 302 755. Counts the
+// null packets (PID 0x1FFF) in front of the next user packet into DNP
+// and returns their length in bytes, for the caller to consume. Stops
+// at the first user packet or at the end of the input. At DNP = 255 a
+// null packet is sent as a user packet.
+int bbheader_bb_impl::skip_null_packets(const unsigned char *in, int ninput_items)
+{
+    int deleted = 0;
+
+    while (ninput_items - deleted >= 188 && dnp < 255 && (((in[deleted + 1] & 0x1f) << 8) | in[deleted + 2]) == 0x1fff)
+    {
+        dnp++;
+        deleted += 188;
+    }
+    return deleted;
+}
+
     int
-    bbheader_bb_impl::general_work (int noutput_items,
-                       gr_vector_int &ninput_items,
+    bbheader_bb_impl::process(int noutput_items,
                        gr_vector_const_void_star &input_items,
                        gr_vector_void_star &output_items)
     {
@@ -400,12 +461,145 @@ void bbheader_bb_impl::add_inband_type_b(unsigned char *out, int ts_rate)
             }
         }
 
+        return consumed;
+    }
+
+    int
+    bbheader_bb_impl::process_npd(int noutput_items,
+                       int ninput_items,
+                       int *consumed,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        const unsigned char *in = (const unsigned char *) input_items[0];
+        unsigned char *out = (unsigned char *) output_items[0];
+        int produced = 0;
+        int offset = 0;
+        int padding, deleted;
+        unsigned char b;
+
+        *consumed = 0;
+        for (int i = 0; i < noutput_items; i += kbch)
+        {
+            if (fec_block == 0 && inband_type_b == TRUE)
+            {
+                padding = 104;
+            }
+            else
+            {
+                padding = 0;
+            }
+            if (bbframe_bits != 0)
+            {
+                // Carry on with the BBFRAME the input ran out in.
+                memcpy(&out[offset], bbframe, bbframe_bits);
+                offset = offset + bbframe_bits;
+                bbframe_bits = 0;
+            }
+            else
+            {
+                add_bbheader(&out[offset], count, padding);
+                offset = offset + 80;
+            }
+
+            for (int j = (offset - i - 80) / 8; j < (int)((kbch - 80 - padding) / 8); j++)
+            {
+                if (count == 0)
+                {
+                    deleted = skip_null_packets(in, ninput_items - *consumed);
+                    in += deleted;
+                    *consumed += deleted;
+                    if (ninput_items - *consumed < 188)
+                    {
+                        break;
+                    }
+                    if (*in != 0x47)
+                    {
+                        printf("Transport Stream sync error!\n");
+                    }
+                    in++;
+                    (*consumed)++;
+                    if (input_mode == gr::dvbt2::INPUTMODE_HIEFF)
+                    {
+                        b = *in++;
+                        (*consumed)++;
+                    }
+                    else
+                    {
+                        b = crc;
+                        crc = 0;
+                    }
+                }
+                else
+                {
+                    if (count == packet_length - 1)
+                    {
+                        b = dnp;
+                        dnp = 0;
+                    }
+                    else
+                    {
+                        b = *in++;
+                        (*consumed)++;
+                    }
+                    crc = crc_tab[b ^ crc];
+                }
+                count = (count + 1) % packet_length;
+                for (int n = 7; n >= 0; n--)
+                {
+                    out[offset++] = b & (1 << n) ? 1 : 0;
+                }
+            }
+            if (offset - i < (int)(80 + (((kbch - 80 - padding) / 8) * 8)))
+            {
+                // The input ends inside this BBFRAME. Keep it for the
+                // next call, the input it took is consumed.
+                bbframe_bits = offset - i;
+                memcpy(bbframe, &out[i], bbframe_bits);
+                break;
+            }
+            if (fec_block == 0 && inband_type_b == TRUE)
+            {
+                add_inband_type_b(&out[offset], ts_rate);
+                offset = offset + 104;
+            }
+            if (inband_type_b == TRUE)
+            {
+                fec_block = (fec_block + 1) % fec_blocks;
+            }
+            produced += kbch;
+        }
+
+        return produced;
+    }
+
+    int
+    bbheader_bb_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        perf_begin();
+        int consumed, produced;
+
+        if (npd == NPD_ACTIVE)
+        {
+            produced = process_npd(noutput_items, ninput_items[0], &consumed, input_items, output_items);
+        }
+        else
+        {
+            consumed = process(noutput_items, input_items, output_items);
+            produced = noutput_items;
+        }
+
         // Tell runtime system how many input items we consumed on
         // each input stream.
         consume_each (consumed);
 
+        perf_end(produced);
+
         // Tell runtime system how many output items we produced.
-        return noutput_items;
+        return produced;
     }
 
   } /* namespace dvbt2 */
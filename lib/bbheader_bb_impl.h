@@ -56,15 +56,21 @@ namespace gr {
       int fec_blocks;
       int fec_block;
       int ts_rate;
+      int npd;
+      unsigned int dnp;
+      unsigned int packet_length;
+      unsigned char *bbframe;
+      int bbframe_bits;
       FrameFormat m_format[1];
       unsigned char crc_tab[256];
       void add_bbheader(unsigned char *, int, int);
       void build_crc8_table(void);
       int add_crc8_bits(unsigned char *, int);
       void add_inband_type_b(unsigned char *, int);
+      int skip_null_packets(const unsigned char *, int);
 
      public:
-      bbheader_bb_impl(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_inputmode_t mode, dvbt2_inband_t inband, int fecblocks, int tsrate);
+      bbheader_bb_impl(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_inputmode_t mode, dvbt2_inband_t inband, int fecblocks, int tsrate, dvbt2_npd_t npdmode);
       ~bbheader_bb_impl();
 
       // Where all the action really happens
@@ -74,6 +80,23 @@ namespace gr {
 		       gr_vector_int &ninput_items,
 		       gr_vector_const_void_star &input_items,
 		       gr_vector_void_star &output_items);
+
+      // general_work() without the scheduler, returns the input
+      // items consumed. Used by gateway_bc.
+      int process(int noutput_items,
+		  gr_vector_const_void_star &input_items,
+		  gr_vector_void_star &output_items);
+
+      // process() with null packet deletion. The input taken by each
+      // BBFRAME varies with the null packets in it. Deleted null
+      // packets are consumed as they come and the BBFRAME the input
+      // ends in is kept for the next call, so it returns the output
+      // items of the BBFRAMEs completed.
+      int process_npd(int noutput_items,
+		      int ninput_items,
+		      int *consumed,
+		      gr_vector_const_void_star &input_items,
+		      gr_vector_void_star &output_items);
     };
 
   } // namespace dvbt2
@@ -101,6 +101,7 @@ namespace gr {
         }
         init_bb_randomiser();
         set_output_multiple(kbch);
+        perf_attach(this);
     }
 
     /*
@@ -130,6 +131,8 @@ void bbscrambler_bb_impl::init_bb_randomiser(void)
         const unsigned char *in = (const unsigned char *) input_items[0];
         unsigned char *out = (unsigned char *) output_items[0];
 
+        perf_begin();
+
         for (int i = 0; i < noutput_items; i += kbch)
         {
             for (int j = 0; j < (int)kbch; ++j)
@@ -138,6 +141,8 @@ void bbscrambler_bb_impl::init_bb_randomiser(void)
             }
         }
 
+        perf_end(noutput_items);
+
         // Tell runtime system how many output items we produced.
         return noutput_items;
     }
@@ -128,7 +128,24 @@ namespace gr {
             }
         }
         bch_poly_build_tables();
+        switch (bch_code)
+        {
+            case BCH_CODE_N12:
+                bch_table_build(m_poly_n_12, 6, 192);
+                break;
+            case BCH_CODE_N10:
+                bch_table_build(m_poly_n_10, 5, 160);
+                break;
+            case BCH_CODE_N8:
+                bch_table_build(m_poly_n_8, 4, 128);
+                break;
+            case BCH_CODE_S12:
+                bch_table_build(m_poly_s_12, 6, 168);
+                break;
+        }
+        bch = bch_select();
         set_output_multiple(nbch);
+        perf_attach(this);
     }
 
     /*
@@ -204,37 +221,24 @@ void bch_bb_impl::poly_reverse(int *pin, int *pout, int len)
     }
 }
 //
-// Shift a 128 bit register
+// Convert a packed polynomial, the register output bit at the LSB of
+// the last word, to the kernel table of a width bit register.
 //
-inline void bch_bb_impl::reg_4_shift(unsigned int *sr)
+void bch_bb_impl::bch_table_build(const unsigned int *packed, int words, int width)
 {
-    sr[3] = (sr[3] >> 1) | (sr[2] << 31);
-    sr[2] = (sr[2] >> 1) | (sr[1] << 31);
-    sr[1] = (sr[1] >> 1) | (sr[0] << 31);
-    sr[0] = (sr[0] >> 1);
-}
-//
-// Shift 160 bits
-//
-inline void bch_bb_impl::reg_5_shift(unsigned int *sr)
-{
-    sr[4] = (sr[4] >> 1) | (sr[3] << 31);
-    sr[3] = (sr[3] >> 1) | (sr[2] << 31);
-    sr[2] = (sr[2] >> 1) | (sr[1] << 31);
-    sr[1] = (sr[1] >> 1) | (sr[0] << 31);
-    sr[0] = (sr[0] >> 1);
-}
-//
-// Shift 192 bits
-//
-inline void bch_bb_impl::reg_6_shift(unsigned int *sr)
-{
-    sr[5] = (sr[5] >> 1) | (sr[4] << 31);
-    sr[4] = (sr[4] >> 1) | (sr[3] << 31);
-    sr[3] = (sr[3] >> 1) | (sr[2] << 31);
-    sr[2] = (sr[2] >> 1) | (sr[1] << 31);
-    sr[1] = (sr[1] >> 1) | (sr[0] << 31);
-    sr[0] = (sr[0] >> 1);
+    uint64_t poly[4] = {0, 0, 0, 0};
+    int drop = (words * 32) - width;
+    int bit;
+
+    for (int b = 0; b < width; b++)
+    {
+        bit = b + drop;
+        if ((packed[words - 1 - (bit / 32)] >> (bit % 32)) & 1)
+        {
+            poly[b / 64] |= (uint64_t)1 << (b % 64);
+        }
+    }
+    bch_table_init(&table, poly, width);
 }
 
 void bch_bb_impl::bch_poly_build_tables(void)
@@ -302,146 +306,42 @@ void bch_bb_impl::bch_poly_build_tables(void)
 }
 
     int
-    bch_bb_impl::general_work (int noutput_items,
-                       gr_vector_int &ninput_items,
+    bch_bb_impl::process(int noutput_items,
                        gr_vector_const_void_star &input_items,
                        gr_vector_void_star &output_items)
     {
         const unsigned char *in = (const unsigned char *) input_items[0];
         unsigned char *out = (unsigned char *) output_items[0];
-        unsigned char b, temp;
-        unsigned int shift[6];
         int consumed = 0;
 
-        switch (bch_code)
+        for (int i = 0; i < noutput_items; i += nbch)
         {
-            case BCH_CODE_N12:
-                for (int i = 0; i < noutput_items; i += nbch)
-                {
-                    //Zero the shift register
-                    memset(shift, 0, sizeof(unsigned int) * 6);
-                    // MSB of the codeword first
-                    for (int j = 0; j < (int)kbch; j++)
-                    {
-                        temp = *in++;
-                        *out++ = temp;
-                        consumed++;
-                        b = (temp ^ (shift[5] & 1));
-                        reg_6_shift(shift);
-                        if (b)
-                        {
-                            shift[0] ^= m_poly_n_12[0];
-                            shift[1] ^= m_poly_n_12[1];
-                            shift[2] ^= m_poly_n_12[2];
-                            shift[3] ^= m_poly_n_12[3];
-                            shift[4] ^= m_poly_n_12[4];
-                            shift[5] ^= m_poly_n_12[5];
-                        }
-                    }
-                    // Now add the parity bits to the output
-                    for (int n = 0; n < 192; n++)
-                    {
-                        *out++ = (shift[5] & 1);
-                        reg_6_shift(shift);
-                    }
-                }
-                break;
-            case BCH_CODE_N10:
-                for (int i = 0; i < noutput_items; i += nbch)
-                {
-                    //Zero the shift register
-                    memset(shift, 0, sizeof(unsigned int) * 5);
-                    // MSB of the codeword first
-                    for (int j = 0; j < (int)kbch; j++)
-                    {
-                        temp = *in++;
-                        *out++ = temp;
-                        consumed++;
-                        b = (temp ^ (shift[4] & 1));
-                        reg_5_shift(shift);
-                        if (b)
-                        {
-                            shift[0] ^= m_poly_n_10[0];
-                            shift[1] ^= m_poly_n_10[1];
-                            shift[2] ^= m_poly_n_10[2];
-                            shift[3] ^= m_poly_n_10[3];
-                            shift[4] ^= m_poly_n_10[4];
-                        }
-                    }
-                    // Now add the parity bits to the output
-                    for( int n = 0; n < 160; n++ )
-                    {
-                        *out++ = (shift[4] & 1);
-                        reg_5_shift(shift);
-                    }
-                }
-                break;
-            case BCH_CODE_N8:
-                for (int i = 0; i < noutput_items; i += nbch)
-                {
-                    //Zero the shift register
-                    memset(shift, 0, sizeof(unsigned int) * 4);
-                    // MSB of the codeword first
-                    for (int j = 0; j < (int)kbch; j++)
-                    {
-                        temp = *in++;
-                        *out++ = temp;
-                        consumed++;
-                        b = temp ^ (shift[3] & 1);
-                        reg_4_shift(shift);
-                        if (b)
-                        {
-                            shift[0] ^= m_poly_n_8[0];
-                            shift[1] ^= m_poly_n_8[1];
-                            shift[2] ^= m_poly_n_8[2];
-                            shift[3] ^= m_poly_n_8[3];
-                        }
-                    }
-                    // Now add the parity bits to the output
-                    for (int n = 0; n < 128; n++)
-                    {
-                        *out++ = shift[3] & 1;
-                        reg_4_shift(shift);
-                    }
-                }
-                break;
-            case BCH_CODE_S12:
-                for (int i = 0; i < noutput_items; i += nbch)
-                {
-                    //Zero the shift register
-                    memset(shift, 0, sizeof(unsigned int) * 6);
-                    // MSB of the codeword first
-                    for (int j = 0; j < (int)kbch; j++)
-                    {
-                        temp = *in++;
-                        *out++ = temp;
-                        consumed++;
-                        b = (temp ^ ((shift[5] & 0x01000000) ? 1 : 0));
-                        reg_6_shift(shift);
-                        if (b)
-                        {
-                            shift[0] ^= m_poly_s_12[0];
-                            shift[1] ^= m_poly_s_12[1];
-                            shift[2] ^= m_poly_s_12[2];
-                            shift[3] ^= m_poly_s_12[3];
-                            shift[4] ^= m_poly_s_12[4];
-                            shift[5] ^= m_poly_s_12[5];
-                        }
-                    }
-                    // Now add the parity bits to the output
-                    for (int n = 0; n < 168; n++)
-                    {
-                        *out++ = (shift[5] & 0x01000000) ? 1 : 0;
-                        reg_6_shift(shift);
-                    }
-                }
-                break;
+            // MSB of the codeword first, then the parity bits
+            memcpy(out, in, kbch);
+            bch(&out[kbch], in, kbch, &table);
+            in += kbch;
+            out += nbch;
+            consumed += kbch;
         }
 
+        return consumed;
+    }
+
+    int
+    bch_bb_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        perf_begin();
+        int consumed = process(noutput_items, input_items, output_items);
+
         // Tell runtime system how many input items we consumed on
         // each input stream.
         consume_each (consumed);
 
+        perf_end(noutput_items);
+
         // Tell runtime system how many output items we produced.
         return noutput_items;
     }
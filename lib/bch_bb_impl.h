@@ -22,6 +22,7 @@
 #define INCLUDED_DVBT2_BCH_BB_IMPL_H
 
 #include <dvbt2/bch_bb.h>
+#include "fec_kernels.h"
 
 namespace gr {
   namespace dvbt2 {
@@ -39,10 +40,10 @@ namespace gr {
       int poly_mult(const int*, int, const int*, int, int*);
       void poly_pack(const int*, unsigned int*, int);
       void poly_reverse(int*, int*, int);
-      inline void reg_4_shift(unsigned int*);
-      inline void reg_5_shift(unsigned int*);
-      inline void reg_6_shift(unsigned int*);
       void bch_poly_build_tables(void);
+      void bch_table_build(const unsigned int*, int, int);
+      bch_table table;
+      bch_kernel_t bch;
 
      public:
       bch_bb_impl(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate);
@@ -55,6 +56,12 @@ namespace gr {
 		       gr_vector_int &ninput_items,
 		       gr_vector_const_void_star &input_items,
 		       gr_vector_void_star &output_items);
+
+      // general_work() without the scheduler, returns the input
+      // items consumed. Used by gateway_bc.
+      int process(int noutput_items,
+		  gr_vector_const_void_star &input_items,
+		  gr_vector_void_star &output_items);
     };
 
   } // namespace dvbt2
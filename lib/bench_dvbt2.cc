@@ -0,0 +1,1022 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+/*
+ * bench-dvbt2: times the gateway chain on the V&V reference
+ * configurations of apps/vv001_cr35.py to apps/vv034_dtg016.py with
+ * synthetic transport stream. For each profile it reports every
+ * block's share of a frame, then the whole chain on one thread and
+ * on the parallel engine, as JSON on stdout and as a table on stderr.
+ * With --sweep it times ranges of parameters instead, see sweep(),
+ * and with --kernels each variant of the SIMD kernels.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <boost/thread/thread.hpp>
+#include <volk/volk.h>
+#include <gnuradio/high_res_timer.h>
+#include <dvbt2/t2_params.h>
+#include <dvbt2/t2_encoder.h>
+#include <dvbt2/t2_geometry.h>
+#include "t2_chain.h"
+#include "fec_kernels.h"
+#include "cell_kernels.h"
+#include "miso_kernels.h"
+#include "papr_kernels.h"
+
+using namespace gr::dvbt2;
+
+/*
+ * The V&V streams are 8 MHz channels. Parameters not listed keep the
+ * t2_params defaults, except that equalization is off unless listed.
+ * vv018 is the MISO pair, timed as group TX1.
+ */
+static const struct
+{
+    const char *name;
+    const char *params;
+} profiles[] =
+{
+    {"vv001_cr35", "rate=3_5 constellation=256QAM fecblocks=202 tiblocks=3 carriermode=EXTENDED fftsize=32K_T2GI guardinterval=1_128 l1constellation=64QAM pilotpattern=PP7 numdatasyms=59 inputmode=HIEFF"},
+    {"vv003_cr23", "rate=2_3 constellation=256QAM fecblocks=202 tiblocks=3 carriermode=EXTENDED fftsize=32K_T2GI guardinterval=1_128 l1constellation=64QAM pilotpattern=PP7 numdatasyms=59 inputmode=HIEFF equalization=ON"},
+    {"vv004_8kfft", "rate=3_4 constellation=64QAM fecblocks=50 tiblocks=1 carriermode=EXTENDED fftsize=8K_T2GI guardinterval=19_256 l1constellation=64QAM pilotpattern=PP5 numdatasyms=81 inputmode=HIEFF"},
+    {"vv005_8kfft", "rate=3_5 constellation=256QAM fecblocks=50 tiblocks=3 carriermode=EXTENDED fftsize=8K guardinterval=1_16 l1constellation=64QAM pilotpattern=PP8 numdatasyms=59 inputmode=HIEFF"},
+    {"vv007_16kfft", "rate=2_3 constellation=16QAM fecblocks=50 tiblocks=3 carriermode=EXTENDED fftsize=16K guardinterval=19_128 l1constellation=64QAM pilotpattern=PP8 numdatasyms=59 inputmode=HIEFF"},
+    {"vv008_16kfft", "rate=4_5 constellation=256QAM fecblocks=168 tiblocks=3 carriermode=EXTENDED fftsize=16K guardinterval=1_32 l1constellation=64QAM pilotpattern=PP6 numdatasyms=100 inputmode=NORMAL"},
+    {"vv009_4kfft", "rate=2_3 constellation=64QAM fecblocks=31 tiblocks=3 carriermode=NORMAL fftsize=4K guardinterval=1_32 l1constellation=16QAM pilotpattern=PP7 numdatasyms=100 inputmode=NORMAL equalization=ON"},
+    {"vv010_2kfft", "rate=3_5 constellation=16QAM fecblocks=93 tiblocks=3 carriermode=NORMAL fftsize=2K guardinterval=1_8 l1constellation=QPSK pilotpattern=PP2 numdatasyms=983 inputmode=NORMAL"},
+    {"vv011_1kfft", "rate=1_2 constellation=QPSK fecblocks=48 tiblocks=3 carriermode=NORMAL fftsize=1K guardinterval=1_8 l1constellation=BPSK pilotpattern=PP3 numdatasyms=1966 inputmode=NORMAL"},
+    {"vv012_64qam45", "rate=4_5 constellation=64QAM fecblocks=151 tiblocks=3 carriermode=EXTENDED fftsize=8K guardinterval=1_32 l1constellation=64QAM pilotpattern=PP7 numdatasyms=242 paprmode=TR vclip=2.57 iterations=50 inputmode=HIEFF"},
+    {"vv014_64qam34", "rate=3_4 constellation=64QAM fecblocks=151 tiblocks=3 carriermode=EXTENDED fftsize=8K guardinterval=1_32 l1constellation=64QAM pilotpattern=PP7 numdatasyms=242 paprmode=TR vclip=2.83 iterations=9 inputmode=HIEFF"},
+    {"vv015_8kfft", "rate=3_5 constellation=256QAM fecblocks=200 tiblocks=3 carriermode=EXTENDED fftsize=8K guardinterval=1_32 l1constellation=64QAM pilotpattern=PP7 numdatasyms=238 inputmode=HIEFF"},
+    {"vv016_256qam34", "rate=3_4 constellation=256QAM fecblocks=200 tiblocks=3 carriermode=EXTENDED fftsize=32K_T2GI guardinterval=1_128 l1constellation=64QAM pilotpattern=PP7 numdatasyms=59 paprmode=TR vclip=3.3 iterations=3 inputmode=HIEFF"},
+    {"vv018_miso", "rate=5_6 constellation=256QAM fecblocks=61 tiblocks=1 carriermode=EXTENDED fftsize=32K guardinterval=1_16 l1constellation=64QAM pilotpattern=PP2 numdatasyms=19 preamble=T2_MISO misogroup=TX1 inputmode=HIEFF equalization=ON"},
+    {"vv019_norot", "rate=3_5 constellation=256QAM rotation=OFF fecblocks=202 tiblocks=3 carriermode=EXTENDED fftsize=32K_T2GI guardinterval=1_128 l1constellation=64QAM pilotpattern=PP7 numdatasyms=59 inputmode=HIEFF"},
+    {"vv034_dtg016", "framesize=SHORT rate=4_5 constellation=QPSK fecblocks=204 tiblocks=0 carriermode=NORMAL fftsize=4K guardinterval=1_16 l1constellation=QPSK pilotpattern=PP5 numdatasyms=500 inputmode=HIEFF"}
+};
+
+static const int num_profiles = sizeof(profiles) / sizeof(profiles[0]);
+
+static bool
+set_params(t2_params &params, const char *text)
+{
+    std::string pairs(text);
+    size_t start = 0;
+
+    params.equalization = EQUALIZATION_OFF;
+    while (start < pairs.size())
+    {
+        size_t end = pairs.find(' ', start);
+        if (end == std::string::npos)
+        {
+            end = pairs.size();
+        }
+        std::string pair = pairs.substr(start, end - start);
+        size_t equals = pair.find('=');
+        if (equals == std::string::npos || !params.set(pair.substr(0, equals).c_str(), pair.substr(equals + 1).c_str()))
+        {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+/*
+ * Synthetic transport stream, null packets with a random payload. The
+ * buffer holds a frame of input and two packets more. When the input
+ * wraps, it continues at the same offset within a packet, so the
+ * packets stay aligned.
+ */
+class ts_source
+{
+  private:
+    std::vector<unsigned char> packets;
+    size_t frame_items;
+    size_t offset;
+
+  public:
+    ts_source(size_t items)
+      : frame_items(items),
+        offset(0)
+    {
+        unsigned int seed = 1;
+        size_t size = (items / 188 + 2) * 188;
+
+        packets.resize(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            packets[i] = seed >> 16;
+        }
+        for (size_t i = 0; i < size; i += 188)
+        {
+            packets[i] = 0x47;
+            packets[i + 1] = 0x1f;
+            packets[i + 2] = 0xff;
+        }
+    }
+
+    const unsigned char *frame()
+    {
+        if (offset + frame_items > packets.size())
+        {
+            offset %= 188;
+        }
+        return &packets[offset];
+    }
+
+    void consume(int items)
+    {
+        offset += items;
+    }
+
+    //! For a new chain, which starts at a packet.
+    void rewind()
+    {
+        offset = 0;
+    }
+};
+
+struct rate
+{
+    double seconds;
+    double bytes;
+    double samples;
+};
+
+static void
+print_rate(const char *name, int workers, const rate &r, double sample_rate)
+{
+    fprintf(stderr, "  %-8s %3d thread%s %8.2f Mbit/s %8.3f Msps %6.2fx real time\n", name, workers, workers == 1 ? " " : "s", r.bytes * 8.0 / r.seconds / 1e6, r.samples / r.seconds / 1e6, r.samples / r.seconds / sample_rate);
+}
+
+static void
+json_rate(FILE *fp, const char *name, int workers, const rate &r, double sample_rate, bool last)
+{
+    fprintf(fp, "            \"%s\": {\n", name);
+    fprintf(fp, "                \"workers\": %d,\n", workers);
+    fprintf(fp, "                \"seconds\": %.6f,\n", r.seconds);
+    fprintf(fp, "                \"mbps\": %.3f,\n", r.bytes * 8.0 / r.seconds / 1e6);
+    fprintf(fp, "                \"msps\": %.3f,\n", r.samples / r.seconds / 1e6);
+    fprintf(fp, "                \"realtime_margin\": %.3f\n", r.samples / r.seconds / sample_rate);
+    fprintf(fp, "            }%s\n", last ? "" : ",");
+}
+
+/*
+ * Times frames T2 frames on chain after a first one, which plans the
+ * FFTs and warms the caches, and adds each block's time to ticks.
+ */
+static rate
+run_single(t2_chain *chain, ts_source &source, gr_complex *out, int frames, std::vector<gr::high_res_timer_type> &ticks)
+{
+    rate single = {0.0, 0.0, 0.0};
+    int consumed;
+
+    source.consume(chain->frame(source.frame(), out));
+    chain->profile(&ticks[0]);
+    gr::high_res_timer_type start = gr::high_res_timer_now();
+    for (int i = 0; i < frames; i++)
+    {
+        consumed = chain->frame(source.frame(), out);
+        source.consume(consumed);
+        single.bytes += consumed;
+    }
+    single.seconds = (gr::high_res_timer_now() - start) / (double) gr::high_res_timer_tps();
+    single.samples = (double) frames * chain->output_items();
+    chain->profile(NULL);
+    return single;
+}
+
+static void
+bench_profiles(int frames, int num_workers, int depth, const std::vector<std::string> &filters, FILE *json)
+{
+    bool first = true;
+
+    fprintf(json, "{\n");
+    fprintf(json, "    \"frames\": %d,\n", frames);
+    fprintf(json, "    \"workers\": %d,\n", num_workers);
+    fprintf(json, "    \"depth\": %d,\n", depth);
+    fprintf(json, "    \"profiles\": [");
+    for (int n = 0; n < num_profiles; n++)
+    {
+        bool selected = filters.empty();
+        for (unsigned int f = 0; f < filters.size(); f++)
+        {
+            if (strstr(profiles[n].name, filters[f].c_str()) != NULL)
+            {
+                selected = true;
+            }
+        }
+        if (!selected)
+        {
+            continue;
+        }
+
+        t2_params params;
+        if (!set_params(params, profiles[n].params))
+        {
+            fprintf(stderr, "Bad parameters for %s\n", profiles[n].name);
+            exit(1);
+        }
+        double sample_rate = params.sample_rate();
+        t2_chain *chain = t2_chain::make(params);
+        int frame_items = chain->output_items();
+        gr_complex *out = (gr_complex*) volk_malloc(sizeof(gr_complex) * frame_items, volk_get_alignment());
+        if (out == NULL)
+        {
+            fprintf(stderr, "Bench volk_malloc, Out of memory.\n");
+            exit(1);
+        }
+        ts_source source(chain->input_items());
+        std::vector<gr::high_res_timer_type> ticks(t2_chain::BLOCKS, 0);
+        rate single = run_single(chain, source, out, frames, ticks);
+        rate parallel = {0.0, 0.0, 0.0};
+        int consumed;
+
+        source.rewind();
+        t2_encoder *encoder = new t2_encoder(params, ENGINE_PARALLEL, depth, std::vector<int>(num_workers, -1));
+        int total = frames * num_workers;
+        int pushed = 0;
+        int popped = 0;
+        gr::high_res_timer_type start = gr::high_res_timer_now();
+        while (popped < total)
+        {
+            while (pushed < total && (consumed = encoder->push(source.frame())) >= 0)
+            {
+                source.consume(consumed);
+                parallel.bytes += consumed;
+                pushed++;
+            }
+            encoder->pop(out);
+            popped++;
+        }
+        parallel.seconds = (gr::high_res_timer_now() - start) / (double) gr::high_res_timer_tps();
+        parallel.samples = (double) total * frame_items;
+        delete encoder;
+
+        double frame_seconds = frame_items / sample_rate;
+        double frame_bytes = single.bytes / frames;
+        fprintf(stderr, "%s: %.2f Mbit/s in real time, %.3f Msps, %.1f ms per T2 frame\n", profiles[n].name, frame_bytes * 8.0 / frame_seconds / 1e6, sample_rate / 1e6, frame_seconds * 1e3);
+        fprintf(stderr, "  %-20s %12s %8s %12s %6s\n", "block", "items/s", "unit", "ns/unit", "share");
+        fprintf(json, "%s\n        {\n", first ? "" : ",");
+        fprintf(json, "            \"name\": \"%s\",\n", profiles[n].name);
+        fprintf(json, "            \"params\": \"%s\",\n", profiles[n].params);
+        fprintf(json, "            \"sample_rate\": %.6f,\n", sample_rate);
+        fprintf(json, "            \"frame_samples\": %d,\n", frame_items);
+        fprintf(json, "            \"frame_bytes\": %.0f,\n", frame_bytes);
+        fprintf(json, "            \"frame_seconds\": %.9f,\n", frame_seconds);
+        fprintf(json, "            \"required_mbps\": %.3f,\n", frame_bytes * 8.0 / frame_seconds / 1e6);
+        fprintf(json, "            \"required_msps\": %.6f,\n", sample_rate / 1e6);
+        fprintf(json, "            \"blocks\": [");
+        bool first_block = true;
+        gr::high_res_timer_type frame_ticks = 0;
+        for (int b = 0; b < t2_chain::BLOCKS; b++)
+        {
+            frame_ticks += ticks[b];
+        }
+        for (int b = 0; b < t2_chain::BLOCKS; b++)
+        {
+            const char *name = t2_chain::block_name(b);
+            if (!chain->block_present(b))
+            {
+                continue;
+            }
+            const char *unit = b <= t2_chain::BLOCK_CELLINTERLEAVER ? "fecframe" : "symbol";
+            double seconds = ticks[b] / (double) gr::high_res_timer_tps();
+            double items_per_s = seconds > 0.0 ? (double) chain->block_items(b) * frames / seconds : 0.0;
+            double ns_per_unit = seconds * 1e9 / ((double) chain->block_units(b) * frames);
+            double share = frame_ticks > 0 ? (double) ticks[b] / frame_ticks : 0.0;
+            fprintf(stderr, "  %-20s %12.4g %8s %12.1f %5.1f%%\n", name, items_per_s, unit, ns_per_unit, share * 100.0);
+            fprintf(json, "%s\n                {", first_block ? "" : ",");
+            fprintf(json, "\"block\": \"%s\", ", name);
+            fprintf(json, "\"items_per_frame\": %d, ", chain->block_items(b));
+            fprintf(json, "\"unit\": \"%s\", ", unit);
+            fprintf(json, "\"units_per_frame\": %d, ", chain->block_units(b));
+            fprintf(json, "\"items_per_s\": %.1f, ", items_per_s);
+            fprintf(json, "\"ns_per_unit\": %.1f, ", ns_per_unit);
+            fprintf(json, "\"share\": %.4f}", share);
+            first_block = false;
+        }
+        fprintf(json, "\n            ],\n");
+        json_rate(json, "single", 1, single, sample_rate, false);
+        json_rate(json, "parallel", num_workers, parallel, sample_rate, true);
+        fprintf(json, "        }");
+        print_rate("single", 1, single, sample_rate);
+        print_rate("parallel", num_workers, parallel, sample_rate);
+        first = false;
+
+        delete chain;
+        volk_free(out);
+    }
+    fprintf(json, "\n    ]\n");
+    fprintf(json, "}\n");
+}
+
+/*
+ * --kernels times every variant of each kernel this CPU can run on
+ * the unit sizes the chain uses, as a table on stdout. qa-dvbt2 checks
+ * that they agree, this only measures them.
+ */
+
+static const char *kernel_fftsizes[6] = {"1K", "2K", "4K", "8K", "16K", "32K"};
+
+// Random bits, one per byte.
+static void
+random_bits(std::vector<unsigned char> &bits)
+{
+    for (unsigned int n = 0; n < bits.size(); n++)
+    {
+        bits[n] = rand() & 1;
+    }
+}
+
+// A table shaped like an Annex A or B one, with entries addresses in
+// each of groups groups.
+static void
+random_ldpc_table(ldpc_table *table, int q, int groups, int entries)
+{
+    int e = 0;
+
+    table->q = q;
+    table->groups = groups;
+    for (int g = 0; g < groups; g++)
+    {
+        table->first[g] = e;
+        for (int n = 0; n < entries; n++)
+        {
+            table->address[e++] = rand() % (360 * q);
+        }
+    }
+    table->first[groups] = e;
+}
+
+// Throughput of each variant for a normal and a short FECFRAME, the
+// LDPC tables shaped like the largest of each size (3/5 and 2/5).
+static void
+bench_fec(void)
+{
+    bch_impl bch[MAX_FEC_KERNELS];
+    ldpc_impl ldpc[MAX_FEC_KERNELS];
+    interleave_impl interleave[MAX_FEC_KERNELS];
+    int bch_count = bch_kernels(bch);
+    int ldpc_count = ldpc_kernels(ldpc);
+    int interleave_count = interleave_kernels(interleave);
+    const char *names[2] = {"normal", "short"};
+    const int kbch[2] = {38688, 6312};
+    const int widths[2] = {192, 168};
+    const int q[2] = {72, 27};
+    const int groups[2] = {108, 18};
+    const int entries[2] = {6, 6};
+    const int frame_bits[2] = {64800, 16200};
+    const uint64_t poly[4] = {0x2f3e5a4bULL, 0x11d3ULL, 0, 0};
+    bch_table *table = new bch_table;
+    ldpc_table ldpc_table;
+    std::vector<unsigned char> bits(64800);
+    std::vector<unsigned char> out(64800);
+    std::vector<int> perm;
+    std::vector<int> il_table;
+    gr::high_res_timer_type start;
+    double seconds;
+    int repeat;
+
+    printf("fec\n");
+    srand(4);
+    random_bits(bits);
+    for (int f = 0; f < 2; f++)
+    {
+        repeat = 4000000 / frame_bits[f];
+        bch_table_init(table, poly, widths[f]);
+        printf("  %-6s BCH  ", names[f]);
+        for (int k = 0; k < bch_count; k++)
+        {
+            start = gr::high_res_timer_now();
+            for (int r = 0; r < repeat; r++)
+            {
+                bch[k].kernel(&out[0], &bits[0], kbch[f], table);
+            }
+            seconds = (double)(gr::high_res_timer_now() - start) / gr::high_res_timer_tps();
+            printf("  %s %.1f us/frame", bch[k].name, (seconds * 1.0e6) / repeat);
+        }
+        printf("\n");
+        random_ldpc_table(&ldpc_table, q[f], groups[f], entries[f]);
+        printf("  %-6s LDPC ", names[f]);
+        for (int k = 0; k < ldpc_count; k++)
+        {
+            start = gr::high_res_timer_now();
+            for (int r = 0; r < repeat; r++)
+            {
+                ldpc[k].kernel(&out[0], &bits[0], &ldpc_table);
+            }
+            seconds = (double)(gr::high_res_timer_now() - start) / gr::high_res_timer_tps();
+            printf("  %s %.1f us/frame", ldpc[k].name, (seconds * 1.0e6) / repeat);
+        }
+        printf("\n");
+        for (int mod = 2; mod <= 8; mod += 2)
+        {
+            perm.resize(frame_bits[f]);
+            for (int n = 0; n < frame_bits[f]; n++)
+            {
+                perm[n] = n;
+            }
+            std::random_shuffle(perm.begin(), perm.end());
+            il_table.resize(interleave_table_size(frame_bits[f] / mod, mod));
+            interleave_table(&il_table[0], &perm[0], frame_bits[f] / mod, mod, frame_bits[f]);
+            printf("  %-6s IL%d  ", names[f], mod);
+            for (int k = 0; k < interleave_count; k++)
+            {
+                start = gr::high_res_timer_now();
+                for (int r = 0; r < repeat; r++)
+                {
+                    interleave[k].kernel(&out[0], &bits[0], &il_table[0], frame_bits[f] / mod, mod);
+                }
+                seconds = (double)(gr::high_res_timer_now() - start) / gr::high_res_timer_tps();
+                printf("  %s %.1f us/frame", interleave[k].name, (seconds * 1.0e6) / repeat);
+            }
+            printf("\n");
+        }
+    }
+    delete table;
+}
+
+// Throughput of each variant over the cells of a 64800 bit FECFRAME
+// and over a 32K data symbol scattered at random.
+static void
+bench_cell(void)
+{
+    mapper_impl mapper[MAX_CELL_KERNELS];
+    gather_impl gather[MAX_CELL_KERNELS];
+    int mapper_count = mapper_kernels(mapper);
+    int gather_count = gather_kernels(gather);
+    const char *names[4] = {"QPSK", "16QAM", "64QAM", "256QAM"};
+    const int masks[4] = {0x3, 0xf, 0x3f, 0xff};
+    const int cells[4] = {32400, 16200, 10800, 8100};
+    const int carriers = 27404;
+    std::vector<gr_complex> constellation(256, gr_complex(0.5, -0.25));
+    std::vector<unsigned char> bits(32400);
+    std::vector<gr_complex> in(carriers);
+    std::vector<int> index(carriers);
+    std::vector<gr_complex> out(32400);
+    gr::high_res_timer_type start;
+    double seconds;
+    int repeat;
+
+    printf("cell\n");
+    srand(3);
+    for (unsigned int n = 0; n < bits.size(); n++)
+    {
+        bits[n] = rand();
+    }
+    for (int n = 0; n < carriers; n++)
+    {
+        index[n] = rand() % carriers;
+    }
+    for (int m = 0; m < 4; m++)
+    {
+        for (int delay = 0; delay < 2; delay++)
+        {
+            repeat = 4000000 / cells[m];
+            printf("  map    %-6s %-7s", names[m], delay ? "rotated" : "");
+            for (int k = 0; k < mapper_count; k++)
+            {
+                start = gr::high_res_timer_now();
+                for (int r = 0; r < repeat; r++)
+                {
+                    mapper[k].kernel(&out[0], &bits[0], &constellation[0], masks[m], cells[m], delay);
+                }
+                seconds = (double)(gr::high_res_timer_now() - start) / gr::high_res_timer_tps();
+                printf("  %s %.2f ns/cell", mapper[k].name, (seconds * 1.0e9) / ((double)repeat * cells[m]));
+            }
+            printf("\n");
+        }
+    }
+    repeat = 4000000 / carriers;
+    printf("  gather 32K           ");
+    for (int k = 0; k < gather_count; k++)
+    {
+        start = gr::high_res_timer_now();
+        for (int r = 0; r < repeat; r++)
+        {
+            gather[k].kernel(&out[0], &in[0], &index[0], carriers);
+        }
+        seconds = (double)(gr::high_res_timer_now() - start) / gr::high_res_timer_tps();
+        printf("  %s %.2f ns/cell", gather[k].name, (seconds * 1.0e9) / ((double)repeat * carriers));
+    }
+    printf("\n");
+}
+
+// Throughput of each Alamouti variant over the P2, data and frame
+// closing symbol cell counts of every FFT size (PP2, normal carriers).
+static void
+bench_alamouti(void)
+{
+    alamouti_impl list[MAX_ALAMOUTI_KERNELS];
+    int count = alamouti_kernels(list);
+    const int cells[6][3] =
+    {
+        {546, 768, 710},
+        {1098, 1532, 1420},
+        {2198, 3092, 2840},
+        {4398, 6214, 5680},
+        {8814, 12436, 11360},
+        {17612, 24886, 22720}
+    };
+    const char *symbols[3] = {"P2", "data", "FC"};
+    std::vector<gr_complex> in(cells[5][1] + 1, gr_complex(0.5, -0.25));
+    std::vector<gr_complex> out(cells[5][1] + 1);
+    gr::high_res_timer_type start;
+    double seconds;
+    int pairs, repeat;
+
+    printf("alamouti\n");
+    for (int f = 0; f < 6; f++)
+    {
+        for (int s = 0; s < 3; s++)
+        {
+            pairs = (cells[f][s] + 1) / 2;
+            repeat = 4000000 / cells[f][s];
+            printf("  %-4s %-4s %5d cells", kernel_fftsizes[f], symbols[s], cells[f][s]);
+            for (int k = 0; k < count; k++)
+            {
+                start = gr::high_res_timer_now();
+                for (int r = 0; r < repeat; r++)
+                {
+                    list[k].kernel(&out[0], &in[0], pairs);
+                }
+                seconds = (double)(gr::high_res_timer_now() - start) / gr::high_res_timer_tps();
+                printf("  %s %.2f ns/cell", list[k].name, (seconds * 1.0e9) / ((double)repeat * cells[f][s]));
+            }
+            printf("\n");
+        }
+    }
+}
+
+// Throughput of each variant over one oversampled symbol of every
+// FFT size, as paprtr_cc runs it once per iteration.
+static void
+bench_tr(void)
+{
+    tr_impl list[MAX_PAPR_KERNELS];
+    int count = tr_kernels(list);
+    const int os_size = 4096;
+    std::vector<gr_complex> signal(os_size * 32, gr_complex(0.5, -0.25));
+    std::vector<gr_complex> kernel(os_size * 32, gr_complex(0.125, 0.75));
+    gr::high_res_timer_type start;
+    double seconds;
+    int length, repeat;
+
+    printf("tone reservation\n");
+    for (int f = 0; f < 6; f++)
+    {
+        length = os_size << f;
+        repeat = 40000000 / length;
+        printf("  %-4s %7d samples", kernel_fftsizes[f], length);
+        for (int k = 0; k < count; k++)
+        {
+            start = gr::high_res_timer_now();
+            for (int r = 0; r < repeat; r++)
+            {
+                list[k].kernel(&signal[0], &kernel[0], gr_complex(1.0e-6, -1.0e-6), length);
+            }
+            seconds = (double)(gr::high_res_timer_now() - start) / gr::high_res_timer_tps();
+            printf("  %s %.3f ns/sample", list[k].name, (seconds * 1.0e9) / ((double)repeat * length));
+        }
+        printf("\n");
+    }
+}
+
+static void
+bench_kernels(void)
+{
+    bench_fec();
+    bench_cell();
+    bench_alamouti();
+    bench_tr();
+}
+
+/*
+ * Sweep mode. Every combination of the listed parameter values that
+ * the pilot pattern table of ETSI EN 302 755 allows is timed on one
+ * thread and written as one CSV row, for heat maps of throughput and
+ * memory against the parameters.
+ */
+
+static const struct
+{
+    const char *key;
+    const char *values;
+} sweep_defaults[] =
+{
+    {"fftsize", "1K,2K,4K,8K,16K,32K"},
+    {"guardinterval", "1_128,1_32,1_16,19_256,1_8,19_128,1_4"},
+    {"pilotpattern", "PP1,PP2,PP3,PP4,PP5,PP6,PP7,PP8"},
+    {"constellation", "QPSK,16QAM,64QAM,256QAM"},
+    {"rate", "1_2,3_5,2_3,3_4,4_5,5_6"},
+    {"fecblocks", "max"},
+    {"tiblocks", "auto"},
+    {"numdatasyms", "auto"}
+};
+
+static const int num_sweep_defaults = sizeof(sweep_defaults) / sizeof(sweep_defaults[0]);
+
+static void
+usage(void)
+{
+    fprintf(stderr, "Usage: bench-dvbt2 [options]\n");
+    fprintf(stderr, "       bench-dvbt2 --sweep [options] [--param value,value...]\n");
+    fprintf(stderr, "       bench-dvbt2 --kernels\n");
+    fprintf(stderr, "  --frames n      T2 frames timed per configuration and thread (8, 2 for --sweep)\n");
+    fprintf(stderr, "  --workers n     parallel engine threads (one per CPU)\n");
+    fprintf(stderr, "  --depth n       frames in flight per thread (2)\n");
+    fprintf(stderr, "  --profile name  only profiles whose name contains name, repeatable\n");
+    fprintf(stderr, "  --json file     write the JSON to file instead of stdout\n");
+    fprintf(stderr, "  --list          list the profiles and exit\n");
+    fprintf(stderr, "Sweep options, the CSV goes to stdout:\n");
+    fprintf(stderr, "  --csv file      write the CSV to file instead\n");
+    fprintf(stderr, "  --frame-ms t    T2 frame length for numdatasyms auto (200)\n");
+    fprintf(stderr, "  --param list    modulator parameter, swept over a comma separated list\n");
+    fprintf(stderr, "Swept by default:\n");
+    for (int n = 0; n < num_sweep_defaults; n++)
+    {
+        fprintf(stderr, "  --%-15s %s\n", sweep_defaults[n].key, sweep_defaults[n].values);
+    }
+    fprintf(stderr, "fecblocks max fills the frame, tiblocks auto uses the fewest TI blocks\n");
+    fprintf(stderr, "a receiver holds. Other parameters:\n");
+    t2_params::usage(stderr);
+    exit(1);
+}
+
+struct sweep_axis
+{
+    std::string key;
+    std::vector<std::string> values;
+};
+
+static std::vector<std::string>
+split_list(const std::string &text)
+{
+    std::vector<std::string> values;
+    size_t start = 0;
+
+    while (start <= text.size())
+    {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos)
+        {
+            end = text.size();
+        }
+        if (end > start)
+        {
+            values.push_back(text.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return values;
+}
+
+/*
+ * Data symbols that fill frame_ms with the P1 and P2 symbols, or 0
+ * when not even one fits.
+ */
+static int
+fill_numdatasyms(const t2_params &params, double frame_ms)
+{
+    t2_geometry geometry(params.carriermode, params.fftsize, params.pilotpattern, params.guardinterval, params.paprmode, params.preamble);
+    int symbols = (int) ((frame_ms * 1e-3 * params.sample_rate() - 2048.0) / (geometry.fft_size + geometry.guard_interval)) - geometry.N_P2;
+
+    return symbols > 0 ? symbols : 0;
+}
+
+static double
+resident_bytes(void)
+{
+    long pages = 0;
+    long resident = 0;
+    FILE *fp = fopen("/proc/self/statm", "r");
+
+    if (fp != NULL)
+    {
+        if (fscanf(fp, "%ld %ld", &pages, &resident) != 2)
+        {
+            resident = 0;
+        }
+        fclose(fp);
+    }
+    return (double) resident * sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * Resolves fecblocks=max, tiblocks=auto and numdatasyms=auto. Returns
+ * false for combinations the standard or the frame do not allow.
+ */
+static bool
+resolve_sweep(t2_params &params, const std::vector<std::string> &keys, const std::vector<std::string> &values, double frame_ms)
+{
+    bool max_fecblocks = false;
+    bool auto_tiblocks = false;
+    bool auto_numdatasyms = false;
+
+    for (unsigned int k = 0; k < keys.size(); k++)
+    {
+        if (keys[k] == "fecblocks" && values[k] == "max")
+        {
+            max_fecblocks = true;
+        }
+        else if (keys[k] == "tiblocks" && values[k] == "auto")
+        {
+            auto_tiblocks = true;
+        }
+        else if (keys[k] == "numdatasyms" && values[k] == "auto")
+        {
+            auto_numdatasyms = true;
+        }
+        else if (!params.set(keys[k].c_str(), values[k].c_str()))
+        {
+            fprintf(stderr, "Bad value %s for %s\n", values[k].c_str(), keys[k].c_str());
+            exit(1);
+        }
+    }
+    if (!t2_geometry::allowed(params.carriermode, params.fftsize, params.guardinterval, params.pilotpattern))
+    {
+        return false;
+    }
+    if (auto_numdatasyms)
+    {
+        params.numdatasyms = fill_numdatasyms(params, frame_ms);
+    }
+    if (params.numdatasyms < 1)
+    {
+        return false;
+    }
+
+    t2_capacity capacity(params);
+    t2_constraints constraints;
+    if (max_fecblocks)
+    {
+        params.fecblocks = capacity.fec_capacity < constraints.max_fecblocks ? capacity.fec_capacity : constraints.max_fecblocks;
+    }
+    if (params.fecblocks < 1 || params.fecblocks > capacity.fec_capacity)
+    {
+        return false;
+    }
+
+    int bits = params.constellation == MOD_QPSK ? 2 : params.constellation == MOD_16QAM ? 4 : params.constellation == MOD_64QAM ? 6 : 8;
+    int cell_size = (params.framesize == FECFRAME_NORMAL ? 64800 : 16200) / bits;
+    if (auto_tiblocks)
+    {
+        int blocks_per_ti = constraints.max_ti_cells / cell_size;
+        params.tiblocks = (params.fecblocks + blocks_per_ti - 1) / blocks_per_ti;
+    }
+    return params.tiblocks <= params.fecblocks;
+}
+
+static void
+sweep(const t2_params &base, const std::vector<sweep_axis> &axes, int frames, double frame_ms, FILE *csv)
+{
+    std::vector<unsigned int> index(axes.size(), 0);
+    std::vector<std::string> keys(axes.size());
+    std::vector<std::string> values(axes.size());
+    int rows = 0;
+    int skipped = 0;
+
+    // Large buffers come from mmap and go back to the system when
+    // freed, so each chain's resident memory can be measured.
+    mallopt(M_MMAP_THRESHOLD, 64 * 1024);
+
+    for (unsigned int a = 0; a < axes.size(); a++)
+    {
+        keys[a] = axes[a].key;
+        fprintf(csv, "%s,", axes[a].key.c_str());
+    }
+    fprintf(csv, "fecblocks_used,tiblocks_used,numdatasyms_used,frame_ms,bitrate_mbps,msps,realtime_margin,resident_mb,ti_mb");
+    for (int b = 0; b < t2_chain::BLOCKS; b++)
+    {
+        fprintf(csv, ",%s_ns", t2_chain::block_name(b));
+    }
+    fprintf(csv, "\n");
+
+    for (;;)
+    {
+        t2_params params = base;
+        for (unsigned int a = 0; a < axes.size(); a++)
+        {
+            values[a] = axes[a].values[index[a]];
+        }
+        if (resolve_sweep(params, keys, values, frame_ms))
+        {
+            double resident = resident_bytes();
+            t2_chain *chain = t2_chain::make(params);
+            int frame_items = chain->output_items();
+            gr_complex *out = (gr_complex*) volk_malloc(sizeof(gr_complex) * frame_items, volk_get_alignment());
+            if (out == NULL)
+            {
+                fprintf(stderr, "Bench volk_malloc, Out of memory.\n");
+                exit(1);
+            }
+            ts_source source(chain->input_items());
+            std::vector<gr::high_res_timer_type> ticks(t2_chain::BLOCKS, 0);
+            rate single = run_single(chain, source, out, frames, ticks);
+            resident = resident_bytes() - resident;
+            double sample_rate = params.sample_rate();
+            double frame_seconds = frame_items / sample_rate;
+
+            for (unsigned int a = 0; a < axes.size(); a++)
+            {
+                fprintf(csv, "%s,", values[a].c_str());
+            }
+            fprintf(csv, "%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f", params.fecblocks, params.tiblocks, params.numdatasyms, frame_seconds * 1e3, single.bytes / frames * 8.0 / frame_seconds / 1e6, single.samples / single.seconds / 1e6, single.samples / single.seconds / sample_rate, resident / 1048576.0, chain->block_items(t2_chain::BLOCK_CELLINTERLEAVER) * sizeof(gr_complex) / 1048576.0);
+            for (int b = 0; b < t2_chain::BLOCKS; b++)
+            {
+                if (chain->block_present(b))
+                {
+                    fprintf(csv, ",%.1f", ticks[b] / (double) gr::high_res_timer_tps() * 1e9 / ((double) chain->block_units(b) * frames));
+                }
+                else
+                {
+                    fprintf(csv, ",");
+                }
+            }
+            fprintf(csv, "\n");
+            fflush(csv);
+            rows++;
+            fprintf(stderr, "\r%d configurations, %d skipped", rows, skipped);
+
+            delete chain;
+            volk_free(out);
+        }
+        else
+        {
+            skipped++;
+        }
+
+        unsigned int a = 0;
+        while (a < axes.size() && ++index[a] == axes[a].values.size())
+        {
+            index[a++] = 0;
+        }
+        if (a == axes.size())
+        {
+            break;
+        }
+    }
+    fprintf(stderr, "\r%d configurations, %d skipped\n", rows, skipped);
+}
+
+int
+main(int argc, char **argv)
+{
+    int frames = 0;
+    int num_workers = boost::thread::hardware_concurrency();
+    int depth = 2;
+    std::vector<std::string> filters;
+    const char *output_path = NULL;
+    bool sweep_mode = false;
+    double frame_ms = 200.0;
+    t2_params base;
+    std::vector<sweep_axis> axes;
+
+    base.equalization = EQUALIZATION_OFF;
+    for (int n = 0; n < num_sweep_defaults; n++)
+    {
+        sweep_axis axis;
+        axis.key = sweep_defaults[n].key;
+        axis.values = split_list(sweep_defaults[n].values);
+        axes.push_back(axis);
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string key = argv[i];
+
+        if (key == "--list")
+        {
+            for (int n = 0; n < num_profiles; n++)
+            {
+                printf("%-16s %s\n", profiles[n].name, profiles[n].params);
+            }
+            return 0;
+        }
+        if (key == "--kernels")
+        {
+            bench_kernels();
+            return 0;
+        }
+        if (key == "--sweep")
+        {
+            sweep_mode = true;
+            continue;
+        }
+        if (key.compare(0, 2, "--") != 0 || i + 1 == argc)
+        {
+            usage();
+        }
+        const char *value = argv[++i];
+        key = key.substr(2);
+        if (key == "frames")
+        {
+            frames = atoi(value);
+        }
+        else if (key == "workers")
+        {
+            num_workers = atoi(value);
+        }
+        else if (key == "depth")
+        {
+            depth = atoi(value);
+        }
+        else if (key == "profile")
+        {
+            filters.push_back(value);
+        }
+        else if (key == "json" || key == "csv")
+        {
+            output_path = value;
+        }
+        else if (key == "frame-ms")
+        {
+            frame_ms = atof(value);
+        }
+        else
+        {
+            // A modulator parameter, swept when it has a list of values.
+            std::vector<std::string> values = split_list(value);
+            unsigned int a = 0;
+            while (a < axes.size() && axes[a].key != key)
+            {
+                a++;
+            }
+            if (a == axes.size() && values.size() > 1)
+            {
+                sweep_axis axis;
+                axis.key = key;
+                axes.push_back(axis);
+            }
+            if (a < axes.size() || values.size() > 1)
+            {
+                axes[a].values = values;
+            }
+            else if (!base.set(key.c_str(), value))
+            {
+                fprintf(stderr, "Bad option --%s %s\n", key.c_str(), value);
+                usage();
+            }
+        }
+    }
+    if (frames < 1)
+    {
+        frames = sweep_mode ? 2 : 8;
+    }
+    if (num_workers < 1)
+    {
+        num_workers = 1;
+    }
+
+    FILE *output = output_path == NULL ? stdout : fopen(output_path, "w");
+    if (output == NULL)
+    {
+        perror(output_path);
+        return 1;
+    }
+    if (sweep_mode)
+    {
+        sweep(base, axes, frames, frame_ms, output);
+    }
+    else
+    {
+        bench_profiles(frames, num_workers, depth, filters, output);
+    }
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+    return 0;
+}
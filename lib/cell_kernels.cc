@@ -0,0 +1,230 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "cell_kernels.h"
+#include <string.h>
+#ifdef DVBT2_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace gr {
+  namespace dvbt2 {
+
+static inline void mapper_cell(gr_complex *out, const unsigned char *cells, const gr_complex *constellation, int mask, int count, int delay, int j)
+{
+    out[j] = constellation[cells[j] & mask];
+    if (delay)
+    {
+        out[j].imag() = constellation[cells[j == 0 ? count - 1 : j - 1] & mask].imag();
+    }
+}
+
+void mapper_generic(gr_complex *out, const unsigned char *cells, const gr_complex *constellation, int mask, int count, int delay)
+{
+    for (int j = 0; j < count; j++)
+    {
+        mapper_cell(out, cells, constellation, mask, count, delay, j);
+    }
+}
+
+void gather_generic(gr_complex *out, const gr_complex *in, const int *index, int count)
+{
+    for (int j = 0; j < count; j++)
+    {
+        out[j] = in[index[j]];
+    }
+}
+
+// Each cell gathers the real part of its own point and the imaginary
+// part of its own or the previous cell's point, as floats.
+#ifdef DVBT2_KERNELS_X86
+__attribute__((target("avx2")))
+void mapper_avx2(gr_complex *out, const unsigned char *cells, const gr_complex *constellation, int mask, int count, int delay)
+{
+    const float *points = (const float *) constellation;
+    const __m128i m = _mm_set1_epi32(mask);
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i a, b;
+    int x, j = 0;
+
+    if (delay && count > 0)
+    {
+        mapper_cell(out, cells, constellation, mask, count, delay, j++);
+    }
+    for (; j + 4 <= count; j += 4)
+    {
+        memcpy(&x, &cells[j], sizeof(x));
+        a = _mm_and_si128(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(x)), m);
+        if (delay)
+        {
+            memcpy(&x, &cells[j - 1], sizeof(x));
+            b = _mm_and_si128(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(x)), m);
+        }
+        else
+        {
+            b = a;
+        }
+        a = _mm_slli_epi32(a, 1);
+        b = _mm_add_epi32(_mm_slli_epi32(b, 1), one);
+        _mm256_storeu_ps((float *)&out[j], _mm256_i32gather_ps(points, _mm256_set_m128i(_mm_unpackhi_epi32(a, b), _mm_unpacklo_epi32(a, b)), 4));
+    }
+    for (; j < count; j++)
+    {
+        mapper_cell(out, cells, constellation, mask, count, delay, j);
+    }
+}
+
+__attribute__((target("avx512f")))
+void mapper_avx512(gr_complex *out, const unsigned char *cells, const gr_complex *constellation, int mask, int count, int delay)
+{
+    const float *points = (const float *) constellation;
+    const __m256i m = _mm256_set1_epi32(mask);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m512i pairs = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+    __m256i a, b;
+    int j = 0;
+
+    if (delay && count > 0)
+    {
+        mapper_cell(out, cells, constellation, mask, count, delay, j++);
+    }
+    for (; j + 8 <= count; j += 8)
+    {
+        a = _mm256_and_si256(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&cells[j])), m);
+        if (delay)
+        {
+            b = _mm256_and_si256(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&cells[j - 1])), m);
+        }
+        else
+        {
+            b = a;
+        }
+        a = _mm256_slli_epi32(a, 1);
+        b = _mm256_add_epi32(_mm256_slli_epi32(b, 1), one);
+        _mm512_storeu_ps((float *)&out[j], _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xffff, _mm512_permutex2var_epi32(_mm512_castsi256_si512(a), pairs, _mm512_castsi256_si512(b)), points, 4));
+    }
+    for (; j < count; j++)
+    {
+        mapper_cell(out, cells, constellation, mask, count, delay, j);
+    }
+}
+
+// A cell is 64 bits, gathered as a double.
+__attribute__((target("avx2")))
+void gather_avx2(gr_complex *out, const gr_complex *in, const int *index, int count)
+{
+    const double *src = (const double *) in;
+    double *dst = (double *) out;
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi32(-1));
+    int j;
+
+    for (j = 0; j + 4 <= count; j += 4)
+    {
+        _mm256_storeu_pd(&dst[j], _mm256_mask_i32gather_pd(_mm256_setzero_pd(), src, _mm_loadu_si128((const __m128i *)&index[j]), all, 8));
+    }
+    gather_generic(&out[j], in, &index[j], count - j);
+}
+
+__attribute__((target("avx512f")))
+void gather_avx512(gr_complex *out, const gr_complex *in, const int *index, int count)
+{
+    const double *src = (const double *) in;
+    double *dst = (double *) out;
+    int j;
+
+    for (j = 0; j + 8 <= count; j += 8)
+    {
+        _mm512_storeu_pd(&dst[j], _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xff, _mm256_loadu_si256((const __m256i *)&index[j]), (const void *)src, 8));
+    }
+    gather_generic(&out[j], in, &index[j], count - j);
+}
+#endif
+
+int mapper_kernels(mapper_impl *list)
+{
+    int count = 0;
+
+    list[count].name = "generic";
+    list[count].arch = ARCH_GENERIC;
+    list[count++].kernel = mapper_generic;
+#ifdef DVBT2_KERNELS_X86
+    if (kernel_arch_supported(ARCH_AVX2))
+    {
+        list[count].name = "avx2";
+        list[count].arch = ARCH_AVX2;
+        list[count++].kernel = mapper_avx2;
+    }
+    if (kernel_arch_supported(ARCH_AVX512))
+    {
+        list[count].name = "avx512";
+        list[count].arch = ARCH_AVX512;
+        list[count++].kernel = mapper_avx512;
+    }
+#endif
+    return count;
+}
+
+int gather_kernels(gather_impl *list)
+{
+    int count = 0;
+
+    list[count].name = "generic";
+    list[count].arch = ARCH_GENERIC;
+    list[count++].kernel = gather_generic;
+#ifdef DVBT2_KERNELS_X86
+    if (kernel_arch_supported(ARCH_AVX2))
+    {
+        list[count].name = "avx2";
+        list[count].arch = ARCH_AVX2;
+        list[count++].kernel = gather_avx2;
+    }
+    if (kernel_arch_supported(ARCH_AVX512))
+    {
+        list[count].name = "avx512";
+        list[count].arch = ARCH_AVX512;
+        list[count++].kernel = gather_avx512;
+    }
+#endif
+    return count;
+}
+
+mapper_kernel_t mapper_select(void)
+{
+    mapper_impl list[MAX_CELL_KERNELS];
+    int count = mapper_kernels(list);
+
+    return kernel_choose(list, count).kernel;
+}
+
+gather_kernel_t gather_select(void)
+{
+    gather_impl list[MAX_CELL_KERNELS];
+    int count = gather_kernels(list);
+
+    return kernel_choose(list, count).kernel;
+}
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
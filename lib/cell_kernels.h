@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_DVBT2_CELL_KERNELS_H
+#define INCLUDED_DVBT2_CELL_KERNELS_H
+
+#include <gnuradio/gr_complex.h>
+#include "kernel_dispatch.h"
+
+#define MAX_CELL_KERNELS 4
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * Constellation mapping of count cells, each the constellation
+     * point of (cell & mask). With delay set, the imaginary part comes
+     * from the previous cell of the FEC block instead, cyclically, as
+     * for rotated constellations.
+     */
+    typedef void (*mapper_kernel_t)(gr_complex *out, const unsigned char *cells, const gr_complex *constellation, int mask, int count, int delay);
+
+    /*
+     * out[j] = in[index[j]], for the time, cell and frequency
+     * interleavers.
+     */
+    typedef void (*gather_kernel_t)(gr_complex *out, const gr_complex *in, const int *index, int count);
+
+    struct mapper_impl
+    {
+      const char *name;
+      kernel_arch_t arch;
+      mapper_kernel_t kernel;
+    };
+
+    struct gather_impl
+    {
+      const char *name;
+      kernel_arch_t arch;
+      gather_kernel_t kernel;
+    };
+
+    void mapper_generic(gr_complex *out, const unsigned char *cells, const gr_complex *constellation, int mask, int count, int delay);
+    void gather_generic(gr_complex *out, const gr_complex *in, const int *index, int count);
+#ifdef DVBT2_KERNELS_X86
+    void mapper_avx2(gr_complex *out, const unsigned char *cells, const gr_complex *constellation, int mask, int count, int delay);
+    void mapper_avx512(gr_complex *out, const unsigned char *cells, const gr_complex *constellation, int mask, int count, int delay);
+    void gather_avx2(gr_complex *out, const gr_complex *in, const int *index, int count);
+    void gather_avx512(gr_complex *out, const gr_complex *in, const int *index, int count);
+#endif
+
+    //! Fill list with the variants this CPU can run, generic first, and return the count.
+    int mapper_kernels(mapper_impl *list);
+    int gather_kernels(gather_impl *list);
+
+    //! The fastest variants this CPU can run, see kernel_choose().
+    mapper_kernel_t mapper_select(void);
+    gather_kernel_t gather_select(void);
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_CELL_KERNELS_H */
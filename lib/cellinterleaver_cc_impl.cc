@@ -24,7 +24,9 @@
 
 #include <gnuradio/io_signature.h>
 #include "cellinterleaver_cc_impl.h"
+#include "trace_buffer.h"
 #include <stdio.h>
+#include <new>
 
 namespace gr {
   namespace dvbt2 {
@@ -171,6 +173,10 @@ namespace gr {
                 permutations[q++] = lfsr;
             }
         }
+        for (int w = 0; w < cell_size; w++)
+        {
+            inverse[permutations[w]] = w;
+        }
         if (tiblocks == 0)
         {
             FECBlocksPerSmallTIBlock = 1;
@@ -188,18 +194,20 @@ namespace gr {
         time_interleave = (gr_complex *) malloc(sizeof(gr_complex) * cell_size * fecblocks);
         if (time_interleave == NULL) {
             fprintf(stderr, "Cell interleaver 1st malloc, Out of memory.\n");
-            exit(1);
+            throw std::bad_alloc();
         }
-        cols = (gr_complex **) malloc(sizeof(gr_complex *) * FECBlocksPerBigTIBlock * 5);
-        if (cols == NULL) {
+        col_index = (int *) malloc(sizeof(int) * FECBlocksPerBigTIBlock * 5);
+        if (col_index == NULL) {
             free(time_interleave);
             fprintf(stderr, "Cell interleaver 2nd malloc, Out of memory.\n");
-            exit(1);
+            throw std::bad_alloc();
         }
         ti_blocks = tiblocks;
         fec_blocks = fecblocks;
         set_output_multiple(cell_size * fecblocks);
         interleaved_items = cell_size * fecblocks;
+        gather = gather_select();
+        perf_attach(this);
     }
 
     /*
@@ -207,7 +215,7 @@ namespace gr {
      */
     cellinterleaver_cc_impl::~cellinterleaver_cc_impl()
     {
-        free(cols);
+        free(col_index);
         free(time_interleave);
     }
 
@@ -219,12 +227,16 @@ namespace gr {
         const gr_complex *in = (const gr_complex *) input_items[0];
         gr_complex *out = (gr_complex *) output_items[0];
         int FECBlocksPerTIBlock, n, shift, temp, index, rows, numCols, ti_index;
+        gr::high_res_timer_type start;
+
+        perf_begin();
 
         for (int i = 0; i < noutput_items; i += interleaved_items)
         {
             index = 0;
             for (int s = 0; s < numSmallTIBlocks + numBigTIBlocks; s++)
             {
+                start = trace_now();
                 n = 0;
                 if (s < numSmallTIBlocks)
                 {
@@ -249,18 +261,21 @@ namespace gr {
                         }
                         n++;
                     }
-                    for (int w = 0; w < cell_size; w++)
-                    {
-                        time_interleave[((permutations[w] + shift) % cell_size) + index] = *in++;
-                    }
+                    // Cell w goes to (permutations[w] + shift) % cell_size,
+                    // read back through the inverse in two runs.
+                    gather(&time_interleave[index + shift], in, &inverse[0], cell_size - shift);
+                    gather(&time_interleave[index], in, &inverse[cell_size - shift], shift);
+                    in += cell_size;
                     index += cell_size;
                 }
+                trace_span("cell_interleave", TRACE_TIBLOCK, s, start);
             }
             if (ti_blocks != 0)
             {
                 ti_index = 0;
                 for (int s = 0; s < numSmallTIBlocks + numBigTIBlocks; s++)
                 {
+                    start = trace_now();
                     if (s < numSmallTIBlocks)
                     {
                         FECBlocksPerTIBlock = FECBlocksPerSmallTIBlock;
@@ -273,18 +288,15 @@ namespace gr {
                     rows = cell_size / 5;
                     for (int j = 0; j < numCols; j++)
                     {
-                        cols[j] = &time_interleave[(rows * j) + ti_index];
+                        col_index[j] = rows * j;
                     }
-                    index = 0;
                     for (int k = 0; k < rows; k++)
                     {
-                        for (int w = 0; w < numCols; w++)
-                        {
-                            *out++ = *(cols[w] + index);
-                        }
-                        index++;
+                        gather(out, &time_interleave[ti_index + k], col_index, numCols);
+                        out += numCols;
                     }
                     ti_index += rows * numCols;
+                    trace_span("time_interleave", TRACE_TIBLOCK, s, start);
                 }
             }
             else
@@ -297,6 +309,8 @@ namespace gr {
             }
         }
 
+        perf_end(noutput_items);
+
         // Tell runtime system how many output items we produced.
         return noutput_items;
     }
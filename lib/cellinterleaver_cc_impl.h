@@ -22,6 +22,7 @@
 #define INCLUDED_DVBT2_CELLINTERLEAVER_CC_IMPL_H
 
 #include <dvbt2/cellinterleaver_cc.h>
+#include "cell_kernels.h"
 
 namespace gr {
   namespace dvbt2 {
@@ -34,13 +35,15 @@ namespace gr {
       int ti_blocks;
       int fec_blocks;
       int permutations[32768];
+      int inverse[32768];
       int FECBlocksPerSmallTIBlock;
       int FECBlocksPerBigTIBlock;
       int numBigTIBlocks;
       int numSmallTIBlocks;
       int interleaved_items;
       gr_complex *time_interleave;
-      gr_complex **cols;
+      int *col_index;
+      gather_kernel_t gather;
 
      public:
       cellinterleaver_cc_impl(dvbt2_framesize_t framesize, dvbt2_constellation_t constellation, int fecblocks, int tiblocks);
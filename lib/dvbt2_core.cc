@@ -0,0 +1,143 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dvbt2/dvbt2_core.h>
+#include <dvbt2/t2_encoder.h>
+#include <dvbt2/t2_geometry.h>
+#include <new>
+
+using gr::dvbt2::t2_params;
+using gr::dvbt2::t2_encoder;
+using gr::dvbt2::t2_capacity;
+
+struct dvbt2_core_params
+{
+    t2_params params;
+};
+
+struct dvbt2_core_encoder
+{
+    t2_encoder *encoder;
+};
+
+dvbt2_core_params *
+dvbt2_core_params_new(void)
+{
+    return new (std::nothrow) dvbt2_core_params;
+}
+
+void
+dvbt2_core_params_free(dvbt2_core_params *params)
+{
+    delete params;
+}
+
+int
+dvbt2_core_params_set(dvbt2_core_params *params, const char *key, const char *value)
+{
+    return params->params.set(key, value) ? 0 : -1;
+}
+
+double
+dvbt2_core_sample_rate(const dvbt2_core_params *params)
+{
+    return params->params.sample_rate();
+}
+
+dvbt2_core_encoder *
+dvbt2_core_encoder_new(const dvbt2_core_params *params, int engine, int depth, const int *cores, int ncores)
+{
+    dvbt2_core_encoder *encoder;
+
+    // The blocks take the parameters as they come, check them first.
+    if (t2_capacity(params->params).check(params->params) != NULL)
+    {
+        return NULL;
+    }
+    encoder = new (std::nothrow) dvbt2_core_encoder;
+    if (encoder == NULL)
+    {
+        return NULL;
+    }
+    try
+    {
+        std::vector<int> core_list(cores, cores + (cores != NULL ? ncores : 0));
+        encoder->encoder = new t2_encoder(params->params, (dvbt2_engine_t) engine, depth, core_list);
+    }
+    catch (...)
+    {
+        delete encoder;
+        return NULL;
+    }
+    return encoder;
+}
+
+void
+dvbt2_core_encoder_free(dvbt2_core_encoder *encoder)
+{
+    if (encoder != NULL)
+    {
+        delete encoder->encoder;
+        delete encoder;
+    }
+}
+
+int
+dvbt2_core_input_bytes(const dvbt2_core_encoder *encoder)
+{
+    return encoder->encoder->input_items();
+}
+
+int
+dvbt2_core_output_samples(const dvbt2_core_encoder *encoder)
+{
+    return encoder->encoder->output_items();
+}
+
+int
+dvbt2_core_encode(dvbt2_core_encoder *encoder, const unsigned char *in, float *out)
+{
+    return encoder->encoder->encode(in, (gr_complex *) out);
+}
+
+int
+dvbt2_core_push(dvbt2_core_encoder *encoder, const unsigned char *in)
+{
+    return encoder->encoder->push(in);
+}
+
+int
+dvbt2_core_pop(dvbt2_core_encoder *encoder, float *out)
+{
+    return encoder->encoder->pop((gr_complex *) out) ? 0 : -1;
+}
+
+int
+dvbt2_core_frames(const dvbt2_core_encoder *encoder)
+{
+    return encoder->encoder->frames();
+}
+
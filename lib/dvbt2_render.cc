@@ -0,0 +1,396 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+/*
+ * dvbt2-render: renders a transport stream file to baseband IQ with
+ * the gateway chain, without GNU Radio's scheduler. The input is
+ * memory mapped, whole T2 frames are encoded by the parallel engine
+ * on all CPUs, and the output goes through the output conditioner.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+#include <boost/thread/thread.hpp>
+#include <volk/volk.h>
+#include <dvbt2/t2_params.h>
+#include <dvbt2/t2_encoder.h>
+#include <dvbt2/t2_geometry.h>
+#include <dvbt2/tracer.h>
+#include <dvbt2/outputconditioner_c.h>
+
+using namespace gr::dvbt2;
+
+static void
+usage(void)
+{
+    fprintf(stderr, "Usage: dvbt2-render [options] input.ts output\n");
+    fprintf(stderr, "Output options:\n");
+    fprintf(stderr, "  --format cf32|sc16|sc8   sample format (cf32)\n");
+    fprintf(stderr, "  --sigmf                  write output.sigmf-data and output.sigmf-meta\n");
+    fprintf(stderr, "  --gain g                 output gain, 1.0 is full scale for sc16/sc8 (1.0)\n");
+    fprintf(stderr, "  --clip level             hard clip I and Q at +/- level\n");
+    fprintf(stderr, "  --workers n              encoding threads (one per CPU)\n");
+    fprintf(stderr, "  --depth n                frames in flight per thread (2)\n");
+    fprintf(stderr, "  --trace file.json        write a Chrome trace of the last frames\n");
+    fprintf(stderr, "Planning options:\n");
+    fprintf(stderr, "  --fill ms                fecblocks, numdatasyms and tiblocks for the highest\n");
+    fprintf(stderr, "                           bit rate with T2 frames of at most ms\n");
+    fprintf(stderr, "  --plan                   print what the configuration carries and costs,\n");
+    fprintf(stderr, "                           without rendering\n");
+    fprintf(stderr, "Modulator options, as in the block constructors:\n");
+    t2_params::usage(stderr);
+    exit(1);
+}
+
+static double
+now(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static void
+write_sigmf_meta(const std::string &path, const char *datatype, double sample_rate, int frames, int frame_items, int t2frames)
+{
+    FILE *fp = fopen(path.c_str(), "w");
+
+    if (fp == NULL)
+    {
+        perror(path.c_str());
+        exit(1);
+    }
+    fprintf(fp, "{\n");
+    fprintf(fp, "    \"global\": {\n");
+    fprintf(fp, "        \"core:datatype\": \"%s\",\n", datatype);
+    fprintf(fp, "        \"core:sample_rate\": %.6f,\n", sample_rate);
+    fprintf(fp, "        \"core:version\": \"1.0.0\",\n");
+    fprintf(fp, "        \"core:num_channels\": 1,\n");
+    fprintf(fp, "        \"core:recorder\": \"dvbt2-render\",\n");
+    fprintf(fp, "        \"core:description\": \"DVB-T2 baseband, one annotation per T2 frame\"\n");
+    fprintf(fp, "    },\n");
+    fprintf(fp, "    \"captures\": [\n");
+    fprintf(fp, "        {\n");
+    fprintf(fp, "            \"core:sample_start\": 0\n");
+    fprintf(fp, "        }\n");
+    fprintf(fp, "    ],\n");
+    fprintf(fp, "    \"annotations\": [");
+    for (int i = 0; i < frames; i++)
+    {
+        fprintf(fp, "%s\n        {\n", i ? "," : "");
+        fprintf(fp, "            \"core:sample_start\": %lld,\n", (long long) i * frame_items);
+        fprintf(fp, "            \"core:sample_count\": %d,\n", frame_items);
+        fprintf(fp, "            \"core:label\": \"T2 frame %d\",\n", i % t2frames);
+        fprintf(fp, "            \"core:comment\": \"super-frame %d\"\n", i / t2frames);
+        fprintf(fp, "        }");
+    }
+    fprintf(fp, "\n    ]\n");
+    fprintf(fp, "}\n");
+    fclose(fp);
+}
+
+static void
+print_plan(const t2_params &params, const t2_capacity &capacity)
+{
+    printf("fecblocks %d, tiblocks %d, numdatasyms %d\n", params.fecblocks, params.tiblocks, params.numdatasyms);
+    printf("T2 frame: %d symbols, %d cells, %d samples, %.3f ms\n", capacity.frame_symbols, capacity.frame_cells, capacity.frame_samples, capacity.frame_seconds * 1e3);
+    printf("room for %d FEC blocks, largest TI block %d cells\n", capacity.fec_capacity, capacity.ti_cells);
+    printf("bit rate %.3f bit/s (tsrate %.0f), %.6f Msps\n", capacity.bitrate, capacity.bitrate, capacity.sample_rate / 1e6);
+    printf("%.2f FEC frames/s, %.2f OFDM symbols/s, %.0f cells/s\n", capacity.fecframes_per_second, capacity.symbols_per_second, capacity.cells_per_second);
+    printf("%.1f MB of frame buffers per chain\n", capacity.memory_bytes / 1048576.0);
+}
+
+int
+main(int argc, char **argv)
+{
+    t2_params params;
+    dvbt2_outputformat_t format = OUTPUT_FC32;
+    bool sigmf = false;
+    float gain = 1.0;
+    dvbt2_clipping_t clipping = CLIPPING_OFF;
+    float cliplevel = 1.0;
+    int num_workers = boost::thread::hardware_concurrency();
+    int depth = 2;
+    const char *trace = NULL;
+    double fill_ms = 0.0;
+    bool plan = false;
+    std::vector<const char *> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string key;
+        const char *value;
+        const char *equals;
+
+        if (strncmp(argv[i], "--", 2) != 0)
+        {
+            files.push_back(argv[i]);
+            continue;
+        }
+        equals = strchr(argv[i], '=');
+        if (equals != NULL)
+        {
+            key.assign(argv[i] + 2, equals - argv[i] - 2);
+            value = equals + 1;
+        }
+        else
+        {
+            key = argv[i] + 2;
+            if (key == "sigmf")
+            {
+                sigmf = true;
+                continue;
+            }
+            if (key == "plan")
+            {
+                plan = true;
+                continue;
+            }
+            if (key == "help" || i + 1 == argc)
+            {
+                usage();
+            }
+            value = argv[++i];
+        }
+        if (key == "format")
+        {
+            if (strcmp(value, "cf32") == 0)
+            {
+                format = OUTPUT_FC32;
+            }
+            else if (strcmp(value, "sc16") == 0)
+            {
+                format = OUTPUT_SC16;
+            }
+            else if (strcmp(value, "sc8") == 0)
+            {
+                format = OUTPUT_SC8;
+            }
+            else
+            {
+                usage();
+            }
+        }
+        else if (key == "gain")
+        {
+            gain = atof(value);
+        }
+        else if (key == "clip")
+        {
+            clipping = CLIPPING_ON;
+            cliplevel = atof(value);
+        }
+        else if (key == "workers")
+        {
+            num_workers = atoi(value);
+        }
+        else if (key == "depth")
+        {
+            depth = atoi(value);
+        }
+        else if (key == "trace")
+        {
+            trace = value;
+        }
+        else if (key == "fill")
+        {
+            fill_ms = atof(value);
+        }
+        else if (!params.set(key.c_str(), value))
+        {
+            fprintf(stderr, "Bad option --%s %s\n", key.c_str(), value);
+            usage();
+        }
+    }
+    if (fill_ms > 0.0 && t2_geometry::allowed(params.carriermode, params.fftsize, params.guardinterval, params.pilotpattern))
+    {
+        t2_constraints constraints;
+        constraints.max_frame_ms = fill_ms;
+        if (!t2_capacity::solve(params, constraints))
+        {
+            fprintf(stderr, "No T2 frame of at most %g ms fits.\n", fill_ms);
+            return 1;
+        }
+    }
+    t2_capacity capacity(params);
+    const char *problem = capacity.check(params);
+    if (plan)
+    {
+        print_plan(params, capacity);
+        if (problem != NULL)
+        {
+            printf("invalid: %s\n", problem);
+            return 1;
+        }
+        return 0;
+    }
+    if (problem != NULL)
+    {
+        fprintf(stderr, "Invalid configuration: %s\n", problem);
+        return 1;
+    }
+    if (files.size() != 2)
+    {
+        usage();
+    }
+    if (num_workers < 1)
+    {
+        num_workers = 1;
+    }
+
+    int fd = open(files[0], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+    {
+        perror(files[0]);
+        return 1;
+    }
+    size_t size = st.st_size;
+    const unsigned char *in = NULL;
+    if (size > 0)
+    {
+        in = (const unsigned char *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (in == MAP_FAILED)
+        {
+            perror(files[0]);
+            return 1;
+        }
+        madvise((void *) in, size, MADV_SEQUENTIAL);
+    }
+
+    std::string data_path = files[1];
+    std::string meta_path;
+    if (sigmf)
+    {
+        meta_path = data_path + ".sigmf-meta";
+        data_path += ".sigmf-data";
+    }
+    FILE *out = data_path == "-" ? stdout : fopen(data_path.c_str(), "wb");
+    if (out == NULL)
+    {
+        perror(data_path.c_str());
+        return 1;
+    }
+
+    t2_encoder *encoder;
+    if (num_workers > 1)
+    {
+        encoder = new t2_encoder(params, ENGINE_PARALLEL, depth, std::vector<int>(num_workers, -1));
+    }
+    else
+    {
+        encoder = new t2_encoder(params);
+    }
+    outputconditioner_c::sptr conditioner = outputconditioner_c::make(gain, clipping, cliplevel, format);
+    int item_size = conditioner->output_signature()->sizeof_stream_item(0);
+    size_t frame_input_items = encoder->input_items();
+    int frame_items = encoder->output_items();
+    gr_complex *frame = (gr_complex*) volk_malloc(sizeof(gr_complex) * frame_items, volk_get_alignment());
+    void *samples = volk_malloc(item_size * frame_items, volk_get_alignment());
+    if (frame == NULL || samples == NULL)
+    {
+        fprintf(stderr, "Render volk_malloc, Out of memory.\n");
+        exit(1);
+    }
+    gr_vector_const_void_star conditioner_in(1, frame);
+    gr_vector_void_star conditioner_out(1, samples);
+
+    size_t consumed = 0;
+    int frames = 0;
+    int used;
+    if (trace != NULL)
+    {
+        tracer::start();
+    }
+    double start = now();
+    for (;;)
+    {
+        while (size - consumed >= frame_input_items && (used = encoder->push(&in[consumed])) >= 0)
+        {
+            consumed += used;
+        }
+        if (!encoder->pop(frame))
+        {
+            break;
+        }
+        conditioner->work(frame_items, conditioner_in, conditioner_out);
+        if (fwrite(samples, item_size, frame_items, out) != (size_t) frame_items)
+        {
+            perror(data_path.c_str());
+            return 1;
+        }
+        frames++;
+    }
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    double elapsed = now() - start;
+    if (trace != NULL)
+    {
+        tracer::stop();
+        if (!tracer::write(trace))
+        {
+            perror(trace);
+            return 1;
+        }
+    }
+
+    if (sigmf)
+    {
+        const char *datatype = format == OUTPUT_SC16 ? "ci16_le" : format == OUTPUT_SC8 ? "ci8" : "cf32_le";
+        write_sigmf_meta(meta_path, datatype, params.sample_rate(), frames, frame_items, params.t2frames);
+    }
+
+    double samples_out = (double) frames * frame_items;
+    fprintf(stderr, "%d T2 frames, %zu of %zu bytes in, %.0f samples out in %.2f s\n", frames, consumed, size, samples_out, elapsed);
+    if (elapsed > 0.0)
+    {
+        fprintf(stderr, "%.2f Mbit/s in, %.2f Msps out, %.2fx real time\n", consumed * 8.0 / elapsed / 1e6, samples_out / elapsed / 1e6, samples_out / elapsed / params.sample_rate());
+    }
+    if (conditioner->clipped_samples())
+    {
+        fprintf(stderr, "%llu of %llu components clipped\n", (unsigned long long) conditioner->clipped_samples(), (unsigned long long) conditioner->total_samples());
+    }
+
+    delete encoder;
+    volk_free(samples);
+    volk_free(frame);
+    if (size > 0)
+    {
+        munmap((void *) in, size);
+    }
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,534 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "fec_kernels.h"
+#include <string.h>
+#ifdef DVBT2_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace gr {
+  namespace dvbt2 {
+
+static inline void bch_shift(uint64_t *s)
+{
+    s[0] = (s[0] >> 1) | (s[1] << 63);
+    s[1] = (s[1] >> 1) | (s[2] << 63);
+    s[2] = (s[2] >> 1) | (s[3] << 63);
+    s[3] = s[3] >> 1;
+}
+
+static void bch_serial(uint64_t *s, const unsigned char *bits, int count, const uint64_t *poly)
+{
+    int b;
+
+    for (int j = 0; j < count; j++)
+    {
+        b = (bits[j] != 0) ^ (int)(s[0] & 1);
+        bch_shift(s);
+        if (b)
+        {
+            s[0] ^= poly[0];
+            s[1] ^= poly[1];
+            s[2] ^= poly[2];
+            s[3] ^= poly[3];
+        }
+    }
+}
+
+static void bch_output(unsigned char *parity, uint64_t *s, int width)
+{
+    for (int n = 0; n < width; n++)
+    {
+        parity[n] = s[0] & 1;
+        bch_shift(s);
+    }
+}
+
+void bch_table_init(bch_table *table, const uint64_t *poly, int width)
+{
+    const unsigned char zeros[32] = {0};
+    uint64_t s[4];
+
+    table->width = width;
+    memcpy(table->poly, poly, sizeof(table->poly));
+    for (int k = 0; k < 4; k++)
+    {
+        for (int x = 0; x < 256; x++)
+        {
+            s[0] = (uint64_t)x << (8 * k);
+            s[1] = s[2] = s[3] = 0;
+            bch_serial(s, zeros, 32, poly);
+            memcpy(table->slice[k][x], s, sizeof(s));
+        }
+    }
+}
+
+void bch_generic(unsigned char *parity, const unsigned char *bits, int kbch, const bch_table *table)
+{
+    uint64_t s[4] = {0, 0, 0, 0};
+
+    bch_serial(s, bits, kbch, table->poly);
+    bch_output(parity, s, table->width);
+}
+
+static void ldpc_rows_to_parity(unsigned char *parity, const unsigned char *rows, int q)
+{
+    unsigned char sum = 0;
+    int j = 0;
+
+    for (int c = 0; c < 360; c++)
+    {
+        for (int r = 0; r < q; r++)
+        {
+            sum ^= rows[(r * 360) + c];
+            parity[j++] = sum;
+        }
+    }
+}
+
+typedef void (*xor_bytes_t)(unsigned char *dst, const unsigned char *src, int n);
+
+static void ldpc_rows(unsigned char *parity, const unsigned char *info, const ldpc_table *table, xor_bytes_t xor_bytes)
+{
+    const int q = table->q;
+    unsigned char rows[360 * LDPC_MAX_Q];
+    unsigned char *row;
+    int column;
+
+    memset(rows, 0, 360 * q);
+    for (int g = 0; g < table->groups; g++)
+    {
+        for (int e = table->first[g]; e < table->first[g + 1]; e++)
+        {
+            row = &rows[(table->address[e] % q) * 360];
+            column = table->address[e] / q;
+            xor_bytes(&row[column], info, 360 - column);
+            xor_bytes(&row[0], &info[360 - column], column);
+        }
+        info += 360;
+    }
+    ldpc_rows_to_parity(parity, rows, q);
+}
+
+void ldpc_generic(unsigned char *parity, const unsigned char *info, const ldpc_table *table)
+{
+    const int q = table->q;
+    const int pbits = 360 * q;
+    int a;
+
+    memset(parity, 0, pbits);
+    for (int g = 0; g < table->groups; g++)
+    {
+        for (int e = table->first[g]; e < table->first[g + 1]; e++)
+        {
+            a = table->address[e];
+            for (int n = 0; n < 360; n++)
+            {
+                parity[a] ^= info[n];
+                a += q;
+                if (a >= pbits)
+                {
+                    a -= pbits;
+                }
+            }
+        }
+        info += 360;
+    }
+    for (int j = 1; j < pbits; j++)
+    {
+        parity[j] ^= parity[j - 1];
+    }
+}
+
+int interleave_table_size(int cells, int mod)
+{
+    return ((cells + 15) / 16) * 16 * mod;
+}
+
+void interleave_table(int *table, const int *perm, int cells, int mod, int frame_bits)
+{
+    int cell, position, base;
+
+    for (int g = 0; g < (cells + 15) / 16; g++)
+    {
+        for (int b = 0; b < mod; b++)
+        {
+            for (int l = 0; l < 16; l++)
+            {
+                cell = (g * 16) + l;
+                position = cell < cells ? perm[(cell * mod) + b] : 0;
+                base = position < frame_bits - 4 ? position : frame_bits - 4;
+                *table++ = base | ((position - base) << 24);
+            }
+        }
+    }
+}
+
+void interleave_generic(unsigned char *cells, const unsigned char *bits, const int *table, int count, int mod)
+{
+    const int *t;
+    unsigned int cell;
+
+    for (int c = 0; c < count; c++)
+    {
+        t = &table[((c / 16) * 16 * mod) + (c % 16)];
+        cell = 0;
+        for (int b = 0; b < mod; b++)
+        {
+            cell = (cell << 1) | (bits[(t[b * 16] & 0xffffff) + (t[b * 16] >> 24)] & 1);
+        }
+        cells[c] = cell;
+    }
+}
+
+#ifdef DVBT2_KERNELS_X86
+__attribute__((target("sse2")))
+void bch_sse2(unsigned char *parity, const unsigned char *bits, int kbch, const bch_table *table)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = zero, hi = zero;
+    const uint64_t *t;
+    uint64_t s[4];
+    unsigned int v, x;
+    int j;
+
+    for (j = 0; j + 32 <= kbch; j += 32)
+    {
+        v = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)&bits[j]), zero));
+        v |= (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)&bits[j + 16]), zero)) << 16;
+        x = (unsigned int)_mm_cvtsi128_si32(lo) ^ ~v;
+        lo = _mm_or_si128(_mm_srli_si128(lo, 4), _mm_slli_si128(hi, 12));
+        hi = _mm_srli_si128(hi, 4);
+        for (int k = 0; k < 4; k++)
+        {
+            t = table->slice[k][(x >> (8 * k)) & 0xff];
+            lo = _mm_xor_si128(lo, _mm_loadu_si128((const __m128i *)&t[0]));
+            hi = _mm_xor_si128(hi, _mm_loadu_si128((const __m128i *)&t[2]));
+        }
+    }
+    _mm_storeu_si128((__m128i *)&s[0], lo);
+    _mm_storeu_si128((__m128i *)&s[2], hi);
+    bch_serial(s, &bits[j], kbch - j, table->poly);
+    bch_output(parity, s, table->width);
+}
+
+// The 256 bit register shifted right by 32 bits, XOR the four entries.
+__attribute__((target("avx2")))
+static inline __m256i bch_step_avx2(__m256i s, unsigned int x, const bch_table *table)
+{
+    const __m256i down = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+
+    s = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(s, down), _mm256_setzero_si256(), 0x80);
+    s = _mm256_xor_si256(s, _mm256_loadu_si256((const __m256i *)table->slice[0][x & 0xff]));
+    s = _mm256_xor_si256(s, _mm256_loadu_si256((const __m256i *)table->slice[1][(x >> 8) & 0xff]));
+    s = _mm256_xor_si256(s, _mm256_loadu_si256((const __m256i *)table->slice[2][(x >> 16) & 0xff]));
+    s = _mm256_xor_si256(s, _mm256_loadu_si256((const __m256i *)table->slice[3][x >> 24]));
+    return s;
+}
+
+__attribute__((target("avx2")))
+void bch_avx2(unsigned char *parity, const unsigned char *bits, int kbch, const bch_table *table)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i s = zero;
+    uint64_t r[4];
+    unsigned int v;
+    int j;
+
+    for (j = 0; j + 32 <= kbch; j += 32)
+    {
+        v = ~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)&bits[j]), zero));
+        s = bch_step_avx2(s, (unsigned int)_mm_cvtsi128_si32(_mm256_castsi256_si128(s)) ^ v, table);
+    }
+    _mm256_storeu_si256((__m256i *)r, s);
+    bch_serial(r, &bits[j], kbch - j, table->poly);
+    bch_output(parity, r, table->width);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void bch_avx512(unsigned char *parity, const unsigned char *bits, int kbch, const bch_table *table)
+{
+    __m256i s = _mm256_setzero_si256();
+    __m512i x;
+    uint64_t r[4];
+    uint64_t v;
+    int j;
+
+    for (j = 0; j + 64 <= kbch; j += 64)
+    {
+        x = _mm512_loadu_si512((const void *)&bits[j]);
+        v = _mm512_test_epi8_mask(x, x);
+        s = bch_step_avx2(s, (unsigned int)_mm_cvtsi128_si32(_mm256_castsi256_si128(s)) ^ (unsigned int)v, table);
+        s = bch_step_avx2(s, (unsigned int)_mm_cvtsi128_si32(_mm256_castsi256_si128(s)) ^ (unsigned int)(v >> 32), table);
+    }
+    _mm256_storeu_si256((__m256i *)r, s);
+    bch_serial(r, &bits[j], kbch - j, table->poly);
+    bch_output(parity, r, table->width);
+}
+
+__attribute__((target("sse2")))
+static void xor_bytes_sse2(unsigned char *dst, const unsigned char *src, int n)
+{
+    int i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_xor_si128(_mm_loadu_si128((const __m128i *)&dst[i]), _mm_loadu_si128((const __m128i *)&src[i])));
+    }
+    for (; i < n; i++)
+    {
+        dst[i] ^= src[i];
+    }
+}
+
+__attribute__((target("avx2")))
+static void xor_bytes_avx2(unsigned char *dst, const unsigned char *src, int n)
+{
+    int i;
+
+    for (i = 0; i + 32 <= n; i += 32)
+    {
+        _mm256_storeu_si256((__m256i *)&dst[i], _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)&dst[i]), _mm256_loadu_si256((const __m256i *)&src[i])));
+    }
+    if (i + 16 <= n)
+    {
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_xor_si128(_mm_loadu_si128((const __m128i *)&dst[i]), _mm_loadu_si128((const __m128i *)&src[i])));
+        i += 16;
+    }
+    for (; i < n; i++)
+    {
+        dst[i] ^= src[i];
+    }
+}
+
+// The tail as one masked operation instead of a byte loop.
+__attribute__((target("avx512f,avx512bw")))
+static void xor_bytes_avx512(unsigned char *dst, const unsigned char *src, int n)
+{
+    __mmask64 tail;
+    int i;
+
+    for (i = 0; i + 64 <= n; i += 64)
+    {
+        _mm512_storeu_si512((void *)&dst[i], _mm512_xor_si512(_mm512_loadu_si512((const void *)&dst[i]), _mm512_loadu_si512((const void *)&src[i])));
+    }
+    if (i < n)
+    {
+        tail = ~0ULL >> (64 - (n - i));
+        _mm512_mask_storeu_epi8(&dst[i], tail, _mm512_xor_si512(_mm512_maskz_loadu_epi8(tail, &dst[i]), _mm512_maskz_loadu_epi8(tail, &src[i])));
+    }
+}
+
+void ldpc_sse2(unsigned char *parity, const unsigned char *info, const ldpc_table *table)
+{
+    ldpc_rows(parity, info, table, xor_bytes_sse2);
+}
+
+void ldpc_avx2(unsigned char *parity, const unsigned char *info, const ldpc_table *table)
+{
+    ldpc_rows(parity, info, table, xor_bytes_avx2);
+}
+
+void ldpc_avx512(unsigned char *parity, const unsigned char *info, const ldpc_table *table)
+{
+    ldpc_rows(parity, info, table, xor_bytes_avx512);
+}
+
+// Sixteen cells at a time, each bit gathered for all of them and
+// shifted in. The gathers read 32 bits, the byte offset selects the bit.
+__attribute__((target("avx2")))
+void interleave_avx2(unsigned char *cells, const unsigned char *bits, const int *table, int count, int mod)
+{
+    const __m256i low = _mm256_set1_epi32(0xffffff);
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i e0, e1, g0, g1, a0, a1;
+    __m128i packed;
+    const int *t;
+    int c;
+
+    for (c = 0; c + 16 <= count; c += 16)
+    {
+        t = &table[c * mod];
+        a0 = _mm256_setzero_si256();
+        a1 = _mm256_setzero_si256();
+        for (int b = 0; b < mod; b++)
+        {
+            e0 = _mm256_loadu_si256((const __m256i *)&t[b * 16]);
+            e1 = _mm256_loadu_si256((const __m256i *)&t[(b * 16) + 8]);
+            g0 = _mm256_i32gather_epi32((const int *)bits, _mm256_and_si256(e0, low), 1);
+            g1 = _mm256_i32gather_epi32((const int *)bits, _mm256_and_si256(e1, low), 1);
+            g0 = _mm256_srlv_epi32(g0, _mm256_slli_epi32(_mm256_srli_epi32(e0, 24), 3));
+            g1 = _mm256_srlv_epi32(g1, _mm256_slli_epi32(_mm256_srli_epi32(e1, 24), 3));
+            a0 = _mm256_or_si256(_mm256_slli_epi32(a0, 1), _mm256_and_si256(g0, one));
+            a1 = _mm256_or_si256(_mm256_slli_epi32(a1, 1), _mm256_and_si256(g1, one));
+        }
+        a0 = _mm256_permute4x64_epi64(_mm256_packus_epi32(a0, a1), _MM_SHUFFLE(3, 1, 2, 0));
+        packed = _mm_packus_epi16(_mm256_castsi256_si128(a0), _mm256_extracti128_si256(a0, 1));
+        _mm_storeu_si128((__m128i *)&cells[c], packed);
+    }
+    interleave_generic(&cells[c], bits, &table[c * mod], count - c, mod);
+}
+
+__attribute__((target("avx512f")))
+void interleave_avx512(unsigned char *cells, const unsigned char *bits, const int *table, int count, int mod)
+{
+    const __m512i low = _mm512_set1_epi32(0xffffff);
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i zero = _mm512_setzero_si512();
+    const __mmask16 all = 0xffff;
+    __m512i e, g, a;
+    const int *t;
+    int c;
+
+    for (c = 0; c + 16 <= count; c += 16)
+    {
+        t = &table[c * mod];
+        a = _mm512_setzero_si512();
+        for (int b = 0; b < mod; b++)
+        {
+            e = _mm512_loadu_si512((const void *)&t[b * 16]);
+            // The masked forms with a zero source, the plain ones
+            // start from an undefined register, which GCC warns about.
+            g = _mm512_mask_i32gather_epi32(zero, all, _mm512_and_si512(e, low), (const void *)bits, 1);
+            g = _mm512_maskz_srlv_epi32(all, g, _mm512_maskz_slli_epi32(all, _mm512_maskz_srli_epi32(all, e, 24), 3));
+            a = _mm512_or_si512(_mm512_add_epi32(a, a), _mm512_and_si512(g, one));
+        }
+        _mm_storeu_si128((__m128i *)&cells[c], _mm512_maskz_cvtepi32_epi8(all, a));
+    }
+    interleave_generic(&cells[c], bits, &table[c * mod], count - c, mod);
+}
+#endif
+
+int bch_kernels(bch_impl *list)
+{
+    int count = 0;
+
+    list[count].name = "generic";
+    list[count].arch = ARCH_GENERIC;
+    list[count++].kernel = bch_generic;
+#ifdef DVBT2_KERNELS_X86
+    if (kernel_arch_supported(ARCH_SSE2))
+    {
+        list[count].name = "sse2";
+        list[count].arch = ARCH_SSE2;
+        list[count++].kernel = bch_sse2;
+    }
+    if (kernel_arch_supported(ARCH_AVX2))
+    {
+        list[count].name = "avx2";
+        list[count].arch = ARCH_AVX2;
+        list[count++].kernel = bch_avx2;
+    }
+    if (kernel_arch_supported(ARCH_AVX512))
+    {
+        list[count].name = "avx512";
+        list[count].arch = ARCH_AVX512;
+        list[count++].kernel = bch_avx512;
+    }
+#endif
+    return count;
+}
+
+int ldpc_kernels(ldpc_impl *list)
+{
+    int count = 0;
+
+    list[count].name = "generic";
+    list[count].arch = ARCH_GENERIC;
+    list[count++].kernel = ldpc_generic;
+#ifdef DVBT2_KERNELS_X86
+    if (kernel_arch_supported(ARCH_SSE2))
+    {
+        list[count].name = "sse2";
+        list[count].arch = ARCH_SSE2;
+        list[count++].kernel = ldpc_sse2;
+    }
+    if (kernel_arch_supported(ARCH_AVX2))
+    {
+        list[count].name = "avx2";
+        list[count].arch = ARCH_AVX2;
+        list[count++].kernel = ldpc_avx2;
+    }
+    if (kernel_arch_supported(ARCH_AVX512))
+    {
+        list[count].name = "avx512";
+        list[count].arch = ARCH_AVX512;
+        list[count++].kernel = ldpc_avx512;
+    }
+#endif
+    return count;
+}
+
+int interleave_kernels(interleave_impl *list)
+{
+    int count = 0;
+
+    list[count].name = "generic";
+    list[count].arch = ARCH_GENERIC;
+    list[count++].kernel = interleave_generic;
+#ifdef DVBT2_KERNELS_X86
+    if (kernel_arch_supported(ARCH_AVX2))
+    {
+        list[count].name = "avx2";
+        list[count].arch = ARCH_AVX2;
+        list[count++].kernel = interleave_avx2;
+    }
+    if (kernel_arch_supported(ARCH_AVX512))
+    {
+        list[count].name = "avx512";
+        list[count].arch = ARCH_AVX512;
+        list[count++].kernel = interleave_avx512;
+    }
+#endif
+    return count;
+}
+
+bch_kernel_t bch_select(void)
+{
+    bch_impl list[MAX_FEC_KERNELS];
+    int count = bch_kernels(list);
+
+    return kernel_choose(list, count).kernel;
+}
+
+ldpc_kernel_t ldpc_select(void)
+{
+    ldpc_impl list[MAX_FEC_KERNELS];
+    int count = ldpc_kernels(list);
+
+    return kernel_choose(list, count).kernel;
+}
+
+interleave_kernel_t interleave_select(void)
+{
+    interleave_impl list[MAX_FEC_KERNELS];
+    int count = interleave_kernels(list);
+
+    return kernel_choose(list, count).kernel;
+}
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
@@ -0,0 +1,146 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_DVBT2_FEC_KERNELS_H
+#define INCLUDED_DVBT2_FEC_KERNELS_H
+
+#include <stdint.h>
+#include "kernel_dispatch.h"
+
+#define MAX_FEC_KERNELS 4
+#define LDPC_MAX_GROUPS 150
+#define LDPC_MAX_ENTRIES 648
+#define LDPC_MAX_Q 90
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * BCH parity of kbch information bits, one bit per byte, MSB of
+     * the codeword first. The shift register is a number of width
+     * bits, bit 0 the next parity bit out: for each input bit it
+     * shifts right by one and takes the generator polynomial when the
+     * bit differs from bit 0. The parity bits are written one per
+     * byte, bit 0 first.
+     *
+     * The vector variants take 32 bits per step: the register shifted
+     * right by 32 and the XOR of four table entries, one per byte of
+     * the low 32 bits of the register XOR the input bits.
+     */
+    struct bch_table
+    {
+      int width;
+      uint64_t poly[4];
+      uint64_t slice[4][256][4];
+    };
+
+    //! poly holds the polynomial without its x^width term, bit b the
+    //! coefficient the register takes at bit b.
+    void bch_table_init(bch_table *table, const uint64_t *poly, int width);
+
+    typedef void (*bch_kernel_t)(unsigned char *parity, const unsigned char *bits, int kbch, const bch_table *table);
+
+    /*
+     * LDPC parity of the information bits, one bit per byte. Each of
+     * the 360 bits of group g adds into the parity accumulators
+     * (address + n * q) % (360 * q) for each address of the group in
+     * Annex A or B of ETSI EN 302 755, then each parity bit is the sum
+     * of all accumulators up to it.
+     *
+     * Written with the parity as q rows of 360, row address % q from
+     * column address / q, each address adds the whole group to one row
+     * rotated, two contiguous XORs. The vector variants do that, in
+     * rows of 360 * q bytes on the stack.
+     */
+    struct ldpc_table
+    {
+      int q;
+      int groups;
+      int first[LDPC_MAX_GROUPS + 1];
+      int address[LDPC_MAX_ENTRIES];
+    };
+
+    typedef void (*ldpc_kernel_t)(unsigned char *parity, const unsigned char *info, const ldpc_table *table);
+
+    /*
+     * Bit interleaving, demultiplexing and packing into cells of mod
+     * bits, as one table of input bit positions. The table holds the
+     * cells in groups of 16, the first bit of all 16 cells, then the
+     * second. Each entry is the position, at most 4 bytes before the
+     * end of the frame, in the low 24 bits and the byte offset from
+     * there above, so that a 32 bit gather never reads past the frame.
+     * interleave_table() builds it from perm, the input bit of each
+     * output bit, MSB of each cell first.
+     */
+    int interleave_table_size(int cells, int mod);
+    void interleave_table(int *table, const int *perm, int cells, int mod, int frame_bits);
+
+    typedef void (*interleave_kernel_t)(unsigned char *cells, const unsigned char *bits, const int *table, int count, int mod);
+
+    struct bch_impl
+    {
+      const char *name;
+      kernel_arch_t arch;
+      bch_kernel_t kernel;
+    };
+
+    struct ldpc_impl
+    {
+      const char *name;
+      kernel_arch_t arch;
+      ldpc_kernel_t kernel;
+    };
+
+    struct interleave_impl
+    {
+      const char *name;
+      kernel_arch_t arch;
+      interleave_kernel_t kernel;
+    };
+
+    void bch_generic(unsigned char *parity, const unsigned char *bits, int kbch, const bch_table *table);
+    void ldpc_generic(unsigned char *parity, const unsigned char *info, const ldpc_table *table);
+    void interleave_generic(unsigned char *cells, const unsigned char *bits, const int *table, int count, int mod);
+#ifdef DVBT2_KERNELS_X86
+    void bch_sse2(unsigned char *parity, const unsigned char *bits, int kbch, const bch_table *table);
+    void bch_avx2(unsigned char *parity, const unsigned char *bits, int kbch, const bch_table *table);
+    void bch_avx512(unsigned char *parity, const unsigned char *bits, int kbch, const bch_table *table);
+    void ldpc_sse2(unsigned char *parity, const unsigned char *info, const ldpc_table *table);
+    void ldpc_avx2(unsigned char *parity, const unsigned char *info, const ldpc_table *table);
+    void ldpc_avx512(unsigned char *parity, const unsigned char *info, const ldpc_table *table);
+    void interleave_avx2(unsigned char *cells, const unsigned char *bits, const int *table, int count, int mod);
+    void interleave_avx512(unsigned char *cells, const unsigned char *bits, const int *table, int count, int mod);
+#endif
+
+    //! Fill list with the variants this CPU can run, generic first, and return the count.
+    int bch_kernels(bch_impl *list);
+    int ldpc_kernels(ldpc_impl *list);
+    int interleave_kernels(interleave_impl *list);
+
+    //! The fastest variants this CPU can run, see kernel_choose().
+    bch_kernel_t bch_select(void);
+    ldpc_kernel_t ldpc_select(void);
+    interleave_kernel_t interleave_select(void);
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_FEC_KERNELS_H */
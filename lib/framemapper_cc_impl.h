@@ -202,6 +202,16 @@ namespace gr {
 		       gr_vector_int &ninput_items,
 		       gr_vector_const_void_star &input_items,
 		       gr_vector_void_star &output_items);
+
+      // general_work() without the scheduler, returns the input
+      // items consumed. Used by gateway_bc.
+      int process(int noutput_items,
+		  gr_vector_const_void_star &input_items,
+		  gr_vector_void_star &output_items);
+
+      // Restarts the T2 frame count at n, for engines that map
+      // frames out of order.
+      void set_frame_number(int n) { t2_frame_num = n % t2_frames; }
     };
 
   } // namespace dvbt2
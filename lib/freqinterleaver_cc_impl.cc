@@ -24,6 +24,7 @@
 
 #include <gnuradio/io_signature.h>
 #include "freqinterleaver_cc_impl.h"
+#include <dvbt2/t2_geometry.h>
 #include <stdio.h>
 
 namespace gr {
@@ -61,72 +62,12 @@ namespace gr {
         int *logic;
         const int *bitpermeven, *bitpermodd;
         int pn_degree, even, odd;
-        if ((preamble == gr::dvbt2::PREAMBLE_T2_SISO) || (preamble == gr::dvbt2::PREAMBLE_T2_LITE_SISO))
-        {
-            switch (fftsize)
-            {
-                case gr::dvbt2::FFTSIZE_1K:
-                    N_P2 = 16;
-                    C_P2 = 558;
-                    break;
-                case gr::dvbt2::FFTSIZE_2K:
-                    N_P2 = 8;
-                    C_P2 = 1118;
-                    break;
-                case gr::dvbt2::FFTSIZE_4K:
-                    N_P2 = 4;
-                    C_P2 = 2236;
-                    break;
-                case gr::dvbt2::FFTSIZE_8K:
-                case gr::dvbt2::FFTSIZE_8K_T2GI:
-                    N_P2 = 2;
-                    C_P2 = 4472;
-                    break;
-                case gr::dvbt2::FFTSIZE_16K:
-                case gr::dvbt2::FFTSIZE_16K_T2GI:
-                    N_P2 = 1;
-                    C_P2 = 8944;
-                    break;
-                case gr::dvbt2::FFTSIZE_32K:
-                case gr::dvbt2::FFTSIZE_32K_T2GI:
-                    N_P2 = 1;
-                    C_P2 = 22432;
-                    break;
-            }
-        }
-        else
-        {
-            switch (fftsize)
-            {
-                case gr::dvbt2::FFTSIZE_1K:
-                    N_P2 = 16;
-                    C_P2 = 546;
-                    break;
-                case gr::dvbt2::FFTSIZE_2K:
-                    N_P2 = 8;
-                    C_P2 = 1098;
-                    break;
-                case gr::dvbt2::FFTSIZE_4K:
-                    N_P2 = 4;
-                    C_P2 = 2198;
-                    break;
-                case gr::dvbt2::FFTSIZE_8K:
-                case gr::dvbt2::FFTSIZE_8K_T2GI:
-                    N_P2 = 2;
-                    C_P2 = 4398;
-                    break;
-                case gr::dvbt2::FFTSIZE_16K:
-                case gr::dvbt2::FFTSIZE_16K_T2GI:
-                    N_P2 = 1;
-                    C_P2 = 8814;
-                    break;
-                case gr::dvbt2::FFTSIZE_32K:
-                case gr::dvbt2::FFTSIZE_32K_T2GI:
-                    N_P2 = 1;
-                    C_P2 = 17612;
-                    break;
-            }
-        }
+        t2_geometry geometry(carriermode, fftsize, pilotpattern, guardinterval, paprmode, preamble);
+        N_P2 = geometry.N_P2;
+        C_P2 = geometry.C_P2;
+        C_DATA = geometry.C_DATA;
+        N_FC = geometry.N_FC;
+        C_FC = geometry.C_FC;
         switch (fftsize)
         {
             case gr::dvbt2::FFTSIZE_1K:
@@ -194,542 +135,6 @@ namespace gr {
                 xor_size = 0;
                 break;
         }
-        switch (fftsize)
-        {
-            case gr::dvbt2::FFTSIZE_1K:
-                switch (pilotpattern)
-                {
-                    case gr::dvbt2::PILOT_PP1:
-                        C_DATA = 764;
-                        N_FC = 568;
-                        C_FC = 402;
-                        break;
-                    case gr::dvbt2::PILOT_PP2:
-                        C_DATA = 768;
-                        N_FC = 710;
-                        C_FC = 654;
-                        break;
-                    case gr::dvbt2::PILOT_PP3:
-                        C_DATA = 798;
-                        N_FC = 710;
-                        C_FC = 490;
-                        break;
-                    case gr::dvbt2::PILOT_PP4:
-                        C_DATA = 804;
-                        N_FC = 780;
-                        C_FC = 707;
-                        break;
-                    case gr::dvbt2::PILOT_PP5:
-                        C_DATA = 818;
-                        N_FC = 780;
-                        C_FC = 544;
-                        break;
-                    case gr::dvbt2::PILOT_PP6:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP7:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP8:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 10;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 10;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 10;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_2K:
-                switch (pilotpattern)
-                {
-                    case gr::dvbt2::PILOT_PP1:
-                        C_DATA = 1522;
-                        N_FC = 1136;
-                        C_FC = 804;
-                        break;
-                    case gr::dvbt2::PILOT_PP2:
-                        C_DATA = 1532;
-                        N_FC = 1420;
-                        C_FC = 1309;
-                        break;
-                    case gr::dvbt2::PILOT_PP3:
-                        C_DATA = 1596;
-                        N_FC = 1420;
-                        C_FC = 980;
-                        break;
-                    case gr::dvbt2::PILOT_PP4:
-                        C_DATA = 1602;
-                        N_FC = 1562;
-                        C_FC = 1415;
-                        break;
-                    case gr::dvbt2::PILOT_PP5:
-                        C_DATA = 1632;
-                        N_FC = 1562;
-                        C_FC = 1088;
-                        break;
-                    case gr::dvbt2::PILOT_PP6:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP7:
-                        C_DATA = 1646;
-                        N_FC = 1632;
-                        C_FC = 1396;
-                        break;
-                    case gr::dvbt2::PILOT_PP8:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 18;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 18;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 18;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_4K:
-                switch (pilotpattern)
-                {
-                    case gr::dvbt2::PILOT_PP1:
-                        C_DATA = 3084;
-                        N_FC = 2272;
-                        C_FC = 1609;
-                        break;
-                    case gr::dvbt2::PILOT_PP2:
-                        C_DATA = 3092;
-                        N_FC = 2840;
-                        C_FC = 2619;
-                        break;
-                    case gr::dvbt2::PILOT_PP3:
-                        C_DATA = 3228;
-                        N_FC = 2840;
-                        C_FC = 1961;
-                        break;
-                    case gr::dvbt2::PILOT_PP4:
-                        C_DATA = 3234;
-                        N_FC = 3124;
-                        C_FC = 2831;
-                        break;
-                    case gr::dvbt2::PILOT_PP5:
-                        C_DATA = 3298;
-                        N_FC = 3124;
-                        C_FC = 2177;
-                        break;
-                    case gr::dvbt2::PILOT_PP6:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP7:
-                        C_DATA = 3328;
-                        N_FC = 3266;
-                        C_FC = 2792;
-                        break;
-                    case gr::dvbt2::PILOT_PP8:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 36;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 36;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 36;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_8K:
-            case gr::dvbt2::FFTSIZE_8K_T2GI:
-                if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 6208;
-                            N_FC = 4544;
-                            C_FC = 3218;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 6214;
-                            N_FC = 5680;
-                            C_FC = 5238;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 6494;
-                            N_FC = 5680;
-                            C_FC = 3922;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 6498;
-                            N_FC = 6248;
-                            C_FC = 5662;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 6634;
-                            N_FC = 6248;
-                            C_FC = 4354;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 6698;
-                            N_FC = 6532;
-                            C_FC = 5585;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 6698;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                else
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 6296;
-                            N_FC = 4608;
-                            C_FC = 3264;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 6298;
-                            N_FC = 5760;
-                            C_FC = 5312;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 6584;
-                            N_FC = 5760;
-                            C_FC = 3978;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 6588;
-                            N_FC = 6336;
-                            C_FC = 5742;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 6728;
-                            N_FC = 6336;
-                            C_FC = 4416;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 6788;
-                            N_FC = 6624;
-                            C_FC = 5664;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 6788;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 72;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 72;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 72;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_16K:
-            case gr::dvbt2::FFTSIZE_16K_T2GI:
-                if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 12418;
-                            N_FC = 9088;
-                            C_FC = 6437;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 12436;
-                            N_FC = 11360;
-                            C_FC = 10476;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 12988;
-                            N_FC = 11360;
-                            C_FC = 7845;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 13002;
-                            N_FC = 12496;
-                            C_FC = 11324;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 13272;
-                            N_FC = 12496;
-                            C_FC = 8709;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 13288;
-                            N_FC = 13064;
-                            C_FC = 11801;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 13416;
-                            N_FC = 13064;
-                            C_FC = 11170;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 13406;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                else
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 12678;
-                            N_FC = 9280;
-                            C_FC = 6573;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 12698;
-                            N_FC = 11600;
-                            C_FC = 10697;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 13262;
-                            N_FC = 11600;
-                            C_FC = 8011;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 13276;
-                            N_FC = 12760;
-                            C_FC = 11563;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 13552;
-                            N_FC = 12760;
-                            C_FC = 8893;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 13568;
-                            N_FC = 13340;
-                            C_FC = 12051;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 13698;
-                            N_FC = 13340;
-                            C_FC = 11406;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 13688;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 144;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 144;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 144;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_32K:
-            case gr::dvbt2::FFTSIZE_32K_T2GI:
-                if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 24886;
-                            N_FC = 22720;
-                            C_FC = 20952;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 26022;
-                            N_FC = 24992;
-                            C_FC = 22649;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 26592;
-                            N_FC = 26128;
-                            C_FC = 23603;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 26836;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 26812;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                else
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 25412;
-                            N_FC = 23200;
-                            C_FC = 21395;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 26572;
-                            N_FC = 25520;
-                            C_FC = 23127;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 27152;
-                            N_FC = 26680;
-                            C_FC = 24102;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 27404;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 27376;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 288;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 288;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 288;
-                    }
-                }
-                break;
-        }
-        if ((preamble == gr::dvbt2::PREAMBLE_T2_SISO) || (preamble == gr::dvbt2::PREAMBLE_T2_LITE_SISO))
-        {
-            if (guardinterval == gr::dvbt2::GI_1_128 && pilotpattern == gr::dvbt2::PILOT_PP7)
-            {
-                N_FC = 0;
-                C_FC = 0;
-            }
-            if (guardinterval == gr::dvbt2::GI_1_32 && pilotpattern == gr::dvbt2::PILOT_PP4)
-            {
-                N_FC = 0;
-                C_FC = 0;
-            }
-            if (guardinterval == gr::dvbt2::GI_1_16 && pilotpattern == gr::dvbt2::PILOT_PP2)
-            {
-                N_FC = 0;
-                C_FC = 0;
-            }
-            if (guardinterval == gr::dvbt2::GI_19_256 && pilotpattern == gr::dvbt2::PILOT_PP2)
-            {
-                N_FC = 0;
-                C_FC = 0;
-            }
-        }
         for (int i = 0; i < max_states; i++)
         {
             if (i == 0 || i == 1)
@@ -809,18 +214,18 @@ namespace gr {
                 HevenFC[a] = j;
             }
         }
+        interleaved_items = geometry.frame_cells(numdatasyms);
+        set_output_multiple(interleaved_items);
         if (N_FC == 0)
         {
-            set_output_multiple((N_P2 * C_P2) + (numdatasyms * C_DATA));
-            interleaved_items = (N_P2 * C_P2) + (numdatasyms * C_DATA);
             num_data_symbols = numdatasyms;
         }
         else
         {
-            set_output_multiple((N_P2 * C_P2) + ((numdatasyms - 1) * C_DATA) + N_FC);
-            interleaved_items = (N_P2 * C_P2) + ((numdatasyms - 1) * C_DATA) + N_FC;
             num_data_symbols = numdatasyms - 1;
         }
+        gather = gather_select();
+        perf_attach(this);
     }
 
     /*
@@ -840,6 +245,8 @@ namespace gr {
         int symbol = 0;
         int *H;
 
+        perf_begin();
+
         for (int i = 0; i < noutput_items; i += interleaved_items)
         {
             for (int j = 0; j < N_P2; j++)
@@ -852,10 +259,8 @@ namespace gr {
                 {
                     H = HoddP2;
                 }
-                for (int j = 0; j < C_P2; j++)
-                {
-                    *out++ = in[H[j]];
-                }
+                gather(out, in, H, C_P2);
+                out += C_P2;
                 symbol++;
                 in += C_P2;
             }
@@ -869,10 +274,8 @@ namespace gr {
                 {
                     H = Hodd;
                 }
-                for (int j = 0; j < C_DATA; j++)
-                {
-                    *out++ = in[H[j]];
-                }
+                gather(out, in, H, C_DATA);
+                out += C_DATA;
                 symbol++;
                 in += C_DATA;
             }
@@ -886,15 +289,15 @@ namespace gr {
                 {
                     H = HoddFC;
                 }
-                for (int j = 0; j < N_FC; j++)
-                {
-                    *out++ = in[H[j]];
-                }
+                gather(out, in, H, N_FC);
+                out += N_FC;
                 symbol++;
                 in += N_FC;
             }
         }
 
+        perf_end(noutput_items);
+
         // Tell runtime system how many output items we produced.
         return noutput_items;
     }
@@ -22,6 +22,7 @@
 #define INCLUDED_DVBT2_FREQINTERLEAVER_CC_IMPL_H
 
 #include <dvbt2/freqinterleaver_cc.h>
+#include "cell_kernels.h"
 
 namespace gr {
   namespace dvbt2 {
@@ -42,6 +43,7 @@ namespace gr {
       int N_FC;
       int C_FC;
       int C_DATA;
+      gather_kernel_t gather;
 
       const static int bitperm1keven[9];
       const static int bitperm1kodd[9];
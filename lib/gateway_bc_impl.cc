@@ -0,0 +1,162 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "gateway_bc_impl.h"
+
+namespace gr {
+  namespace dvbt2 {
+
+    gateway_bc::sptr
+    gateway_bc::make(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_constellation_t constellation, dvbt2_rotation_t rotation, int fecblocks, int tiblocks, dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, dvbt2_l1constellation_t l1constellation, dvbt2_pilotpattern_t pilotpattern, int t2frames, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_inputmode_t inputmode, dvbt2_reservedbiasbits_t reservedbiasbits, dvbt2_l1scrambled_t l1scrambled, dvbt2_inband_t inband, int tsrate, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, float vclip, int iterations, float acevclip, float acegain, float acelimit, int aceiterations, dvbt2_engine_t engine, int depth, const std::vector<int> &cores)
+    {
+      return gnuradio::get_initial_sptr
+        (new gateway_bc_impl(framesize, rate, constellation, rotation, fecblocks, tiblocks, carriermode, fftsize, guardinterval, l1constellation, pilotpattern, t2frames, numdatasyms, paprmode, version, preamble, inputmode, reservedbiasbits, l1scrambled, inband, tsrate, misogroup, equalization, bandwidth, vclip, iterations, acevclip, acegain, acelimit, aceiterations, engine, depth, cores));
+    }
+
+    /*
+     * The private constructor
+     */
+    gateway_bc_impl::gateway_bc_impl(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_constellation_t constellation, dvbt2_rotation_t rotation, int fecblocks, int tiblocks, dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, dvbt2_l1constellation_t l1constellation, dvbt2_pilotpattern_t pilotpattern, int t2frames, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_inputmode_t inputmode, dvbt2_reservedbiasbits_t reservedbiasbits, dvbt2_l1scrambled_t l1scrambled, dvbt2_inband_t inband, int tsrate, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, float vclip, int iterations, float acevclip, float acegain, float acelimit, int aceiterations, dvbt2_engine_t engine, int depth, const std::vector<int> &cores)
+      : gr::block("gateway_bc",
+              gr::io_signature::make(1, 1, sizeof(unsigned char)),
+              gr::io_signature::make(1, 1, sizeof(gr_complex)))
+    {
+        t2_params params;
+
+        params.framesize = framesize;
+        params.rate = rate;
+        params.constellation = constellation;
+        params.rotation = rotation;
+        params.fecblocks = fecblocks;
+        params.tiblocks = tiblocks;
+        params.carriermode = carriermode;
+        params.fftsize = fftsize;
+        params.guardinterval = guardinterval;
+        params.l1constellation = l1constellation;
+        params.pilotpattern = pilotpattern;
+        params.t2frames = t2frames;
+        params.numdatasyms = numdatasyms;
+        params.paprmode = paprmode;
+        params.version = version;
+        params.preamble = preamble;
+        params.inputmode = inputmode;
+        params.reservedbiasbits = reservedbiasbits;
+        params.l1scrambled = l1scrambled;
+        params.inband = inband;
+        params.tsrate = tsrate;
+        params.misogroup = misogroup;
+        params.equalization = equalization;
+        params.bandwidth = bandwidth;
+        params.vclip = vclip;
+        params.iterations = iterations;
+        params.acevclip = acevclip;
+        params.acegain = acegain;
+        params.acelimit = acelimit;
+        params.aceiterations = aceiterations;
+        encoder = new t2_encoder(params, engine, depth, cores);
+        threaded = engine != gr::dvbt2::ENGINE_SINGLE;
+        frame_input_items = encoder->input_items();
+        insertion_items = encoder->output_items();
+        set_output_multiple(insertion_items);
+        perf_attach(this);
+    }
+
+    /*
+     * Our virtual destructor.
+     */
+    gateway_bc_impl::~gateway_bc_impl()
+    {
+        delete encoder;
+    }
+
+    void
+    gateway_bc_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
+    {
+        int frames = noutput_items / insertion_items;
+
+        // Frames already in flight need no input.
+        frames = frames > encoder->frames() ? frames - encoder->frames() : 0;
+        ninput_items_required[0] = frame_input_items * frames;
+    }
+
+    int
+    gateway_bc_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        const unsigned char *in = (const unsigned char *) input_items[0];
+        gr_complex *out = (gr_complex *) output_items[0];
+        int consumed = 0;
+        int produced = 0;
+        int used;
+
+        perf_begin();
+
+        if (!threaded)
+        {
+            while (produced + insertion_items <= noutput_items && ninput_items[0] - consumed >= frame_input_items)
+            {
+                consumed += encoder->encode(&in[consumed], &out[produced]);
+                produced += insertion_items;
+            }
+        }
+        else
+        {
+            while (produced + insertion_items <= noutput_items)
+            {
+                // Keep the engine full, then take the oldest frame.
+                while (ninput_items[0] - consumed >= frame_input_items && (used = encoder->push(&in[consumed])) >= 0)
+                {
+                    consumed += used;
+                }
+                if (!encoder->pop(&out[produced]))
+                {
+                    break;
+                }
+                produced += insertion_items;
+                // Short of input, hand the frame on and let the
+                // scheduler bring more.
+                if (ninput_items[0] - consumed < frame_input_items)
+                {
+                    break;
+                }
+            }
+        }
+
+        // Tell runtime system how many input items we consumed on
+        // each input stream.
+        consume_each (consumed);
+
+        perf_end(produced);
+
+        // Tell runtime system how many output items we produced.
+        return produced;
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
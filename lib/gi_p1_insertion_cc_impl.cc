@@ -0,0 +1,123 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "gi_p1_insertion_cc_impl.h"
+#include "p1_symbol.h"
+#include <dvbt2/t2_geometry.h>
+#include <stdio.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    gi_p1_insertion_cc::sptr
+    gi_p1_insertion_cc::make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_preamble_t preamble)
+    {
+      return gnuradio::get_initial_sptr
+        (new gi_p1_insertion_cc_impl(carriermode, fftsize, guardinterval, numdatasyms, preamble));
+    }
+
+    /*
+     * The private constructor
+     */
+    gi_p1_insertion_cc_impl::gi_p1_insertion_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_preamble_t preamble)
+      : gr::block("gi_p1_insertion_cc",
+              gr::io_signature::make(1, 1, sizeof(gr_complex) * t2_geometry::fft_length(fftsize)),
+              gr::io_signature::make(1, 1, sizeof(gr_complex)))
+    {
+        fft_size = t2_geometry::fft_length(fftsize);
+        guard_interval = t2_geometry::guard_length(fftsize, guardinterval);
+        N_P2 = t2_geometry::p2_symbols(fftsize);
+        p1_symbol(fftsize, preamble, p1_time, p1_timeshft);
+        num_symbols = numdatasyms + N_P2;
+        insertion_items = (num_symbols * (fft_size + guard_interval)) + 2048;
+        set_output_multiple(insertion_items);
+        perf_attach(this);
+    }
+
+    /*
+     * Our virtual destructor.
+     */
+    gi_p1_insertion_cc_impl::~gi_p1_insertion_cc_impl()
+    {
+    }
+
+    void
+    gi_p1_insertion_cc_impl::forecast (int noutput_items, gr_vector_int &ninput_items_required)
+    {
+        ninput_items_required[0] = num_symbols * (noutput_items / insertion_items);
+    }
+
+    int
+    gi_p1_insertion_cc_impl::process(int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        const gr_complex *in = (const gr_complex *) input_items[0];
+        gr_complex *out = (gr_complex *) output_items[0];
+        int frames = noutput_items / insertion_items;
+
+        for (int i = 0; i < frames; i++)
+        {
+            memcpy(out, &p1_timeshft[0], sizeof(gr_complex) * 542);
+            out += 542;
+            memcpy(out, &p1_time[0], sizeof(gr_complex) * 1024);
+            out += 1024;
+            memcpy(out, &p1_timeshft[542], sizeof(gr_complex) * 482);
+            out += 482;
+            for (int j = 0; j < num_symbols; j++)
+            {
+                memcpy(out, &in[fft_size - guard_interval], sizeof(gr_complex) * guard_interval);
+                out += guard_interval;
+                memcpy(out, in, sizeof(gr_complex) * fft_size);
+                out += fft_size;
+                in += fft_size;
+            }
+        }
+
+        return num_symbols * frames;
+    }
+
+    int
+    gi_p1_insertion_cc_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        perf_begin();
+        int consumed = process(noutput_items, input_items, output_items);
+
+        // Tell runtime system how many input items we consumed on
+        // each input stream.
+        consume_each (consumed);
+
+        perf_end(noutput_items);
+
+        // Tell runtime system how many output items we produced.
+        return noutput_items;
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
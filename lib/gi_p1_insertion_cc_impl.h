@@ -0,0 +1,63 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_DVBT2_GI_P1_INSERTION_CC_IMPL_H
+#define INCLUDED_DVBT2_GI_P1_INSERTION_CC_IMPL_H
+
+#include <dvbt2/gi_p1_insertion_cc.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    class gi_p1_insertion_cc_impl : public gi_p1_insertion_cc
+    {
+     private:
+      int fft_size;
+      int guard_interval;
+      int num_symbols;
+      int insertion_items;
+      int N_P2;
+      gr_complex p1_time[1024];
+      gr_complex p1_timeshft[1024];
+
+     public:
+      gi_p1_insertion_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_preamble_t preamble);
+      ~gi_p1_insertion_cc_impl();
+
+      // Where all the action really happens
+      void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+      int general_work(int noutput_items,
+		       gr_vector_int &ninput_items,
+		       gr_vector_const_void_star &input_items,
+		       gr_vector_void_star &output_items);
+
+      // general_work() without the scheduler, returns the input
+      // items consumed. Used by gateway_bc.
+      int process(int noutput_items,
+		  gr_vector_const_void_star &input_items,
+		  gr_vector_void_star &output_items);
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_GI_P1_INSERTION_CC_IMPL_H */
+
@@ -25,6 +25,8 @@
 #include <gnuradio/io_signature.h>
 #include "interleaver_bb_impl.h"
 #include <stdio.h>
+#include <new>
+#include <vector>
 
 namespace gr {
   namespace dvbt2 {
@@ -141,6 +143,14 @@ namespace gr {
                 packed_items = frame_size / mod;
                 break;
         }
+        table = (int *) malloc(sizeof(int) * interleave_table_size(packed_items, mod));
+        if (table == NULL) {
+            fprintf(stderr, "Bit interleaver malloc, Out of memory.\n");
+            throw std::bad_alloc();
+        }
+        interleave_build();
+        interleave = interleave_select();
+        perf_attach(this);
     }
 
     /*
@@ -148,6 +158,7 @@ namespace gr {
      */
     interleaver_bb_impl::~interleaver_bb_impl()
     {
+        free(table);
     }
 
     void
@@ -156,68 +167,41 @@ namespace gr {
         ninput_items_required[0] = noutput_items * mod;
     }
 
-    int
-    interleaver_bb_impl::general_work (int noutput_items,
-                       gr_vector_int &ninput_items,
-                       gr_vector_const_void_star &input_items,
-                       gr_vector_void_star &output_items)
+// The input bit of each output bit, MSB of each cell first: parity
+// interleaving, column twist interleaving and demultiplexing.
+void interleaver_bb_impl::interleave_build(void)
+{
+    std::vector<int> u(frame_size);
+    std::vector<int> v(frame_size);
+    std::vector<int> perm(frame_size);
+    int rows, columns, offset, index;
+    const int *twist;
+    const int *mux;
+
+    for (int k = 0; k < frame_size; k++)
+    {
+        u[k] = k;
+    }
+    if (mod != 2 || code_rate == gr::dvbt2::C1_3 || code_rate == gr::dvbt2::C2_5)
+    {
+        for (int t = 0; t < q_val; t++)
+        {
+            for (int s = 0; s < 360; s++)
+            {
+                u[nbch + (360 * t) + s] = nbch + (q_val * s) + t;
+            }
+        }
+    }
+    if (mod == 2)
+    {
+        perm = u;
+    }
+    else
     {
-        const unsigned char *in = (const unsigned char *) input_items[0];
-        unsigned char *out = (unsigned char *) output_items[0];
-        int consumed = 0;
-        int produced = 0;
-        int rows, offset, index;
-        unsigned int pack;
-        const int *twist;
-        const int *mux;
-
         switch (signal_constellation)
         {
-            case gr::dvbt2::MOD_QPSK:
-                for (int i = 0; i < noutput_items; i += packed_items)
-                {
-                    rows = frame_size / 2;
-                    if (code_rate == gr::dvbt2::C1_3 || code_rate == gr::dvbt2::C2_5)
-                    {
-                        for (int k = 0; k < nbch; k++)
-                        {
-                            tempu[k] = *in++;
-                        }
-                        for (int t = 0; t < q_val; t++)
-                        {
-                            for (int s = 0; s < 360; s++)
-                            {
-                                tempu[nbch + (360 * t) + s] = in[(q_val * s) + t];
-                            }
-                        }
-                        in = in + (q_val * 360);
-                        index = 0;
-                        for (int j = 0; j < rows; j++)
-                        {
-                            out[produced] = tempu[index++] << 1;
-                            out[produced++] |= tempu[index++];
-                            consumed += 2;
-                        }
-                    }
-                    else
-                    {
-                        for (int j = 0; j < rows; j++)
-                        {
-                            out[produced] = in[consumed++] << 1;
-                            out[produced++] |= in[consumed++];
-                        }
-                    }
-                }
-                break;
             case gr::dvbt2::MOD_16QAM:
-                if (frame_size == FRAME_SIZE_NORMAL)
-                {
-                    twist = &twist16n[0];
-                }
-                else
-                {
-                    twist = &twist16s[0];
-                }
+                twist = frame_size == FRAME_SIZE_NORMAL ? &twist16n[0] : &twist16s[0];
                 if (code_rate == gr::dvbt2::C3_5 && frame_size == FRAME_SIZE_NORMAL)
                 {
                     mux = &mux16_35[0];
@@ -234,79 +218,9 @@ namespace gr {
                 {
                     mux = &mux16[0];
                 }
-                for (int i = 0; i < noutput_items; i += packed_items)
-                {
-                    rows = frame_size / (mod * 2);
-                    const unsigned char *c1, *c2, *c3, *c4, *c5, *c6, *c7, *c8;
-                    c1 = &tempv[0];
-                    c2 = &tempv[rows];
-                    c3 = &tempv[rows * 2];
-                    c4 = &tempv[rows * 3];
-                    c5 = &tempv[rows * 4];
-                    c6 = &tempv[rows * 5];
-                    c7 = &tempv[rows * 6];
-                    c8 = &tempv[rows * 7];
-                    for (int k = 0; k < nbch; k++)
-                    {
-                        tempu[k] = *in++;
-                    }
-                    for (int t = 0; t < q_val; t++)
-                    {
-                        for (int s = 0; s < 360; s++)
-                        {
-                            tempu[nbch + (360 * t) + s] = in[(q_val * s) + t];
-                        }
-                    }
-                    in = in + (q_val * 360);
-                    index = 0;
-                    for (int col = 0; col < (mod * 2); col++)
-                    {
-                        offset = twist[col];
-                        for (int row = 0; row < rows; row++)
-                        {
-                            tempv[offset + (rows * col)] = tempu[index++];
-                            offset = (offset + 1) % rows;
-                        }
-                    }
-                    index = 0;
-                    for (int j = 0; j < rows; j++)
-                    {
-                        tempu[index++] = c1[j];
-                        tempu[index++] = c2[j];
-                        tempu[index++] = c3[j];
-                        tempu[index++] = c4[j];
-                        tempu[index++] = c5[j];
-                        tempu[index++] = c6[j];
-                        tempu[index++] = c7[j];
-                        tempu[index++] = c8[j];
-                    }
-                    index = 0;
-                    for (int d = 0; d < frame_size / (mod * 2); d++)
-                    {
-                        pack = 0;
-                        for (int e = 0; e < (mod * 2); e++)
-                        {
-                            offset = mux[e];
-                            pack |= tempu[index + offset];
-                            pack <<= 1;
-                        }
-                        pack >>= 1;
-                        out[produced++] = pack >> 4;
-                        out[produced++] = pack & 0xf;
-                        index += (mod * 2);
-                        consumed += (mod * 2);
-                    }
-                }
                 break;
             case gr::dvbt2::MOD_64QAM:
-                if (frame_size == FRAME_SIZE_NORMAL)
-                {
-                    twist = &twist64n[0];
-                }
-                else
-                {
-                    twist = &twist64s[0];
-                }
+                twist = frame_size == FRAME_SIZE_NORMAL ? &twist64n[0] : &twist64s[0];
                 if (code_rate == gr::dvbt2::C3_5 && frame_size == FRAME_SIZE_NORMAL)
                 {
                     mux = &mux64_35[0];
@@ -323,81 +237,11 @@ namespace gr {
                 {
                     mux = &mux64[0];
                 }
-                for (int i = 0; i < noutput_items; i += packed_items)
-                {
-                    rows = frame_size / (mod * 2);
-                    const unsigned char *c1, *c2, *c3, *c4, *c5, *c6, *c7, *c8, *c9, *c10, *c11, *c12;
-                    c1 = &tempv[0];
-                    c2 = &tempv[rows];
-                    c3 = &tempv[rows * 2];
-                    c4 = &tempv[rows * 3];
-                    c5 = &tempv[rows * 4];
-                    c6 = &tempv[rows * 5];
-                    c7 = &tempv[rows * 6];
-                    c8 = &tempv[rows * 7];
-                    c9 = &tempv[rows * 8];
-                    c10 = &tempv[rows * 9];
-                    c11 = &tempv[rows * 10];
-                    c12 = &tempv[rows * 11];
-                    for (int k = 0; k < nbch; k++)
-                    {
-                        tempu[k] = *in++;
-                    }
-                    for (int t = 0; t < q_val; t++)
-                    {
-                        for (int s = 0; s < 360; s++)
-                        {
-                            tempu[nbch + (360 * t) + s] = in[(q_val * s) + t];
-                        }
-                    }
-                    in = in + (q_val * 360);
-                    index = 0;
-                    for (int col = 0; col < (mod * 2); col++)
-                    {
-                        offset = twist[col];
-                        for (int row = 0; row < rows; row++)
-                        {
-                            tempv[offset + (rows * col)] = tempu[index++];
-                            offset = (offset + 1) % rows;
-                        }
-                    }
-                    index = 0;
-                    for (int j = 0; j < rows; j++)
-                    {
-                        tempu[index++] = c1[j];
-                        tempu[index++] = c2[j];
-                        tempu[index++] = c3[j];
-                        tempu[index++] = c4[j];
-                        tempu[index++] = c5[j];
-                        tempu[index++] = c6[j];
-                        tempu[index++] = c7[j];
-                        tempu[index++] = c8[j];
-                        tempu[index++] = c9[j];
-                        tempu[index++] = c10[j];
-                        tempu[index++] = c11[j];
-                        tempu[index++] = c12[j];
-                    }
-                    index = 0;
-                    for (int d = 0; d < frame_size / (mod * 2); d++)
-                    {
-                        pack = 0;
-                        for (int e = 0; e < (mod * 2); e++)
-                        {
-                            offset = mux[e];
-                            pack |= tempu[index + offset];
-                            pack <<= 1;
-                        }
-                        pack >>= 1;
-                        out[produced++] = pack >> 6;
-                        out[produced++] = pack & 0x3f;
-                        index += (mod * 2);
-                        consumed += (mod * 2);
-                    }
-                }
                 break;
-            case gr::dvbt2::MOD_256QAM:
+            default:
                 if (frame_size == FRAME_SIZE_NORMAL)
                 {
+                    twist = &twist256n[0];
                     if (code_rate == gr::dvbt2::C3_5)
                     {
                         mux = &mux256_35[0];
@@ -410,89 +254,10 @@ namespace gr {
                     {
                         mux = &mux256[0];
                     }
-                    for (int i = 0; i < noutput_items; i += packed_items)
-                    {
-                        rows = frame_size / (mod * 2);
-                        const unsigned char *c1, *c2, *c3, *c4, *c5, *c6, *c7, *c8;
-                        const unsigned char *c9, *c10, *c11, *c12, *c13, *c14, *c15, *c16;
-                        c1 = &tempv[0];
-                        c2 = &tempv[rows];
-                        c3 = &tempv[rows * 2];
-                        c4 = &tempv[rows * 3];
-                        c5 = &tempv[rows * 4];
-                        c6 = &tempv[rows * 5];
-                        c7 = &tempv[rows * 6];
-                        c8 = &tempv[rows * 7];
-                        c9 = &tempv[rows * 8];
-                        c10 = &tempv[rows * 9];
-                        c11 = &tempv[rows * 10];
-                        c12 = &tempv[rows * 11];
-                        c13 = &tempv[rows * 12];
-                        c14 = &tempv[rows * 13];
-                        c15 = &tempv[rows * 14];
-                        c16 = &tempv[rows * 15];
-                        for (int k = 0; k < nbch; k++)
-                        {
-                            tempu[k] = *in++;
-                        }
-                        for (int t = 0; t < q_val; t++)
-                        {
-                            for (int s = 0; s < 360; s++)
-                            {
-                                tempu[nbch + (360 * t) + s] = in[(q_val * s) + t];
-                            }
-                        }
-                        in = in + (q_val * 360);
-                        index = 0;
-                        for (int col = 0; col < (mod * 2); col++)
-                        {
-                            offset = twist256n[col];
-                            for (int row = 0; row < rows; row++)
-                            {
-                                tempv[offset + (rows * col)] = tempu[index++];
-                                offset = (offset + 1) % rows;
-                            }
-                        }
-                        index = 0;
-                        for (int j = 0; j < rows; j++)
-                        {
-                            tempu[index++] = c1[j];
-                            tempu[index++] = c2[j];
-                            tempu[index++] = c3[j];
-                            tempu[index++] = c4[j];
-                            tempu[index++] = c5[j];
-                            tempu[index++] = c6[j];
-                            tempu[index++] = c7[j];
-                            tempu[index++] = c8[j];
-                            tempu[index++] = c9[j];
-                            tempu[index++] = c10[j];
-                            tempu[index++] = c11[j];
-                            tempu[index++] = c12[j];
-                            tempu[index++] = c13[j];
-                            tempu[index++] = c14[j];
-                            tempu[index++] = c15[j];
-                            tempu[index++] = c16[j];
-                        }
-                        index = 0;
-                        for (int d = 0; d < frame_size / (mod * 2); d++)
-                        {
-                            pack = 0;
-                            for (int e = 0; e < (mod * 2); e++)
-                            {
-                                offset = mux[e];
-                                pack |= tempu[index + offset];
-                                pack <<= 1;
-                            }
-                            pack >>= 1;
-                            out[produced++] = pack >> 8;
-                            out[produced++] = pack & 0xff;
-                            index += (mod * 2);
-                            consumed += (mod * 2);
-                        }
-                    }
                 }
                 else
                 {
+                    twist = &twist256s[0];
                     if (code_rate == gr::dvbt2::C1_3)
                     {
                         mux = &mux256s_13[0];
@@ -505,76 +270,67 @@ namespace gr {
                     {
                         mux = &mux256s[0];
                     }
-                    for (int i = 0; i < noutput_items; i += packed_items)
-                    {
-                        rows = frame_size / mod;
-                        const unsigned char *c1, *c2, *c3, *c4, *c5, *c6, *c7, *c8;
-                        c1 = &tempv[0];
-                        c2 = &tempv[rows];
-                        c3 = &tempv[rows * 2];
-                        c4 = &tempv[rows * 3];
-                        c5 = &tempv[rows * 4];
-                        c6 = &tempv[rows * 5];
-                        c7 = &tempv[rows * 6];
-                        c8 = &tempv[rows * 7];
-                        for (int k = 0; k < nbch; k++)
-                        {
-                            tempu[k] = *in++;
-                        }
-                        for (int t = 0; t < q_val; t++)
-                        {
-                            for (int s = 0; s < 360; s++)
-                            {
-                                tempu[nbch + (360 * t) + s] = in[(q_val * s) + t];
-                            }
-                        }
-                        in = in + (q_val * 360);
-                        index = 0;
-                        for (int col = 0; col < mod; col++)
-                        {
-                            offset = twist256s[col];
-                            for (int row = 0; row < rows; row++)
-                            {
-                                tempv[offset + (rows * col)] = tempu[index++];
-                                offset = (offset + 1) % rows;
-                            }
-                        }
-                        index = 0;
-                        for (int j = 0; j < rows; j++)
-                        {
-                            tempu[index++] = c1[j];
-                            tempu[index++] = c2[j];
-                            tempu[index++] = c3[j];
-                            tempu[index++] = c4[j];
-                            tempu[index++] = c5[j];
-                            tempu[index++] = c6[j];
-                            tempu[index++] = c7[j];
-                            tempu[index++] = c8[j];
-                        }
-                        index = 0;
-                        for (int d = 0; d < frame_size / mod; d++)
-                        {
-                            pack = 0;
-                            for (int e = 0; e < mod; e++)
-                            {
-                                offset = mux[e];
-                                pack |= tempu[index + offset];
-                                pack <<= 1;
-                            }
-                            pack >>= 1;
-                            out[produced++] = pack & 0xff;
-                            index += mod;
-                            consumed += mod;
-                        }
-                    }
                 }
                 break;
         }
+        // Written column-wise with the twist, read row-wise. Each row
+        // is demultiplexed into one cell, or two when it has 2 * mod bits.
+        columns = (signal_constellation == gr::dvbt2::MOD_256QAM && frame_size == FRAME_SIZE_SHORT) ? mod : mod * 2;
+        rows = frame_size / columns;
+        index = 0;
+        for (int col = 0; col < columns; col++)
+        {
+            offset = twist[col];
+            for (int row = 0; row < rows; row++)
+            {
+                v[offset + (rows * col)] = u[index++];
+                offset = (offset + 1) % rows;
+            }
+        }
+        for (int j = 0; j < rows; j++)
+        {
+            for (int e = 0; e < columns; e++)
+            {
+                perm[(j * columns) + e] = v[(rows * mux[e]) + j];
+            }
+        }
+    }
+    interleave_table(table, &perm[0], packed_items, mod, frame_size);
+}
+
+    int
+    interleaver_bb_impl::process(int noutput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        const unsigned char *in = (const unsigned char *) input_items[0];
+        unsigned char *out = (unsigned char *) output_items[0];
+        int consumed = 0;
+
+        for (int i = 0; i < noutput_items; i += packed_items)
+        {
+            interleave(&out[i], &in[consumed], table, packed_items, mod);
+            consumed += frame_size;
+        }
+
+        return consumed;
+    }
+
+    int
+    interleaver_bb_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        perf_begin();
+        int consumed = process(noutput_items, input_items, output_items);
 
         // Tell runtime system how many input items we consumed on
         // each input stream.
         consume_each (consumed);
 
+        perf_end(noutput_items);
+
         // Tell runtime system how many output items we produced.
         return noutput_items;
     }
@@ -22,6 +22,7 @@
 #define INCLUDED_DVBT2_INTERLEAVER_BB_IMPL_H
 
 #include <dvbt2/interleaver_bb.h>
+#include "fec_kernels.h"
 
 namespace gr {
   namespace dvbt2 {
@@ -36,8 +37,9 @@ namespace gr {
       int q_val;
       int mod;
       int packed_items;
-      unsigned char tempu[FRAME_SIZE_NORMAL];
-      unsigned char tempv[FRAME_SIZE_NORMAL];
+      int *table;
+      interleave_kernel_t interleave;
+      void interleave_build(void);
 
       const static int twist16n[8];
       const static int twist64n[12];
@@ -75,6 +77,12 @@ namespace gr {
 		       gr_vector_int &ninput_items,
 		       gr_vector_const_void_star &input_items,
 		       gr_vector_void_star &output_items);
+
+      // general_work() without the scheduler, returns the input
+      // items consumed. Used by gateway_bc.
+      int process(int noutput_items,
+		  gr_vector_const_void_star &input_items,
+		  gr_vector_void_star &output_items);
     };
 
   } // namespace dvbt2
@@ -0,0 +1,111 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kernel_dispatch.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+static const char *arch_names[ARCH_AVX512 + 1] =
+{
+    "generic", "sse2", "avx", "avx2", "avx512"
+};
+
+bool kernel_arch_supported(kernel_arch_t arch)
+{
+    if (arch == ARCH_GENERIC)
+    {
+        return true;
+    }
+#ifdef DVBT2_KERNELS_X86
+    __builtin_cpu_init();
+    switch (arch)
+    {
+        case ARCH_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case ARCH_AVX:
+            return __builtin_cpu_supports("avx");
+        case ARCH_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case ARCH_AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+        default:
+            return false;
+    }
+#elif defined(DVBT2_KERNELS_NEON)
+    return arch == ARCH_NEON;
+#else
+    return false;
+#endif
+}
+
+static kernel_arch_t arch_limit(void)
+{
+    kernel_arch_t limit = ARCH_GENERIC;
+    const char *name = getenv("DVBT2_ARCH");
+
+    for (int a = ARCH_SSE2; a <= ARCH_AVX512; a++)
+    {
+        if (kernel_arch_supported((kernel_arch_t)a))
+        {
+            limit = (kernel_arch_t)a;
+        }
+    }
+    if (name != NULL)
+    {
+        for (int a = ARCH_GENERIC; a < (int)limit; a++)
+        {
+            if (strcmp(name, arch_names[a]) == 0)
+            {
+                return (kernel_arch_t)a;
+            }
+        }
+    }
+    return limit;
+}
+
+kernel_arch_t kernel_arch_limit(void)
+{
+    // Once per process, every block gets the same variants.
+    static const kernel_arch_t limit = arch_limit();
+
+    return limit;
+}
+
+const char *kernel_arch_name(kernel_arch_t arch)
+{
+#ifdef DVBT2_KERNELS_NEON
+    if (arch == ARCH_NEON)
+    {
+        return "neon";
+    }
+#endif
+    return arch_names[arch];
+}
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
@@ -0,0 +1,92 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_DVBT2_KERNEL_DISPATCH_H
+#define INCLUDED_DVBT2_KERNEL_DISPATCH_H
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DVBT2_KERNELS_X86
+#endif
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define DVBT2_KERNELS_NEON
+#endif
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * Instruction set levels of the kernel variants. Every kernel has a
+     * generic variant in plain C, the reference the others must match
+     * bit for bit, and variants for the instruction sets that help it.
+     * The variants are compiled into the same binary with target
+     * attributes and chosen by the CPU the library runs on, so one
+     * build runs everywhere and uses what each host has.
+     *
+     * ARCH_AVX512 is AVX-512 F, BW, DQ and VL, as in every AVX-512 CPU
+     * since Skylake-SP.
+     */
+    enum kernel_arch_t
+    {
+      ARCH_GENERIC = 0,
+      ARCH_SSE2,
+      ARCH_AVX,
+      ARCH_AVX2,
+      ARCH_AVX512,
+      ARCH_NEON = ARCH_SSE2
+    };
+
+    //! Whether this CPU, and the OS, can run arch.
+    bool kernel_arch_supported(kernel_arch_t arch);
+
+    //! The highest arch kernels are selected up to. That of the CPU,
+    //! or lower when set by the DVBT2_ARCH environment variable to
+    //! generic, sse2, avx, avx2 or avx512.
+    kernel_arch_t kernel_arch_limit(void);
+
+    //! Name of arch, as in DVBT2_ARCH.
+    const char *kernel_arch_name(kernel_arch_t arch);
+
+    /*
+     * Each kernel lists its variants as { name, arch, kernel } in
+     * order of arch, and its select function picks the last one within
+     * kernel_arch_limit(). The list only has variants this CPU runs.
+     */
+    template <class impl>
+    const impl &
+    kernel_choose(const impl *list, int count)
+    {
+        kernel_arch_t limit = kernel_arch_limit();
+        int best = 0;
+
+        for (int k = 1; k < count; k++)
+        {
+            if (list[k].arch <= limit)
+            {
+                best = k;
+            }
+        }
+        return list[best];
+    }
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_KERNEL_DISPATCH_H */
@@ -117,7 +117,9 @@ namespace gr {
         }
         code_rate = rate;
         ldpc_lookup_generate();
+        ldpc = ldpc_select();
         set_output_multiple(frame_size);
+        perf_attach(this);
     }
 
     /*
@@ -136,30 +138,21 @@ namespace gr {
 #define LDPC_BF(TABLE_NAME, ROWS) \
 for (int row = 0; row < ROWS; row++) \
 { \
-    for(int n = 0; n < 360; n++) \
+    ldpc_encode.first[row] = index; \
+    ldpc_encode.groups = row + 1; \
+    for (int col = 1; col <= TABLE_NAME[row][0]; col++) \
     { \
-        for (int col = 1; col <= TABLE_NAME[row][0]; col++) \
-        { \
-            ldpc_encode.p[index] = (TABLE_NAME[row][col] + (n * q)) % pbits; \
-            ldpc_encode.d[index] = im; \
-            index++; \
-        } \
-        im++; \
+        ldpc_encode.address[index++] = TABLE_NAME[row][col]; \
     } \
-} 
+}
 
 void ldpc_bb_impl::ldpc_lookup_generate(void)
 {
-    int im;
     int index;
-    int pbits;
-    int q;
     index = 0;
-    im = 0;
-
-    pbits = frame_size - nbch;    //number of parity bits
-    q = q_val;
 
+    ldpc_encode.q = q_val;
+    ldpc_encode.groups = 0;
     if (frame_size == FRAME_SIZE_NORMAL)
     {
         if (code_rate == gr::dvbt2::C1_2)  LDPC_BF(ldpc_tab_1_2N,  90);
@@ -180,51 +173,43 @@ void ldpc_bb_impl::ldpc_lookup_generate(void)
         if (code_rate == gr::dvbt2::C4_5) LDPC_BF(ldpc_tab_4_5S, 35);
         if (code_rate == gr::dvbt2::C5_6) LDPC_BF(ldpc_tab_5_6S, 37);
     }
-    ldpc_encode.table_length = index;
+    ldpc_encode.first[ldpc_encode.groups] = index;
 }
 
     int
-    ldpc_bb_impl::general_work (int noutput_items,
-                       gr_vector_int &ninput_items,
+    ldpc_bb_impl::process(int noutput_items,
                        gr_vector_const_void_star &input_items,
                        gr_vector_void_star &output_items)
     {
         const unsigned char *in = (const unsigned char *) input_items[0];
         unsigned char *out = (unsigned char *) output_items[0];
-        const unsigned char *d;
-        unsigned char *p;
-        // Calculate the number of parity bits
-        int plen = frame_size - nbch;
-        d = in;
-        p = &out[nbch];
         int consumed = 0;
 
         for (int i = 0; i < noutput_items; i += frame_size)
         {
-            // First zero all the parity bits
-            memset(p, 0, sizeof(unsigned char)*plen);
-            for(int j = 0; j < (int)nbch; j++)
-            {
-                out[i + j] = in[consumed];
-                consumed++;
-            }
-            // now do the parity checking
-            for(int j = 0; j < ldpc_encode.table_length; j++)
-            {
-                p[ldpc_encode.p[j]] ^= d[ldpc_encode.d[j]];
-            }
-            for(int j = 1; j < plen; j++)
-            {
-               p[j] ^= p[j-1];
-            }
-            d += nbch;
-            p += frame_size;
+            memcpy(&out[i], &in[consumed], nbch);
+            ldpc(&out[i + nbch], &in[consumed], &ldpc_encode);
+            consumed += nbch;
         }
 
+        return consumed;
+    }
+
+    int
+    ldpc_bb_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        perf_begin();
+        int consumed = process(noutput_items, input_items, output_items);
+
         // Tell runtime system how many input items we consumed on
         // each input stream.
         consume_each (consumed);
 
+        perf_end(noutput_items);
+
         // Tell runtime system how many output items we produced.
         return noutput_items;
     }
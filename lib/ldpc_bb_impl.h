@@ -22,12 +22,7 @@
 #define INCLUDED_DVBT2_LDPC_BB_IMPL_H
 
 #include <dvbt2/ldpc_bb.h>
-
-typedef struct{
-    int table_length;
-    int d[LDPC_ENCODE_TABLE_LENGTH];
-    int p[LDPC_ENCODE_TABLE_LENGTH];
-}ldpc_encode_table;
+#include "fec_kernels.h"
 
 namespace gr {
   namespace dvbt2 {
@@ -41,7 +36,8 @@ namespace gr {
       unsigned int q_val;
       unsigned int table_length;
       void ldpc_lookup_generate(void);
-      ldpc_encode_table ldpc_encode;
+      ldpc_table ldpc_encode;
+      ldpc_kernel_t ldpc;
 
       const static int ldpc_tab_1_2N[90][9];
       const static int ldpc_tab_3_5N[108][13];
@@ -70,6 +66,12 @@ namespace gr {
 		       gr_vector_int &ninput_items,
 		       gr_vector_const_void_star &input_items,
 		       gr_vector_void_star &output_items);
+
+      // general_work() without the scheduler, returns the input
+      // items consumed. Used by gateway_bc.
+      int process(int noutput_items,
+		  gr_vector_const_void_star &input_items,
+		  gr_vector_void_star &output_items);
     };
 
   } // namespace dvbt2
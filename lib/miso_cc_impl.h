@@ -22,6 +22,7 @@
 #define INCLUDED_DVBT2_MISO_CC_IMPL_H
 
 #include <dvbt2/miso_cc.h>
+#include "miso_kernels.h"
 
 namespace gr {
   namespace dvbt2 {
@@ -35,6 +36,7 @@ namespace gr {
       int N_FC;
       int C_FC;
       int C_DATA;
+      alamouti_kernel_t alamouti;
 
      public:
       miso_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode);
@@ -0,0 +1,182 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "miso_kernels.h"
+#ifdef DVBT2_KERNELS_X86
+#include <immintrin.h>
+#endif
+#ifdef DVBT2_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace gr {
+  namespace dvbt2 {
+
+void alamouti_generic(gr_complex *out, const gr_complex *in, int pairs)
+{
+    gr_complex temp1, temp2;
+
+    for (int j = 0; j < pairs; j++)
+    {
+        temp1 = *in++;
+        temp2 = *in++;
+        out->real() = -temp2.real();
+        out->imag() = temp2.imag();
+        out++;
+        out->real() = temp1.real();
+        out->imag() = -temp1.imag();
+        out++;
+    }
+}
+
+// One pair is one 128 bit vector (a.real, a.imag, b.real, b.imag). Swapping
+// the 64 bit halves and flipping the sign bits of lanes 0 and 3 gives
+// (-b.real, b.imag, a.real, -a.imag).
+#ifdef DVBT2_KERNELS_X86
+__attribute__((target("sse2")))
+void alamouti_sse2(gr_complex *out, const gr_complex *in, int pairs)
+{
+    const float *src = (const float *) in;
+    float *dst = (float *) out;
+    const __m128 sign = _mm_castsi128_ps(_mm_set_epi32(0x80000000, 0, 0, 0x80000000));
+    __m128 x;
+    int j;
+
+    for (j = 0; j < pairs; j++)
+    {
+        x = _mm_loadu_ps(src);
+        x = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 0, 3, 2));
+        _mm_storeu_ps(dst, _mm_xor_ps(x, sign));
+        src += 4;
+        dst += 4;
+    }
+}
+
+__attribute__((target("avx")))
+void alamouti_avx(gr_complex *out, const gr_complex *in, int pairs)
+{
+    const float *src = (const float *) in;
+    float *dst = (float *) out;
+    const __m256 sign = _mm256_castsi256_ps(_mm256_set_epi32(0x80000000, 0, 0, 0x80000000, 0x80000000, 0, 0, 0x80000000));
+    __m256 x;
+    int j;
+
+    for (j = 0; j + 2 <= pairs; j += 2)
+    {
+        x = _mm256_loadu_ps(src);
+        x = _mm256_permute_ps(x, _MM_SHUFFLE(1, 0, 3, 2));
+        _mm256_storeu_ps(dst, _mm256_xor_ps(x, sign));
+        src += 8;
+        dst += 8;
+    }
+    alamouti_generic((gr_complex *) dst, (const gr_complex *) src, pairs - j);
+}
+
+__attribute__((target("avx512f")))
+void alamouti_avx512(gr_complex *out, const gr_complex *in, int pairs)
+{
+    const float *src = (const float *) in;
+    float *dst = (float *) out;
+    const __m512i sign = _mm512_set4_epi32(0x80000000, 0, 0, 0x80000000);
+    __m512 x;
+    int j;
+
+    for (j = 0; j + 4 <= pairs; j += 4)
+    {
+        x = _mm512_loadu_ps(src);
+        x = _mm512_maskz_permute_ps(0xffff, x, _MM_SHUFFLE(1, 0, 3, 2));
+        _mm512_storeu_ps(dst, _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), sign)));
+        src += 16;
+        dst += 16;
+    }
+    alamouti_avx((gr_complex *) dst, (const gr_complex *) src, pairs - j);
+}
+#endif
+
+#ifdef DVBT2_KERNELS_NEON
+void alamouti_neon(gr_complex *out, const gr_complex *in, int pairs)
+{
+    const float *src = (const float *) in;
+    float *dst = (float *) out;
+    const uint32_t mask[4] = {0x80000000, 0, 0, 0x80000000};
+    const uint32x4_t sign = vld1q_u32(mask);
+    float32x4_t x;
+
+    for (int j = 0; j < pairs; j++)
+    {
+        x = vld1q_f32(src);
+        x = vcombine_f32(vget_high_f32(x), vget_low_f32(x));
+        vst1q_f32(dst, vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(x), sign)));
+        src += 4;
+        dst += 4;
+    }
+}
+#endif
+
+int alamouti_kernels(alamouti_impl *list)
+{
+    int count = 0;
+
+    list[count].name = "generic";
+    list[count].arch = ARCH_GENERIC;
+    list[count++].kernel = alamouti_generic;
+#ifdef DVBT2_KERNELS_X86
+    if (kernel_arch_supported(ARCH_SSE2))
+    {
+        list[count].name = "sse2";
+        list[count].arch = ARCH_SSE2;
+        list[count++].kernel = alamouti_sse2;
+    }
+    if (kernel_arch_supported(ARCH_AVX))
+    {
+        list[count].name = "avx";
+        list[count].arch = ARCH_AVX;
+        list[count++].kernel = alamouti_avx;
+    }
+    if (kernel_arch_supported(ARCH_AVX512))
+    {
+        list[count].name = "avx512";
+        list[count].arch = ARCH_AVX512;
+        list[count++].kernel = alamouti_avx512;
+    }
+#endif
+#ifdef DVBT2_KERNELS_NEON
+    list[count].name = "neon";
+    list[count].arch = ARCH_NEON;
+    list[count++].kernel = alamouti_neon;
+#endif
+    return count;
+}
+
+alamouti_kernel_t alamouti_select(void)
+{
+    alamouti_impl list[MAX_ALAMOUTI_KERNELS];
+    int count = alamouti_kernels(list);
+
+    return kernel_choose(list, count).kernel;
+}
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
@@ -0,0 +1,66 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_DVBT2_MISO_KERNELS_H
+#define INCLUDED_DVBT2_MISO_KERNELS_H
+
+#include <gnuradio/gr_complex.h>
+#include "kernel_dispatch.h"
+
+#define MAX_ALAMOUTI_KERNELS 5
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * Alamouti encoding of the TX2 cells. Each input pair (a, b) is
+     * written as (-b*, a*), that is (-b.real, b.imag), (a.real, -a.imag).
+     * All variants give bit identical output.
+     */
+    typedef void (*alamouti_kernel_t)(gr_complex *out, const gr_complex *in, int pairs);
+
+    struct alamouti_impl
+    {
+      const char *name;
+      kernel_arch_t arch;
+      alamouti_kernel_t kernel;
+    };
+
+    void alamouti_generic(gr_complex *out, const gr_complex *in, int pairs);
+#ifdef DVBT2_KERNELS_X86
+    void alamouti_sse2(gr_complex *out, const gr_complex *in, int pairs);
+    void alamouti_avx(gr_complex *out, const gr_complex *in, int pairs);
+    void alamouti_avx512(gr_complex *out, const gr_complex *in, int pairs);
+#endif
+#ifdef DVBT2_KERNELS_NEON
+    void alamouti_neon(gr_complex *out, const gr_complex *in, int pairs);
+#endif
+
+    //! Fill list with the variants this CPU can run, generic first, and return the count.
+    int alamouti_kernels(alamouti_impl *list);
+
+    //! The fastest variant this CPU can run, see kernel_choose().
+    alamouti_kernel_t alamouti_select(void);
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_MISO_KERNELS_H */
+
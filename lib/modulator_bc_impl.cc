@@ -823,7 +823,28 @@ namespace gr {
                 break;
         }
         signal_constellation = constellation;
+        switch (constellation)
+        {
+            case gr::dvbt2::MOD_QPSK:
+                points = m_qpsk;
+                mask = 0x3;
+                break;
+            case gr::dvbt2::MOD_16QAM:
+                points = m_16qam;
+                mask = 0xf;
+                break;
+            case gr::dvbt2::MOD_64QAM:
+                points = m_64qam;
+                mask = 0x3f;
+                break;
+            case gr::dvbt2::MOD_256QAM:
+                points = m_256qam;
+                mask = 0xff;
+                break;
+        }
+        mapper = mapper_select();
         set_output_multiple(cell_size);
+        perf_attach(this);
     }
 
     /*
@@ -840,128 +861,37 @@ namespace gr {
     }
 
     int
-    modulator_bc_impl::general_work (int noutput_items,
-                       gr_vector_int &ninput_items,
+    modulator_bc_impl::process(int noutput_items,
                        gr_vector_const_void_star &input_items,
                        gr_vector_void_star &output_items)
     {
         const unsigned char *in = (const unsigned char *) input_items[0];
         gr_complex *out = (gr_complex *) output_items[0];
-        const unsigned char *in_delay;
-        gr_complex f_temp[1], g_temp[1];
-        int index, index_delay;
 
-        switch (signal_constellation)
+        // Rotated constellations take the imaginary part from the
+        // previous cell of the FEC block, cyclically.
+        for (int i = 0; i < noutput_items; i += cell_size)
         {
-            case gr::dvbt2::MOD_QPSK:
-                for (int i = 0; i < noutput_items; i += cell_size)
-                {
-                    if (cyclic_delay == FALSE)
-                    {
-                        for (int j = 0; j < cell_size; j++)
-                        {
-                            index = *in++;
-                            *out++ = m_qpsk[index & 0x3];
-                        }
-                    }
-                    else
-                    {
-                        in_delay = in;
-                        for (int j = 0; j < cell_size; j++)
-                        {
-                            index = *in++;
-                            index_delay = in_delay[(j + cell_size - 1) % cell_size];
-                            f_temp[0] = m_qpsk[index & 0x3];
-                            g_temp[0] = m_qpsk[index_delay & 0x3];
-                            f_temp[0].imag() = g_temp[0].imag();
-                            *out++ = f_temp[0];
-                        }
-                    }
-                }
-                break;
-            case gr::dvbt2::MOD_16QAM:
-                for (int i = 0; i < noutput_items; i += cell_size)
-                {
-                    if (cyclic_delay == FALSE)
-                    {
-                        for (int j = 0; j < cell_size; j++)
-                        {
-                           index = *in++;
-                           *out++ = m_16qam[index & 0xf];
-                        }
-                    }
-                    else
-                    {
-                        in_delay = in;
-                        for (int j = 0; j < cell_size; j++)
-                        {
-                            index = *in++;
-                            index_delay = in_delay[(j + cell_size - 1) % cell_size];
-                            f_temp[0] = m_16qam[index & 0xf];
-                            g_temp[0] = m_16qam[index_delay & 0xf];
-                            f_temp[0].imag() = g_temp[0].imag();
-                            *out++ = f_temp[0];
-                        }
-                    }
-                }
-                break;
-            case gr::dvbt2::MOD_64QAM:
-                for (int i = 0; i < noutput_items; i += cell_size)
-                {
-                    if (cyclic_delay == FALSE)
-                    {
-                        for (int j = 0; j < noutput_items; j++)
-                        {
-                            index = *in++;
-                            *out++ = m_64qam[index & 0x3f];
-                        }
-                    }
-                    else
-                    {
-                        in_delay = in;
-                        for (int j = 0; j < cell_size; j++)
-                        {
-                            index = *in++;
-                            index_delay = in_delay[(j + cell_size - 1) % cell_size];
-                            f_temp[0] = m_64qam[index & 0x3f];
-                            g_temp[0] = m_64qam[index_delay & 0x3f];
-                            f_temp[0].imag() = g_temp[0].imag();
-                            *out++ = f_temp[0];
-                        }
-                    }
-                }
-                break;
-            case gr::dvbt2::MOD_256QAM:
-                for (int i = 0; i < noutput_items; i += cell_size)
-                {
-                    if (cyclic_delay == FALSE)
-                    {
-                        for (int j = 0; j < cell_size; j++)
-                        {
-                            index = *in++;
-                            *out++ = m_256qam[index & 0xff];
-                        }
-                    }
-                    else
-                    {
-                        in_delay = in;
-                        for (int j = 0; j < cell_size; j++)
-                        {
-                            index = *in++;
-                            index_delay = in_delay[(j + cell_size - 1) % cell_size];
-                            f_temp[0] = m_256qam[index & 0xff];
-                            g_temp[0] = m_256qam[index_delay & 0xff];
-                            f_temp[0].imag() = g_temp[0].imag();
-                            *out++ = f_temp[0];
-                        }
-                    }
-                }
-                break;
+            mapper(&out[i], &in[i], points, mask, cell_size, cyclic_delay);
         }
 
+        return noutput_items;
+    }
+
+    int
+    modulator_bc_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        perf_begin();
+        int consumed = process(noutput_items, input_items, output_items);
+
         // Tell runtime system how many input items we consumed on
         // each input stream.
-        consume_each (noutput_items);
+        consume_each (consumed);
+
+        perf_end(noutput_items);
 
         // Tell runtime system how many output items we produced.
         return noutput_items;
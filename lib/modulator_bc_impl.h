@@ -22,6 +22,7 @@
 #define INCLUDED_DVBT2_MODULATOR_BC_IMPL_H
 
 #include <dvbt2/modulator_bc.h>
+#include "cell_kernels.h"
 
 namespace gr {
   namespace dvbt2 {
@@ -36,6 +37,9 @@ namespace gr {
       gr_complex m_16qam[16];
       gr_complex m_64qam[64];
       gr_complex m_256qam[256];
+      const gr_complex *points;
+      int mask;
+      mapper_kernel_t mapper;
 
      public:
       modulator_bc_impl(dvbt2_framesize_t framesize, dvbt2_constellation_t constellation, dvbt2_rotation_t rotation);
@@ -48,6 +52,12 @@ namespace gr {
 		       gr_vector_int &ninput_items,
 		       gr_vector_const_void_star &input_items,
 		       gr_vector_void_star &output_items);
+
+      // general_work() without the scheduler, returns the input
+      // items consumed. Used by gateway_bc.
+      int process(int noutput_items,
+		  gr_vector_const_void_star &input_items,
+		  gr_vector_void_star &output_items);
     };
 
   } // namespace dvbt2
@@ -0,0 +1,174 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "outputconditioner_c_impl.h"
+#include <volk/volk.h>
+#include <stdio.h>
+#include <new>
+#include <string.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    outputconditioner_c::sptr
+    outputconditioner_c::make(float gain, dvbt2_clipping_t clipping, float cliplevel, dvbt2_outputformat_t format)
+    {
+      return gnuradio::get_initial_sptr
+        (new outputconditioner_c_impl(gain, clipping, cliplevel, format));
+    }
+
+    static int
+    output_size(dvbt2_outputformat_t format)
+    {
+        switch (format)
+        {
+            case gr::dvbt2::OUTPUT_SC16:
+                return sizeof(int16_t) * 2;
+            case gr::dvbt2::OUTPUT_SC8:
+                return sizeof(int8_t) * 2;
+            default:
+                return sizeof(gr_complex);
+        }
+    }
+
+    static std::vector<int>
+    output_sizes(dvbt2_outputformat_t format)
+    {
+        std::vector<int> sizes;
+        sizes.push_back(output_size(format));
+        sizes.push_back(sizeof(gr_complex));
+        return sizes;
+    }
+
+    /*
+     * The private constructor
+     */
+    outputconditioner_c_impl::outputconditioner_c_impl(float gain, dvbt2_clipping_t clipping, float cliplevel, dvbt2_outputformat_t format)
+      : gr::sync_block("outputconditioner_c",
+              gr::io_signature::make(1, 1, sizeof(gr_complex)),
+              gr::io_signature::makev(1, 2, output_sizes(format)))
+    {
+        d_gain = gain;
+        clip_mode = clipping;
+        clip_level = cliplevel;
+        output_format = format;
+        clipped_count = 0;
+        sample_count = 0;
+        conditioned = (gr_complex*) volk_malloc(sizeof(gr_complex) * CHUNK_SIZE, volk_get_alignment());
+        if (conditioned == NULL)
+        {
+            fprintf(stderr, "Output conditioner 1st volk_malloc, Out of memory.\n");
+            throw std::bad_alloc();
+        }
+        perf_attach(this);
+    }
+
+    /*
+     * Our virtual destructor.
+     */
+    outputconditioner_c_impl::~outputconditioner_c_impl()
+    {
+        volk_free(conditioned);
+    }
+
+void outputconditioner_c_impl::clip(float *x, int length)
+{
+    const float level = clip_level;
+    int count = 0;
+
+    // Branch free so the compiler can vectorize it.
+    for (int n = 0; n < length; n++)
+    {
+        count += (x[n] > level) + (x[n] < -level);
+        x[n] = x[n] > level ? level : x[n];
+        x[n] = x[n] < -level ? -level : x[n];
+    }
+    __atomic_fetch_add(&clipped_count, (uint64_t)count, __ATOMIC_RELAXED);
+}
+
+    int
+    outputconditioner_c_impl::work(int noutput_items,
+			  gr_vector_const_void_star &input_items,
+			  gr_vector_void_star &output_items)
+    {
+        const gr_complex *in = (const gr_complex *) input_items[0];
+        gr_complex *outf = (gr_complex *) output_items[0];
+        int16_t *out16 = (int16_t *) output_items[0];
+        int8_t *out8 = (int8_t *) output_items[0];
+        gr_complex *outc = output_items.size() > 1 ? (gr_complex *) output_items[1] : NULL;
+        gr_complex *dst;
+        gr_complex scale;
+        int length;
+
+        perf_begin();
+
+        scale.real() = d_gain;
+        scale.imag() = 0.0;
+        // Work through the input in cache sized chunks, so that the
+        // gain, clipping and conversion passes hit the same lines.
+        for (int i = 0; i < noutput_items; i += CHUNK_SIZE)
+        {
+            length = noutput_items - i;
+            if (length > CHUNK_SIZE)
+            {
+                length = CHUNK_SIZE;
+            }
+            if (output_format == gr::dvbt2::OUTPUT_FC32)
+            {
+                dst = &outf[i];
+            }
+            else
+            {
+                dst = conditioned;
+            }
+            volk_32fc_s32fc_multiply_32fc(dst, &in[i], scale, length);
+            if (clip_mode == gr::dvbt2::CLIPPING_ON)
+            {
+                clip((float *) dst, length * 2);
+            }
+            if (output_format == gr::dvbt2::OUTPUT_SC16)
+            {
+                volk_32f_s32f_convert_16i(&out16[i * 2], (const float *) dst, 32767.0, length * 2);
+            }
+            else if (output_format == gr::dvbt2::OUTPUT_SC8)
+            {
+                volk_32f_s32f_convert_8i(&out8[i * 2], (const float *) dst, 127.0, length * 2);
+            }
+            if (outc != NULL)
+            {
+                memcpy(&outc[i], dst, sizeof(gr_complex) * length);
+            }
+        }
+        __atomic_fetch_add(&sample_count, (uint64_t)noutput_items * 2, __ATOMIC_RELAXED);
+
+        perf_end(noutput_items);
+
+        // Tell runtime system how many output items we produced.
+        return noutput_items;
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
@@ -0,0 +1,63 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_DVBT2_OUTPUTCONDITIONER_C_IMPL_H
+#define INCLUDED_DVBT2_OUTPUTCONDITIONER_C_IMPL_H
+
+#include <dvbt2/outputconditioner_c.h>
+
+#define CHUNK_SIZE 8192
+
+namespace gr {
+  namespace dvbt2 {
+
+    class outputconditioner_c_impl : public outputconditioner_c
+    {
+     private:
+      float d_gain;
+      int clip_mode;
+      float clip_level;
+      int output_format;
+      // Written by work(), read from any thread
+      uint64_t clipped_count;
+      uint64_t sample_count;
+      gr_complex *conditioned;
+      void clip(float *, int);
+
+     public:
+      outputconditioner_c_impl(float gain, dvbt2_clipping_t clipping, float cliplevel, dvbt2_outputformat_t format);
+      ~outputconditioner_c_impl();
+
+      void set_gain(float gain) { d_gain = gain; }
+      float gain() const { return d_gain; }
+      uint64_t clipped_samples() const { return __atomic_load_n(&clipped_count, __ATOMIC_RELAXED); }
+      uint64_t total_samples() const { return __atomic_load_n(&sample_count, __ATOMIC_RELAXED); }
+
+      // Where all the action really happens
+      int work(int noutput_items,
+	       gr_vector_const_void_star &input_items,
+	       gr_vector_void_star &output_items);
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_OUTPUTCONDITIONER_C_IMPL_H */
+
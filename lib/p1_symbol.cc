@@ -0,0 +1,228 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "p1_symbol.h"
+#include <gnuradio/fft/fft.h>
+#include <string.h>
+#include <math.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    static const int p1_active_carriers[384] = 
+    {
+        44, 45, 47, 51, 54, 59, 62, 64, 65, 66, 70, 75, 78, 80, 81, 82, 84, 85, 87, 88, 89, 90,
+        94, 96, 97, 98, 102, 107, 110, 112, 113, 114, 116, 117, 119, 120, 121, 122, 124,
+        125, 127, 131, 132, 133, 135, 136, 137, 138, 142, 144, 145, 146, 148, 149, 151,
+        152, 153, 154, 158, 160, 161, 162, 166, 171,
+
+        172, 173, 175, 179, 182, 187, 190, 192, 193, 194, 198, 203, 206, 208, 209, 210,
+        212, 213, 215, 216, 217, 218, 222, 224, 225, 226, 230, 235, 238, 240, 241, 242,
+        244, 245, 247, 248, 249, 250, 252, 253, 255, 259, 260, 261, 263, 264, 265, 266,
+        270, 272, 273, 274, 276, 277, 279, 280, 281, 282, 286, 288, 289, 290, 294, 299,
+        300, 301, 303, 307, 310, 315, 318, 320, 321, 322, 326, 331, 334, 336, 337, 338,
+        340, 341, 343, 344, 345, 346, 350, 352, 353, 354, 358, 363, 364, 365, 367, 371,
+        374, 379, 382, 384, 385, 386, 390, 395, 396, 397, 399, 403, 406, 411, 412, 413,
+        415, 419, 420, 421, 423, 424, 425, 426, 428, 429, 431, 435, 438, 443, 446, 448,
+        449, 450, 454, 459, 462, 464, 465, 466, 468, 469, 471, 472, 473, 474, 478, 480,
+        481, 482, 486, 491, 494, 496, 497, 498, 500, 501, 503, 504, 505, 506, 508, 509,
+        511, 515, 516, 517, 519, 520, 521, 522, 526, 528, 529, 530, 532, 533, 535, 536,
+        537, 538, 542, 544, 545, 546, 550, 555, 558, 560, 561, 562, 564, 565, 567, 568,
+        569, 570, 572, 573, 575, 579, 580, 581, 583, 584, 585, 586, 588, 589, 591, 595,
+        598, 603, 604, 605, 607, 611, 612, 613, 615, 616, 617, 618, 622, 624, 625, 626,
+        628, 629, 631, 632, 633, 634, 636, 637, 639, 643, 644, 645, 647, 648, 649, 650,
+        654, 656, 657, 658, 660, 661, 663, 664, 665, 666, 670, 672, 673, 674, 678, 683,
+
+        684, 689, 692, 696, 698, 699, 701, 702, 703, 704, 706, 707, 708,
+        712, 714, 715, 717, 718, 719, 720, 722, 723, 725, 726, 727, 729,
+        733, 734, 735, 736, 738, 739, 740, 744, 746, 747, 748, 753, 756,
+        760, 762, 763, 765, 766, 767, 768, 770, 771, 772, 776, 778, 779,
+        780, 785, 788, 792, 794, 795, 796, 801, 805, 806, 807, 809
+    };
+
+    static const unsigned char s1_modulation_patterns[8][8] = 
+    {
+        {0x12, 0x47, 0x21, 0x74, 0x1D, 0x48, 0x2E, 0x7B},
+        {0x47, 0x12, 0x74, 0x21, 0x48, 0x1D, 0x7B, 0x2E},
+        {0x21, 0x74, 0x12, 0x47, 0x2E, 0x7B, 0x1D, 0x48},
+        {0x74, 0x21, 0x47, 0x12, 0x7B, 0x2E, 0x48, 0x1D},
+        {0x1D, 0x48, 0x2E, 0x7B, 0x12, 0x47, 0x21, 0x74},
+        {0x48, 0x1D, 0x7B, 0x2E, 0x47, 0x12, 0x74, 0x21},
+        {0x2E, 0x7B, 0x1D, 0x48, 0x21, 0x74, 0x12, 0x47},
+        {0x7B, 0x2E, 0x48, 0x1D, 0x74, 0x21, 0x47, 0x12}
+    };
+
+    static const unsigned char s2_modulation_patterns[16][32] = 
+    {
+        {0x12, 0x1D, 0x47, 0x48, 0x21, 0x2E, 0x74, 0x7B, 0x1D, 0x12, 0x48, 0x47, 0x2E, 0x21, 0x7B, 0x74,
+         0x12, 0xE2, 0x47, 0xB7, 0x21, 0xD1, 0x74, 0x84, 0x1D, 0xED, 0x48, 0xB8, 0x2E, 0xDE, 0x7B, 0x8B},
+        {0x47, 0x48, 0x12, 0x1D, 0x74, 0x7B, 0x21, 0x2E, 0x48, 0x47, 0x1D, 0x12, 0x7B, 0x74, 0x2E, 0x21,
+         0x47, 0xB7, 0x12, 0xE2, 0x74, 0x84, 0x21, 0xD1, 0x48, 0xB8, 0x1D, 0xED, 0x7B, 0x8B, 0x2E, 0xDE},
+        {0x21, 0x2E, 0x74, 0x7B, 0x12, 0x1D, 0x47, 0x48, 0x2E, 0x21, 0x7B, 0x74, 0x1D, 0x12, 0x48, 0x47,
+         0x21, 0xD1, 0x74, 0x84, 0x12, 0xE2, 0x47, 0xB7, 0x2E, 0xDE, 0x7B, 0x8B, 0x1D, 0xED, 0x48, 0xB8},
+        {0x74, 0x7B, 0x21, 0x2E, 0x47, 0x48, 0x12, 0x1D, 0x7B, 0x74, 0x2E, 0x21, 0x48, 0x47, 0x1D, 0x12,
+         0x74, 0x84, 0x21, 0xD1, 0x47, 0xB7, 0x12, 0xE2, 0x7B, 0x8B, 0x2E, 0xDE, 0x48, 0xB8, 0x1D, 0xED},
+        {0x1D, 0x12, 0x48, 0x47, 0x2E, 0x21, 0x7B, 0x74, 0x12, 0x1D, 0x47, 0x48, 0x21, 0x2E, 0x74, 0x7B,
+         0x1D, 0xED, 0x48, 0xB8, 0x2E, 0xDE, 0x7B, 0x8B, 0x12, 0xE2, 0x47, 0xB7, 0x21, 0xD1, 0x74, 0x84},
+        {0x48, 0x47, 0x1D, 0x12, 0x7B, 0x74, 0x2E, 0x21, 0x47, 0x48, 0x12, 0x1D, 0x74, 0x7B, 0x21, 0x2E,
+         0x48, 0xB8, 0x1D, 0xED, 0x7B, 0x8B, 0x2E, 0xDE, 0x47, 0xB7, 0x12, 0xE2, 0x74, 0x84, 0x21, 0xD1},
+        {0x2E, 0x21, 0x7B, 0x74, 0x1D, 0x12, 0x48, 0x47, 0x21, 0x2E, 0x74, 0x7B, 0x12, 0x1D, 0x47, 0x48,
+         0x2E, 0xDE, 0x7B, 0x8B, 0x1D, 0xED, 0x48, 0xB8, 0x21, 0xD1, 0x74, 0x84, 0x12, 0xE2, 0x47, 0xB7},
+        {0x7B, 0x74, 0x2E, 0x21, 0x48, 0x47, 0x1D, 0x12, 0x74, 0x7B, 0x21, 0x2E, 0x47, 0x48, 0x12, 0x1D,
+         0x7B, 0x8B, 0x2E, 0xDE, 0x48, 0xB8, 0x1D, 0xED, 0x74, 0x84, 0x21, 0xD1, 0x47, 0xB7, 0x12, 0xE2},
+        {0x12, 0xE2, 0x47, 0xB7, 0x21, 0xD1, 0x74, 0x84, 0x1D, 0xED, 0x48, 0xB8, 0x2E, 0xDE, 0x7B, 0x8B,
+         0x12, 0x1D, 0x47, 0x48, 0x21, 0x2E, 0x74, 0x7B, 0x1D, 0x12, 0x48, 0x47, 0x2E, 0x21, 0x7B, 0x74},
+        {0x47, 0xB7, 0x12, 0xE2, 0x74, 0x84, 0x21, 0xD1, 0x48, 0xB8, 0x1D, 0xED, 0x7B, 0x8B, 0x2E, 0xDE,
+         0x47, 0x48, 0x12, 0x1D, 0x74, 0x7B, 0x21, 0x2E, 0x48, 0x47, 0x1D, 0x12, 0x7B, 0x74, 0x2E, 0x21},
+        {0x21, 0xD1, 0x74, 0x84, 0x12, 0xE2, 0x47, 0xB7, 0x2E, 0xDE, 0x7B, 0x8B, 0x1D, 0xED, 0x48, 0xB8,
+         0x21, 0x2E, 0x74, 0x7B, 0x12, 0x1D, 0x47, 0x48, 0x2E, 0x21, 0x7B, 0x74, 0x1D, 0x12, 0x48, 0x47},
+        {0x74, 0x84, 0x21, 0xD1, 0x47, 0xB7, 0x12, 0xE2, 0x7B, 0x8B, 0x2E, 0xDE, 0x48, 0xB8, 0x1D, 0xED,
+         0x74, 0x7B, 0x21, 0x2E, 0x47, 0x48, 0x12, 0x1D, 0x7B, 0x74, 0x2E, 0x21, 0x48, 0x47, 0x1D, 0x12},
+        {0x1D, 0xED, 0x48, 0xB8, 0x2E, 0xDE, 0x7B, 0x8B, 0x12, 0xE2, 0x47, 0xB7, 0x21, 0xD1, 0x74, 0x84,
+         0x1D, 0x12, 0x48, 0x47, 0x2E, 0x21, 0x7B, 0x74, 0x12, 0x1D, 0x47, 0x48, 0x21, 0x2E, 0x74, 0x7B},
+        {0x48, 0xB8, 0x1D, 0xED, 0x7B, 0x8B, 0x2E, 0xDE, 0x47, 0xB7, 0x12, 0xE2, 0x74, 0x84, 0x21, 0xD1,
+         0x48, 0x47, 0x1D, 0x12, 0x7B, 0x74, 0x2E, 0x21, 0x47, 0x48, 0x12, 0x1D, 0x74, 0x7B, 0x21, 0x2E},
+        {0x2E, 0xDE, 0x7B, 0x8B, 0x1D, 0xED, 0x48, 0xB8, 0x21, 0xD1, 0x74, 0x84, 0x12, 0xE2, 0x47, 0xB7,
+         0x2E, 0x21, 0x7B, 0x74, 0x1D, 0x12, 0x48, 0x47, 0x21, 0x2E, 0x74, 0x7B, 0x12, 0x1D, 0x47, 0x48},
+        {0x7B, 0x8B, 0x2E, 0xDE, 0x48, 0xB8, 0x1D, 0xED, 0x74, 0x84, 0x21, 0xD1, 0x47, 0xB7, 0x12, 0xE2,
+         0x7B, 0x74, 0x2E, 0x21, 0x48, 0x47, 0x1D, 0x12, 0x74, 0x7B, 0x21, 0x2E, 0x47, 0x48, 0x12, 0x1D}
+    };
+
+static void init_p1_randomizer(int *p1_randomize)
+{
+    int sr = 0x4e46;
+    for (int i = 0; i < 384; i++)
+    {
+        int b = ((sr) ^ (sr >> 1)) & 1;
+        if (b == 0)
+        {
+           p1_randomize[i] = 1;
+        }
+        else
+        {
+           p1_randomize[i] = -1;
+        }
+        sr >>= 1;
+        if(b) sr |= 0x4000;
+    }
+}
+
+// The inverse FFT of one set of P1 carriers, normalised by the number
+// of active carriers.
+static void p1_transform(fft::fft_complex *p1_fft, const gr_complex *in, gr_complex *out)
+{
+    int p1_fft_size = 1024;
+    gr_complex *dst = p1_fft->get_inbuf();
+    memcpy(&dst[p1_fft_size / 2], &in[0], sizeof(gr_complex) * p1_fft_size / 2);
+    memcpy(&dst[0], &in[p1_fft_size / 2], sizeof(gr_complex) * p1_fft_size / 2);
+    p1_fft->execute();
+    memcpy(out, p1_fft->get_outbuf(), sizeof(gr_complex) * p1_fft_size);
+    for (int i = 0; i < 1024; i++)
+    {
+        out[i].real() *= 1 / sqrt(384);
+        out[i].imag() *= 1 / sqrt(384);
+    }
+}
+
+void p1_symbol(dvbt2_fftsize_t fftsize, dvbt2_preamble_t preamble, gr_complex *p1_time, gr_complex *p1_timeshft)
+{
+    int s1, s2, index = 0;
+    int fef_present = FALSE;    /* for testing only */
+    int p1_randomize[384];
+    int modulation_sequence[384];
+    int dbpsk_modulation_sequence[385];
+    gr_complex p1_freq[1024];
+    gr_complex p1_freqshft[1024];
+    fft::fft_complex *p1_fft;
+
+    s1 = preamble;
+    init_p1_randomizer(p1_randomize);
+    s2 = (fftsize & 0x7) << 1;
+    if (fef_present == TRUE)
+    {
+        s2 |= 1;
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        for (int j = 7; j >= 0; j--)
+        {
+            modulation_sequence[index++] = (s1_modulation_patterns[s1][i] >> j) & 0x1;
+        }
+    }
+    for (int i = 0; i < 32; i++)
+    {
+        for (int j = 7; j >= 0; j--)
+        {
+            modulation_sequence[index++] = (s2_modulation_patterns[s2][i] >> j) & 0x1;
+        }
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        for (int j = 7; j >= 0; j--)
+        {
+            modulation_sequence[index++] = (s1_modulation_patterns[s1][i] >> j) & 0x1;
+        }
+    }
+    dbpsk_modulation_sequence[0] = 1;
+    for (int i = 1; i < 385; i++)
+    {
+        dbpsk_modulation_sequence[i] = 0;
+    }
+    for (int i = 1; i < 385; i++)
+    {
+        if (modulation_sequence[i - 1] == 1)
+        {
+            dbpsk_modulation_sequence[i] = -dbpsk_modulation_sequence[i - 1];
+        }
+        else
+        {
+            dbpsk_modulation_sequence[i] = dbpsk_modulation_sequence[i - 1];
+        }
+    }
+    for (int i = 0; i < 384; i++)
+    {
+        dbpsk_modulation_sequence[i] = dbpsk_modulation_sequence[i + 1] * p1_randomize[i];
+    }
+    for (int i = 0; i < 1024; i++)
+    {
+        p1_freq[i].real() = 0.0;
+        p1_freq[i].imag() = 0.0;
+    }
+    for (int i = 0; i < 384; i++)
+    {
+        p1_freq[p1_active_carriers[i] + 86].real() = float(dbpsk_modulation_sequence[i]);
+    }
+    for (int i = 0; i < 1023; i++)
+    {
+        p1_freqshft[i + 1] = p1_freq[i];
+    }
+    p1_freqshft[0] = p1_freq[1023];
+    p1_fft = new fft::fft_complex(1024, false, 1);
+    p1_transform(p1_fft, p1_freq, p1_time);
+    p1_transform(p1_fft, p1_freqshft, p1_timeshft);
+    delete p1_fft;
+}
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
@@ -0,0 +1,42 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_DVBT2_P1_SYMBOL_H
+#define INCLUDED_DVBT2_P1_SYMBOL_H
+
+#include <gnuradio/gr_complex.h>
+#include <dvbt2/dvbt2_config.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * The P1 symbol (EN 302 755 section 7.2.1) that p1insertion_cc and
+     * gi_p1_insertion_cc insert. The S1 and S2 signalling, DBPSK
+     * modulated and scrambled, is put on the 384 active carriers of a
+     * 1K IFFT. p1_time gets the normalised symbol and p1_timeshft the
+     * same symbol shifted up by one carrier, for the C-A-B structure.
+     */
+    void p1_symbol(dvbt2_fftsize_t fftsize, dvbt2_preamble_t preamble, gr_complex *p1_time, gr_complex *p1_timeshft);
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_P1_SYMBOL_H */
@@ -22,7 +22,8 @@
 #define INCLUDED_DVBT2_P1INSERTION_CC_IMPL_H
 
 #include <dvbt2/p1insertion_cc.h>
-#include <gnuradio/fft/fft.h>
+
+#define LEVEL_CHUNK 8192
 
 namespace gr {
   namespace dvbt2 {
@@ -35,40 +36,35 @@ namespace gr {
       int frame_items;
       int insertion_items;
       int N_P2;
-      int p1_randomize[384];
-      int modulation_sequence[384];
-      int dbpsk_modulation_sequence[385];
-      gr_complex p1_freq[1024];
-      gr_complex p1_freqshft[1024];
       gr_complex p1_time[1024];
       gr_complex p1_timeshft[1024];
-      void init_p1_randomizer(void);
 
       int show_levels;
       float real_positive;
       float real_negative;
       float imag_positive;
       float imag_negative;
-      float real_positive_threshold;
-      float real_negative_threshold;
-      float imag_positive_threshold;
-      float imag_negative_threshold;
-      int real_positive_threshold_count;
-      int real_negative_threshold_count;
-      int imag_positive_threshold_count;
-      int imag_negative_threshold_count;
-
-      fft::fft_complex *p1_fft;
-      int p1_fft_size;
-
-      const static int p1_active_carriers[384];
-      const static unsigned char s1_modulation_patterns[8][8];
-      const static unsigned char s2_modulation_patterns[16][32];
+      float level_threshold;
+      uint64_t threshold_count[4];
+      float *level_max;
+      float *level_min;
+      void measure_levels(const gr_complex *, int);
+      void publish_levels(void);
 
      public:
       p1insertion_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_preamble_t preamble, dvbt2_showlevels_t showlevels, float vclip);
       ~p1insertion_cc_impl();
 
+      float real_positive_peak() const;
+      float real_negative_peak() const;
+      float imag_positive_peak() const;
+      float imag_negative_peak() const;
+      uint64_t real_positive_threshold_count() const;
+      uint64_t real_negative_threshold_count() const;
+      uint64_t imag_positive_threshold_count() const;
+      uint64_t imag_negative_threshold_count() const;
+      void reset_levels();
+
       // Where all the action really happens
       void forecast (int noutput_items, gr_vector_int &ninput_items_required);
 
@@ -0,0 +1,154 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "papr_kernels.h"
+#ifdef DVBT2_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace gr {
+  namespace dvbt2 {
+
+void tr_generic(gr_complex *signal, const gr_complex *kernel, gr_complex scale, int length)
+{
+    float *s = (float *) signal;
+    const float *k = (const float *) kernel;
+    const float sr = scale.real();
+    const float si = scale.imag();
+
+    for (int n = 0; n < length * 2; n += 2)
+    {
+        s[n] -= (k[n] * sr) - (k[n + 1] * si);
+        s[n + 1] -= (k[n] * si) + (k[n + 1] * sr);
+    }
+}
+
+// With k = (a, b), the update is (a * sr, a * si) -+ (b * si, b * sr),
+// the same products and sums in the same operand order as the generic
+// variant, which also keeps the sign and payload of NaNs.
+#ifdef DVBT2_KERNELS_X86
+void tr_sse2(gr_complex *signal, const gr_complex *kernel, gr_complex scale, int length)
+{
+    float *s = (float *) signal;
+    const float *k = (const float *) kernel;
+    const __m128 sc = _mm_setr_ps(scale.real(), scale.imag(), scale.real(), scale.imag());
+    const __m128 sw = _mm_setr_ps(scale.imag(), scale.real(), scale.imag(), scale.real());
+    const __m128 even = _mm_castsi128_ps(_mm_setr_epi32(-1, 0, -1, 0));
+    __m128 x, a, b;
+    int n;
+
+    for (n = 0; n + 2 <= length; n += 2)
+    {
+        x = _mm_loadu_ps(&k[n * 2]);
+        a = _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0)), sc);
+        b = _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1)), sw);
+        x = _mm_or_ps(_mm_and_ps(even, _mm_sub_ps(a, b)), _mm_andnot_ps(even, _mm_add_ps(a, b)));
+        _mm_storeu_ps(&s[n * 2], _mm_sub_ps(_mm_loadu_ps(&s[n * 2]), x));
+    }
+    tr_generic(&signal[n], &kernel[n], scale, length - n);
+}
+
+__attribute__((target("avx")))
+void tr_avx(gr_complex *signal, const gr_complex *kernel, gr_complex scale, int length)
+{
+    float *s = (float *) signal;
+    const float *k = (const float *) kernel;
+    const __m256 sc = _mm256_setr_ps(scale.real(), scale.imag(), scale.real(), scale.imag(), scale.real(), scale.imag(), scale.real(), scale.imag());
+    const __m256 sw = _mm256_setr_ps(scale.imag(), scale.real(), scale.imag(), scale.real(), scale.imag(), scale.real(), scale.imag(), scale.real());
+    __m256 x, a, b;
+    int n;
+
+    for (n = 0; n + 4 <= length; n += 4)
+    {
+        x = _mm256_loadu_ps(&k[n * 2]);
+        a = _mm256_mul_ps(_mm256_moveldup_ps(x), sc);
+        b = _mm256_mul_ps(_mm256_movehdup_ps(x), sw);
+        _mm256_storeu_ps(&s[n * 2], _mm256_sub_ps(_mm256_loadu_ps(&s[n * 2]), _mm256_addsub_ps(a, b)));
+    }
+    tr_sse2(&signal[n], &kernel[n], scale, length - n);
+}
+
+__attribute__((target("avx512f")))
+void tr_avx512(gr_complex *signal, const gr_complex *kernel, gr_complex scale, int length)
+{
+    float *s = (float *) signal;
+    const float *k = (const float *) kernel;
+    const __m512 sc = _mm512_set4_ps(scale.imag(), scale.real(), scale.imag(), scale.real());
+    const __m512 sw = _mm512_set4_ps(scale.real(), scale.imag(), scale.real(), scale.imag());
+    __m512 x, a, b;
+    int n;
+
+    for (n = 0; n + 8 <= length; n += 8)
+    {
+        x = _mm512_loadu_ps(&k[n * 2]);
+        a = _mm512_mul_ps(_mm512_maskz_moveldup_ps(0xffff, x), sc);
+        b = _mm512_mul_ps(_mm512_maskz_movehdup_ps(0xffff, x), sw);
+        x = _mm512_mask_sub_ps(_mm512_add_ps(a, b), 0x5555, a, b);
+        _mm512_storeu_ps(&s[n * 2], _mm512_sub_ps(_mm512_loadu_ps(&s[n * 2]), x));
+    }
+    tr_avx(&signal[n], &kernel[n], scale, length - n);
+}
+#endif
+
+int tr_kernels(tr_impl *list)
+{
+    int count = 0;
+
+    list[count].name = "generic";
+    list[count].arch = ARCH_GENERIC;
+    list[count++].kernel = tr_generic;
+#ifdef DVBT2_KERNELS_X86
+    if (kernel_arch_supported(ARCH_SSE2))
+    {
+        list[count].name = "sse2";
+        list[count].arch = ARCH_SSE2;
+        list[count++].kernel = tr_sse2;
+    }
+    if (kernel_arch_supported(ARCH_AVX))
+    {
+        list[count].name = "avx";
+        list[count].arch = ARCH_AVX;
+        list[count++].kernel = tr_avx;
+    }
+    if (kernel_arch_supported(ARCH_AVX512))
+    {
+        list[count].name = "avx512";
+        list[count].arch = ARCH_AVX512;
+        list[count++].kernel = tr_avx512;
+    }
+#endif
+    return count;
+}
+
+tr_kernel_t tr_select(void)
+{
+    tr_impl list[MAX_PAPR_KERNELS];
+    int count = tr_kernels(list);
+
+    return kernel_choose(list, count).kernel;
+}
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
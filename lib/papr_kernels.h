@@ -0,0 +1,64 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_DVBT2_PAPR_KERNELS_H
+#define INCLUDED_DVBT2_PAPR_KERNELS_H
+
+#include <gnuradio/gr_complex.h>
+#include "kernel_dispatch.h"
+
+#define MAX_PAPR_KERNELS 4
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * Tone reservation update, signal[n] -= kernel[n] * scale for
+     * length samples, with the products and sums in the order of the
+     * generic variant so that all variants give bit identical output.
+     * papr_kernels.cc is built without floating point contraction.
+     */
+    typedef void (*tr_kernel_t)(gr_complex *signal, const gr_complex *kernel, gr_complex scale, int length);
+
+    struct tr_impl
+    {
+      const char *name;
+      kernel_arch_t arch;
+      tr_kernel_t kernel;
+    };
+
+    void tr_generic(gr_complex *signal, const gr_complex *kernel, gr_complex scale, int length);
+#ifdef DVBT2_KERNELS_X86
+    void tr_sse2(gr_complex *signal, const gr_complex *kernel, gr_complex scale, int length);
+    void tr_avx(gr_complex *signal, const gr_complex *kernel, gr_complex scale, int length);
+    void tr_avx512(gr_complex *signal, const gr_complex *kernel, gr_complex scale, int length);
+#endif
+
+    //! Fill list with the variants this CPU can run, generic first, and return the count.
+    int tr_kernels(tr_impl *list);
+
+    //! The fastest variant this CPU can run, see kernel_choose().
+    tr_kernel_t tr_select(void);
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_PAPR_KERNELS_H */
@@ -24,24 +24,27 @@
 
 #include <gnuradio/io_signature.h>
 #include "paprtr_cc_impl.h"
+#include <dvbt2/t2_geometry.h>
+#include <boost/bind.hpp>
 #include <complex.h>
 #include <volk/volk.h>
 #include <stdio.h>
+#include <new>
 
 namespace gr {
   namespace dvbt2 {
 
     paprtr_cc::sptr
-    paprtr_cc::make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, float vclip, int iterations, int vlength)
+    paprtr_cc::make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, float vclip, int iterations, int vlength, int peaks, int separation, float tolerance, float budget, int oversampling, int nthreads)
     {
       return gnuradio::get_initial_sptr
-        (new paprtr_cc_impl(carriermode, fftsize, pilotpattern, guardinterval, numdatasyms, paprmode, version, vclip, iterations, vlength));
+        (new paprtr_cc_impl(carriermode, fftsize, pilotpattern, guardinterval, numdatasyms, paprmode, version, vclip, iterations, vlength, peaks, separation, tolerance, budget, oversampling, nthreads));
     }
 
     /*
      * The private constructor
      */
-    paprtr_cc_impl::paprtr_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, float vclip, int iterations, int vlength)
+    paprtr_cc_impl::paprtr_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, float vclip, int iterations, int vlength, int peaks, int separation, float tolerance, float budget, int oversampling, int nthreads)
       : gr::sync_block("paprtr_cc",
               gr::io_signature::make(1, 1, sizeof(gr_complex) * vlength),
               gr::io_signature::make(1, 1, sizeof(gr_complex) * vlength))
@@ -49,23 +52,19 @@ namespace gr {
         switch (fftsize)
         {
             case gr::dvbt2::FFTSIZE_1K:
-                N_P2 = 16;
                 C_PS = 853;
                 K_EXT = 0;
                 break;
             case gr::dvbt2::FFTSIZE_2K:
-                N_P2 = 8;
                 C_PS = 1705;
                 K_EXT = 0;
                 break;
             case gr::dvbt2::FFTSIZE_4K:
-                N_P2 = 4;
                 C_PS = 3409;
                 K_EXT = 0;
                 break;
             case gr::dvbt2::FFTSIZE_8K:
             case gr::dvbt2::FFTSIZE_8K_T2GI:
-                N_P2 = 2;
                 if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
                 {
                     C_PS = 6817;
@@ -79,7 +78,6 @@ namespace gr {
                 break;
             case gr::dvbt2::FFTSIZE_16K:
             case gr::dvbt2::FFTSIZE_16K_T2GI:
-                N_P2 = 1;
                 if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
                 {
                     C_PS = 13633;
@@ -93,7 +91,6 @@ namespace gr {
                 break;
             case gr::dvbt2::FFTSIZE_32K:
             case gr::dvbt2::FFTSIZE_32K_T2GI:
-                N_P2 = 1;
                 if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
                 {
                     C_PS = 27265;
@@ -106,343 +103,10 @@ namespace gr {
                 }
                 break;
         }
-        switch (fftsize)
-        {
-            case gr::dvbt2::FFTSIZE_1K:
-                switch (pilotpattern)
-                {
-                    case gr::dvbt2::PILOT_PP1:
-                        N_FC = 568;
-                        break;
-                    case gr::dvbt2::PILOT_PP2:
-                        N_FC = 710;
-                        break;
-                    case gr::dvbt2::PILOT_PP3:
-                        N_FC = 710;
-                        break;
-                    case gr::dvbt2::PILOT_PP4:
-                        N_FC = 780;
-                        break;
-                    case gr::dvbt2::PILOT_PP5:
-                        N_FC = 780;
-                        break;
-                    case gr::dvbt2::PILOT_PP6:
-                        N_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP7:
-                        N_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP8:
-                        N_FC = 0;
-                        break;
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 10;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_2K:
-                switch (pilotpattern)
-                {
-                    case gr::dvbt2::PILOT_PP1:
-                        N_FC = 1136;
-                        break;
-                    case gr::dvbt2::PILOT_PP2:
-                        N_FC = 1420;
-                        break;
-                    case gr::dvbt2::PILOT_PP3:
-                        N_FC = 1420;
-                        break;
-                    case gr::dvbt2::PILOT_PP4:
-                        N_FC = 1562;
-                        break;
-                    case gr::dvbt2::PILOT_PP5:
-                        N_FC = 1562;
-                        break;
-                    case gr::dvbt2::PILOT_PP6:
-                        N_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP7:
-                        N_FC = 1632;
-                        break;
-                    case gr::dvbt2::PILOT_PP8:
-                        N_FC = 0;
-                        break;
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 18;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_4K:
-                switch (pilotpattern)
-                {
-                    case gr::dvbt2::PILOT_PP1:
-                        N_FC = 2272;
-                        break;
-                    case gr::dvbt2::PILOT_PP2:
-                        N_FC = 2840;
-                        break;
-                    case gr::dvbt2::PILOT_PP3:
-                        N_FC = 2840;
-                        break;
-                    case gr::dvbt2::PILOT_PP4:
-                        N_FC = 3124;
-                        break;
-                    case gr::dvbt2::PILOT_PP5:
-                        N_FC = 3124;
-                        break;
-                    case gr::dvbt2::PILOT_PP6:
-                        N_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP7:
-                        N_FC = 3266;
-                        break;
-                    case gr::dvbt2::PILOT_PP8:
-                        N_FC = 0;
-                        break;
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 36;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_8K:
-            case gr::dvbt2::FFTSIZE_8K_T2GI:
-                if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            N_FC = 4544;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            N_FC = 5680;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            N_FC = 5680;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            N_FC = 6248;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            N_FC = 6248;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            N_FC = 6532;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            N_FC = 0;
-                            break;
-                    }
-                }
-                else
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            N_FC = 4608;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            N_FC = 5760;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            N_FC = 5760;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            N_FC = 6336;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            N_FC = 6336;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            N_FC = 6624;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            N_FC = 0;
-                            break;
-                    }
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 72;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_16K:
-            case gr::dvbt2::FFTSIZE_16K_T2GI:
-                if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            N_FC = 9088;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            N_FC = 11360;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            N_FC = 11360;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            N_FC = 12496;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            N_FC = 12496;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            N_FC = 13064;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            N_FC = 13064;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            N_FC = 0;
-                            break;
-                    }
-                }
-                else
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            N_FC = 9280;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            N_FC = 11600;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            N_FC = 11600;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            N_FC = 12760;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            N_FC = 12760;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            N_FC = 13340;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            N_FC = 13340;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            N_FC = 0;
-                            break;
-                    }
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 144;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_32K:
-            case gr::dvbt2::FFTSIZE_32K_T2GI:
-                if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            N_FC = 22720;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            N_FC = 24992;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            N_FC = 26128;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            N_FC = 0;
-                            break;
-                    }
-                }
-                else
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            N_FC = 23200;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            N_FC = 25520;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            N_FC = 26680;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            N_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            N_FC = 0;
-                            break;
-                    }
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 288;
-                    }
-                }
-                break;
-        }
-        if (guardinterval == gr::dvbt2::GI_1_128 && pilotpattern == gr::dvbt2::PILOT_PP7)
-        {
-            N_FC = 0;
-        }
-        if (guardinterval == gr::dvbt2::GI_1_32 && pilotpattern == gr::dvbt2::PILOT_PP4)
-        {
-            N_FC = 0;
-        }
-        if (guardinterval == gr::dvbt2::GI_1_16 && pilotpattern == gr::dvbt2::PILOT_PP2)
-        {
-            N_FC = 0;
-        }
-        if (guardinterval == gr::dvbt2::GI_19_256 && pilotpattern == gr::dvbt2::PILOT_PP2)
-        {
-            N_FC = 0;
-        }
+        // No preamble parameter, the frame closing symbol is as in SISO.
+        t2_geometry geometry(carriermode, fftsize, pilotpattern, guardinterval, paprmode, gr::dvbt2::PREAMBLE_T2_SISO);
+        N_P2 = geometry.N_P2;
+        N_FC = geometry.N_FC;
         for (int i = 0; i < C_PS; i++)
         {
             p2_carrier_map[i] = DATA_CARRIER;
@@ -558,102 +222,87 @@ namespace gr {
         {
             v_clip = 3.0;
             num_iterations = 1;
+            num_peaks = 1;
         }
         else
         {
             v_clip = vclip;
             num_iterations = iterations;
+            num_peaks = peaks;
         }
-        left_nulls = ((vlength - C_PS) / 2) + 1;
-        right_nulls = (vlength - C_PS) / 2;
-        papr_fft_size = vlength;
-        papr_fft = new fft::fft_complex(papr_fft_size, false, 1);
-        ones_freq = (gr_complex*) volk_malloc(sizeof(gr_complex) * papr_fft_size, volk_get_alignment());
-        if (ones_freq == NULL)
+        if (num_peaks < 1)
         {
-            fprintf(stderr, "Tone reservation PAPR 1st volk_malloc, Out of memory.\n");
-            delete papr_fft;
-            exit(1);
+            num_peaks = 1;
         }
-        ones_time = (gr_complex*) volk_malloc(sizeof(gr_complex) * papr_fft_size, volk_get_alignment());
-        if (ones_time == NULL)
+        if (num_peaks > MAX_PEAKS)
         {
-            fprintf(stderr, "Tone reservation PAPR 2nd volk_malloc, Out of memory.\n");
-            volk_free(ones_freq);
-            delete papr_fft;
-            exit(1);
+            num_peaks = MAX_PEAKS;
         }
-        c = (gr_complex*) volk_malloc(sizeof(gr_complex) * papr_fft_size, volk_get_alignment());
-        if (c == NULL)
+        if (oversampling < 1)
         {
-            fprintf(stderr, "Tone reservation PAPR 3rd volk_malloc, Out of memory.\n");
-            volk_free(ones_time);
-            volk_free(ones_freq);
-            delete papr_fft;
-            exit(1);
+            oversampling = 1;
         }
-        ctemp = (gr_complex*) volk_malloc(sizeof(gr_complex) * papr_fft_size, volk_get_alignment());
-        if (ctemp == NULL)
+        os_factor = oversampling;
+        peak_separation = separation * os_factor;
+        v_tolerance = tolerance;
+        center = (C_PS - 1) / 2;
+        aMax = 5.0 * N_TR * sqrt(10.0 / (27.0 * C_PS));
+        frame_budget = (high_res_timer_type)(budget * high_res_timer_tps() / 1000.0);
+        budget_debt = 0;
+        iteration_cost = 0.0;
+        memset(&stats, 0, sizeof(paprtr_stats));
+        stats_sequence = 0;
+        left_nulls = ((vlength - C_PS) / 2) + 1;
+        right_nulls = (vlength - C_PS) / 2;
+        papr_fft_size = vlength;
+        os_size = papr_fft_size * os_factor;
+        if (nthreads < 1)
         {
-            fprintf(stderr, "Tone reservation PAPR 4th volk_malloc, Out of memory.\n");
-            volk_free(c);
-            volk_free(ones_time);
-            volk_free(ones_freq);
-            delete papr_fft;
-            exit(1);
+            nthreads = 1;
         }
-        magnitude = (float*) volk_malloc(sizeof(float) * papr_fft_size, volk_get_alignment());
-        if (magnitude == NULL)
+        if (nthreads > MAX_THREADS)
         {
-            fprintf(stderr, "Tone reservation PAPR 5th volk_malloc, Out of memory.\n");
-            volk_free(ctemp);
-            volk_free(c);
-            volk_free(ones_time);
-            volk_free(ones_freq);
-            delete papr_fft;
-            exit(1);
+            nthreads = MAX_THREADS;
         }
-        r = (gr_complex*) volk_malloc(sizeof(gr_complex) * N_TR, volk_get_alignment());
-        if (r == NULL)
+        num_threads = nthreads;
+        ones_freq = (gr_complex*) volk_malloc(sizeof(gr_complex) * papr_fft_size, volk_get_alignment());
+        if (ones_freq == NULL)
         {
-            fprintf(stderr, "Tone reservation PAPR 6th volk_malloc, Out of memory.\n");
-            volk_free(magnitude);
-            volk_free(ctemp);
-            volk_free(c);
-            volk_free(ones_time);
-            volk_free(ones_freq);
-            delete papr_fft;
-            exit(1);
+            fprintf(stderr, "Tone reservation PAPR 1st volk_malloc, Out of memory.\n");
+            throw std::bad_alloc();
         }
-        rNew = (gr_complex*) volk_malloc(sizeof(gr_complex) * N_TR, volk_get_alignment());
-        if (rNew == NULL)
+        p2_kernel = (gr_complex*) volk_malloc(sizeof(gr_complex) * os_size * (dy + 2), volk_get_alignment());
+        if (p2_kernel == NULL)
         {
-            fprintf(stderr, "Tone reservation PAPR 7th volk_malloc, Out of memory.\n");
-            volk_free(r);
-            volk_free(magnitude);
-            volk_free(ctemp);
-            volk_free(c);
-            volk_free(ones_time);
+            fprintf(stderr, "Tone reservation PAPR 2nd volk_malloc, Out of memory.\n");
             volk_free(ones_freq);
-            delete papr_fft;
-            exit(1);
+            throw std::bad_alloc();
         }
-        v = (gr_complex*) volk_malloc(sizeof(gr_complex) * N_TR, volk_get_alignment());
-        if (v == NULL)
+        for (int i = 0; i < num_threads; i++)
         {
-            fprintf(stderr, "Tone reservation PAPR 8th volk_malloc, Out of memory.\n");
-            volk_free(rNew);
-            volk_free(r);
-            volk_free(magnitude);
-            volk_free(ctemp);
-            volk_free(c);
-            volk_free(ones_time);
-            volk_free(ones_freq);
-            delete papr_fft;
-            exit(1);
+            scratch[i] = new_scratch();
         }
+        fc_kernel = &p2_kernel[os_size];
+        for (int i = 0; i < dy; i++)
+        {
+            init_pilots(i);
+            pilot_shift[i] = shift;
+            data_kernel[i] = &p2_kernel[(i + 2) * os_size];
+            init_kernel(data_kernel[i], data_carrier_map, TRPAPR_CARRIER);
+        }
+        init_kernel(p2_kernel, p2_carrier_map, P2PAPR_CARRIER);
+        init_kernel(fc_kernel, fc_carrier_map, TRPAPR_CARRIER);
+        subtract_kernel = tr_select();
         num_symbols = numdatasyms + N_P2;
+        frame_count = 0;
+        workers_stop = FALSE;
+        for (int i = 1; i < num_threads; i++)
+        {
+            workers.create_thread(boost::bind(&paprtr_cc_impl::worker, this, i));
+        }
+        message_port_register_out(pmt::mp("stats"));
         set_output_multiple(num_symbols);
+        perf_attach(this);
     }
 
     /*
@@ -661,15 +310,18 @@ namespace gr {
      */
     paprtr_cc_impl::~paprtr_cc_impl()
     {
-        volk_free(v);
-        volk_free(rNew);
-        volk_free(r);
-        volk_free(magnitude);
-        volk_free(ctemp);
-        volk_free(c);
-        volk_free(ones_time);
+        {
+            gr::thread::scoped_lock lock(frame_mutex);
+            workers_stop = TRUE;
+            frame_ready.notify_all();
+        }
+        workers.join_all();
+        for (int i = 0; i < num_threads; i++)
+        {
+            delete_scratch(scratch[i]);
+        }
+        volk_free(p2_kernel);
         volk_free(ones_freq);
-        delete papr_fft;
     }
 
 void paprtr_cc_impl::init_pilots(int symbol)
@@ -730,6 +382,782 @@ void paprtr_cc_impl::init_pilots(int symbol)
     }
 }
 
+// Each worker thread owns its FFT plans and scratch buffers, the
+// reference kernels are shared read-only.
+paprtr_scratch *paprtr_cc_impl::new_scratch(void)
+{
+    paprtr_scratch *s = new paprtr_scratch;
+
+    s->papr_fft = new fft::fft_complex(os_size, false, 1);
+    s->os_fft = NULL;
+    if (os_factor > 1)
+    {
+        s->os_fft = new fft::fft_complex(papr_fft_size, true, 1);
+    }
+    s->ctemp = (gr_complex*) volk_malloc(sizeof(gr_complex) * papr_fft_size, volk_get_alignment());
+    if (s->ctemp == NULL)
+    {
+        fprintf(stderr, "Tone reservation PAPR 3rd volk_malloc, Out of memory.\n");
+        delete s->os_fft;
+        delete s->papr_fft;
+        throw std::bad_alloc();
+    }
+    s->magnitude = (float*) volk_malloc(sizeof(float) * os_size, volk_get_alignment());
+    if (s->magnitude == NULL)
+    {
+        fprintf(stderr, "Tone reservation PAPR 4th volk_malloc, Out of memory.\n");
+        volk_free(s->ctemp);
+        delete s->os_fft;
+        delete s->papr_fft;
+        throw std::bad_alloc();
+    }
+    s->r = (gr_complex*) volk_malloc(sizeof(gr_complex) * N_TR, volk_get_alignment());
+    if (s->r == NULL)
+    {
+        fprintf(stderr, "Tone reservation PAPR 5th volk_malloc, Out of memory.\n");
+        volk_free(s->magnitude);
+        volk_free(s->ctemp);
+        delete s->os_fft;
+        delete s->papr_fft;
+        throw std::bad_alloc();
+    }
+    s->rNew = (gr_complex*) volk_malloc(sizeof(gr_complex) * N_TR, volk_get_alignment());
+    if (s->rNew == NULL)
+    {
+        fprintf(stderr, "Tone reservation PAPR 6th volk_malloc, Out of memory.\n");
+        volk_free(s->r);
+        volk_free(s->magnitude);
+        volk_free(s->ctemp);
+        delete s->os_fft;
+        delete s->papr_fft;
+        throw std::bad_alloc();
+    }
+    s->v = (gr_complex*) volk_malloc(sizeof(gr_complex) * N_TR, volk_get_alignment());
+    if (s->v == NULL)
+    {
+        fprintf(stderr, "Tone reservation PAPR 7th volk_malloc, Out of memory.\n");
+        volk_free(s->rNew);
+        volk_free(s->r);
+        volk_free(s->magnitude);
+        volk_free(s->ctemp);
+        delete s->os_fft;
+        delete s->papr_fft;
+        throw std::bad_alloc();
+    }
+    s->os_signal = (gr_complex*) volk_malloc(sizeof(gr_complex) * os_size, volk_get_alignment());
+    if (s->os_signal == NULL)
+    {
+        fprintf(stderr, "Tone reservation PAPR 8th volk_malloc, Out of memory.\n");
+        volk_free(s->v);
+        volk_free(s->rNew);
+        volk_free(s->r);
+        volk_free(s->magnitude);
+        volk_free(s->ctemp);
+        delete s->os_fft;
+        delete s->papr_fft;
+        throw std::bad_alloc();
+    }
+    s->bins = (int32_t*) volk_malloc(sizeof(int32_t) * papr_fft_size, volk_get_alignment());
+    if (s->bins == NULL)
+    {
+        fprintf(stderr, "Tone reservation PAPR 9th volk_malloc, Out of memory.\n");
+        volk_free(s->os_signal);
+        volk_free(s->v);
+        volk_free(s->rNew);
+        volk_free(s->r);
+        volk_free(s->magnitude);
+        volk_free(s->ctemp);
+        delete s->os_fft;
+        delete s->papr_fft;
+        throw std::bad_alloc();
+    }
+    memset(&s->stats, 0, sizeof(paprtr_stats));
+    return s;
+}
+
+void paprtr_cc_impl::delete_scratch(paprtr_scratch *s)
+{
+    volk_free(s->bins);
+    volk_free(s->os_signal);
+    volk_free(s->v);
+    volk_free(s->rNew);
+    volk_free(s->r);
+    volk_free(s->magnitude);
+    volk_free(s->ctemp);
+    delete s->os_fft;
+    delete s->papr_fft;
+    delete s;
+}
+
+// The time domain reference kernel only depends on the symbol type
+// and the pilot phase, so all of them are computed once up front, at
+// the oversampled rate when peaks are detected on an oversampled view.
+void paprtr_cc_impl::init_kernel(gr_complex *kernel, const int *carrier_map, int carrier_type)
+{
+    gr_complex zero, one;
+    gr_complex *dst;
+    float normalization = 1.0 / N_TR;
+    int index;
+
+    one.real() = 1.0;
+    one.imag() = 0.0;
+    zero.real() = 0.0;
+    zero.imag() = 0.0;
+    index = 0;
+    memset(&ones_freq[index], 0, sizeof(gr_complex) * left_nulls);
+    index = left_nulls;
+    for (int n = 0; n < C_PS; n++)
+    {
+        if (carrier_map[n] == carrier_type)
+        {
+            ones_freq[index++] = one;
+        }
+        else
+        {
+            ones_freq[index++] = zero;
+        }
+    }
+    memset(&ones_freq[index], 0, sizeof(gr_complex) * right_nulls);
+    dst = scratch[0]->papr_fft->get_inbuf();
+    memcpy(&dst[0], &ones_freq[papr_fft_size / 2], sizeof(gr_complex) * papr_fft_size / 2);
+    memset(&dst[papr_fft_size / 2], 0, sizeof(gr_complex) * (os_size - papr_fft_size));
+    memcpy(&dst[os_size - (papr_fft_size / 2)], &ones_freq[0], sizeof(gr_complex) * papr_fft_size / 2);
+    scratch[0]->papr_fft->execute();
+    volk_32fc_s32fc_multiply_32fc(kernel, scratch[0]->papr_fft->get_outbuf(), normalization, os_size);
+}
+
+// Collect up to num_peaks samples above the threshold, largest first,
+// keeping only the largest of any samples closer than peak_separation
+// (measured circularly, the kernel is applied with a circular shift).
+int paprtr_cc_impl::find_peaks(paprtr_scratch *s, const float *power, float threshold)
+{
+    int count = 0;
+    int distance, dominated, keep;
+
+    for (int n = 0; n < os_size; n++)
+    {
+        if (power[n] <= threshold)
+        {
+            continue;
+        }
+        if (count == num_peaks && power[n] <= s->peak_power[count - 1])
+        {
+            continue;
+        }
+        dominated = FALSE;
+        for (int i = 0; i < count; i++)
+        {
+            distance = abs(n - (int)s->peak_index[i]);
+            if (distance > os_size / 2)
+            {
+                distance = os_size - distance;
+            }
+            if (distance < peak_separation && s->peak_power[i] >= power[n])
+            {
+                dominated = TRUE;
+                break;
+            }
+        }
+        if (dominated == TRUE)
+        {
+            continue;
+        }
+        keep = 0;
+        for (int i = 0; i < count; i++)
+        {
+            distance = abs(n - (int)s->peak_index[i]);
+            if (distance > os_size / 2)
+            {
+                distance = os_size - distance;
+            }
+            if (distance >= peak_separation)
+            {
+                s->peak_index[keep] = s->peak_index[i];
+                s->peak_power[keep] = s->peak_power[i];
+                keep++;
+            }
+        }
+        count = keep;
+        if (count == num_peaks)
+        {
+            count--;
+        }
+        int i = count;
+        while (i > 0 && s->peak_power[i - 1] < power[n])
+        {
+            s->peak_index[i] = s->peak_index[i - 1];
+            s->peak_power[i] = s->peak_power[i - 1];
+            i--;
+        }
+        s->peak_index[i] = n;
+        s->peak_power[i] = power[n];
+        count++;
+    }
+    return count;
+}
+
+// Cancel the peak of magnitude y at sample m, limiting the reserved
+// tone amplitudes to aMax.
+void paprtr_cc_impl::cancel_peak(paprtr_scratch *s, gr_complex *out, const gr_complex *kernel, uint32_t m, float y)
+{
+    int index;
+    float a, alpha, limit;
+    gr_complex u, result, temp;
+    double _Complex vtemp;
+
+    u.real() = out[m].real() / y;
+    u.imag() = out[m].imag() / y;
+    alpha = y - v_clip;
+    for (int n = 0; n < N_TR; n++)
+    {
+        vtemp = 0.0 + ((2 * M_PI * m * ((s->papr_map[n] + s->shift) - center)) / os_size * _Complex_I);
+        vtemp = cexp(vtemp);
+        s->ctemp[n].real() = creal(vtemp);
+        s->ctemp[n].imag() = -cimag(vtemp);
+    }
+    volk_32fc_s32fc_multiply_32fc(s->v, s->ctemp, u, N_TR);
+    temp.real() = alpha;
+    temp.imag() = 0.0;
+    volk_32fc_s32fc_multiply_32fc(s->rNew, s->v, temp, N_TR);
+    volk_32f_x2_subtract_32f((float*)s->rNew, (float*)s->r, (float*)s->rNew, N_TR * 2);
+    volk_32fc_x2_multiply_conjugate_32fc(s->ctemp, s->r, s->v, N_TR);
+    for (int n = 0; n < N_TR; n++)
+    {
+        limit = (aMax * aMax) - (s->ctemp[n].imag() * s->ctemp[n].imag());
+        if (limit > 0.0)
+        {
+            s->alphaLimit[n] = sqrt(limit) + s->ctemp[n].real();
+        }
+        else
+        {
+            s->alphaLimit[n] = 0.0;
+        }
+    }
+    index = 0;
+    volk_32fc_magnitude_32f(s->magnitude, s->rNew, N_TR);
+    for (int n = 0; n < N_TR; n++)
+    {
+        if (s->magnitude[n] > aMax)
+        {
+            s->alphaLimitMax[index++] = s->alphaLimit[n];
+        }
+    }
+    if (index != 0)
+    {
+        a = 1.0e+30;
+        for (int n = 0; n < index; n++)
+        {
+            if (s->alphaLimitMax[n] < a)
+            {
+                a = s->alphaLimitMax[n];
+            }
+        }
+        // Rounding can leave a tone marginally above aMax, never let
+        // that turn into a negative step that grows the peak.
+        alpha = a > 0.0 ? a : 0.0;
+        s->stats.limited++;
+        temp.real() = alpha;
+        temp.imag() = 0.0;
+        volk_32fc_s32fc_multiply_32fc(s->rNew, s->v, temp, N_TR);
+        volk_32f_x2_subtract_32f((float*)s->rNew, (float*)s->r, (float*)s->rNew, N_TR * 2);
+    }
+    temp.real() = alpha;
+    temp.imag() = 0.0;
+    result.real() = (u.real() * temp.real()) - (u.imag() * temp.imag());
+    result.imag() = (u.imag() * temp.real()) + (u.real() * temp.imag());
+    subtract_kernel(&out[m], &kernel[0], result, os_size - m);
+    subtract_kernel(&out[0], &kernel[os_size - m], result, m);
+    memcpy(s->r, s->rNew, sizeof(gr_complex) * N_TR);
+}
+
+// Zero-padded FFT interpolation of a symbol into os_signal. The
+// samples at multiples of os_factor are the original samples.
+void paprtr_cc_impl::interpolate(paprtr_scratch *s, const gr_complex *in)
+{
+    gr_complex *dst;
+    const gr_complex *src;
+    float normalization = 1.0 / papr_fft_size;
+
+    memcpy(s->os_fft->get_inbuf(), in, sizeof(gr_complex) * papr_fft_size);
+    s->os_fft->execute();
+    src = s->os_fft->get_outbuf();
+    dst = s->papr_fft->get_inbuf();
+    memcpy(&dst[0], &src[0], sizeof(gr_complex) * papr_fft_size / 2);
+    memset(&dst[papr_fft_size / 2], 0, sizeof(gr_complex) * (os_size - papr_fft_size));
+    memcpy(&dst[os_size - (papr_fft_size / 2)], &src[papr_fft_size / 2], sizeof(gr_complex) * papr_fft_size / 2);
+    s->papr_fft->execute();
+    volk_32fc_s32fc_multiply_32fc(s->os_signal, s->papr_fft->get_outbuf(), normalization, os_size);
+}
+
+// PAPR in dB of the first size sample powers in s->magnitude, with
+// the index of the largest sample and the sum of the powers.
+float paprtr_cc_impl::power_to_average(paprtr_scratch *s, int size, uint32_t *index, float *sum)
+{
+    volk_32f_index_max_32u(index, s->magnitude, size);
+    volk_32f_accumulator_s32f(sum, s->magnitude, size);
+    if (*sum == 0.0)
+    {
+        return 0.0;
+    }
+    return 10.0 * log10((s->magnitude[*index] * size) / *sum);
+}
+
+float paprtr_cc_impl::peak_to_average(paprtr_scratch *s, const gr_complex *signal, float *peak)
+{
+    uint32_t index;
+    float sum, papr;
+
+    volk_32fc_magnitude_squared_32f(s->magnitude, signal, os_size);
+    papr = power_to_average(s, os_size, &index, &sum);
+    *peak = sqrt(s->magnitude[index]);
+    return papr;
+}
+
+// Add the output symbol to the CCDF histogram and return its PAPR.
+// The sample power relative to the symbol mean is converted to dB and
+// rounded to a bin index with vector kernels, only the histogram
+// update is scalar.
+float paprtr_cc_impl::bin_power(paprtr_scratch *s, const gr_complex *out, float *peak)
+{
+    float sum, papr;
+    uint32_t index;
+    int32_t bin;
+
+    volk_32fc_magnitude_squared_32f(s->magnitude, out, papr_fft_size);
+    papr = power_to_average(s, papr_fft_size, &index, &sum);
+    *peak = sqrt(s->magnitude[index]);
+    if (sum == 0.0)
+    {
+        return papr;
+    }
+    volk_32f_s32f_multiply_32f(s->magnitude, s->magnitude, papr_fft_size / sum, papr_fft_size);
+    volk_32f_log2_32f(s->magnitude, s->magnitude, papr_fft_size);
+    volk_32f_s32f_convert_32i(s->bins, s->magnitude, 10.0 * log10(2.0) * CCDF_STEPS_PER_DB, papr_fft_size);
+    for (int n = 0; n < papr_fft_size; n++)
+    {
+        bin = s->bins[n];
+        if (bin < 0)
+        {
+            bin = 0;
+        }
+        if (bin >= CCDF_BINS)
+        {
+            bin = CCDF_BINS - 1;
+        }
+        s->stats.histogram[bin]++;
+    }
+    s->stats.samples += papr_fft_size;
+    return papr;
+}
+
+// Fold src into dst and clear src.
+void paprtr_cc_impl::merge_stats(paprtr_stats *dst, paprtr_stats *src)
+{
+    dst->symbols += src->symbols;
+    dst->under_processed += src->under_processed;
+    dst->iterations += src->iterations;
+    dst->cancelled += src->cancelled;
+    dst->limited += src->limited;
+    dst->papr_before_sum += src->papr_before_sum;
+    dst->papr_after_sum += src->papr_after_sum;
+    if (src->peak_before > dst->peak_before)
+    {
+        dst->peak_before = src->peak_before;
+    }
+    if (src->peak_after > dst->peak_after)
+    {
+        dst->peak_after = src->peak_after;
+    }
+    dst->samples += src->samples;
+    for (int i = 0; i < CCDF_BINS; i++)
+    {
+        dst->histogram[i] += src->histogram[i];
+    }
+    memset(src, 0, sizeof(paprtr_stats));
+}
+
+// The totals are a seqlock, so neither work() nor the readers take a
+// lock. A writer makes the sequence number odd while it changes them,
+// readers copy them until no write overlapped the copy. work() and
+// reset_stats() are the writers, they take turns on the odd number.
+void paprtr_cc_impl::stats_write_begin(void)
+{
+    unsigned int sequence;
+
+    do
+    {
+        sequence = __atomic_load_n(&stats_sequence, __ATOMIC_RELAXED) & ~1u;
+    }
+    while (!__atomic_compare_exchange_n(&stats_sequence, &sequence, sequence + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void paprtr_cc_impl::stats_write_end(void)
+{
+    __atomic_store_n(&stats_sequence, __atomic_load_n(&stats_sequence, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+void paprtr_cc_impl::stats_snapshot(paprtr_stats *copy) const
+{
+    unsigned int before, after;
+
+    do
+    {
+        before = __atomic_load_n(&stats_sequence, __ATOMIC_ACQUIRE);
+        memcpy(copy, &stats, sizeof(paprtr_stats));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&stats_sequence, __ATOMIC_RELAXED);
+    }
+    while ((before & 1) != 0 || before != after);
+}
+
+// Called by work() between frames, when none of the threads touch
+// their scratch statistics.
+void paprtr_cc_impl::publish_stats(void)
+{
+    pmt::pmt_t dict;
+    std::vector<float> probability;
+
+    stats_write_begin();
+    for (int i = 0; i < num_threads; i++)
+    {
+        merge_stats(&stats, &scratch[i]->stats);
+    }
+    stats_write_end();
+    probability = ccdf();
+    dict = pmt::make_dict();
+    dict = pmt::dict_add(dict, pmt::mp("processed_symbols"), pmt::from_uint64(processed_symbols()));
+    dict = pmt::dict_add(dict, pmt::mp("under_processed_symbols"), pmt::from_uint64(under_processed_symbols()));
+    dict = pmt::dict_add(dict, pmt::mp("iterations"), pmt::from_uint64(total_iterations()));
+    dict = pmt::dict_add(dict, pmt::mp("cancelled_peaks"), pmt::from_uint64(cancelled_peaks()));
+    dict = pmt::dict_add(dict, pmt::mp("limited_peaks"), pmt::from_uint64(limited_peaks()));
+    dict = pmt::dict_add(dict, pmt::mp("papr_before"), pmt::from_double(papr_before()));
+    dict = pmt::dict_add(dict, pmt::mp("papr_after"), pmt::from_double(papr_after()));
+    dict = pmt::dict_add(dict, pmt::mp("peak_before"), pmt::from_double(peak_before()));
+    dict = pmt::dict_add(dict, pmt::mp("peak_after"), pmt::from_double(peak_after()));
+    dict = pmt::dict_add(dict, pmt::mp("ccdf"), pmt::init_f32vector(CCDF_BINS, probability));
+    message_port_pub(pmt::mp("stats"), dict);
+}
+
+uint64_t paprtr_cc_impl::processed_symbols() const
+{
+    paprtr_stats copy;
+
+    stats_snapshot(&copy);
+    return copy.symbols;
+}
+
+uint64_t paprtr_cc_impl::under_processed_symbols() const
+{
+    paprtr_stats copy;
+
+    stats_snapshot(&copy);
+    return copy.under_processed;
+}
+
+float paprtr_cc_impl::papr_before() const
+{
+    paprtr_stats copy;
+
+    stats_snapshot(&copy);
+    return copy.symbols == 0 ? 0.0 : copy.papr_before_sum / copy.symbols;
+}
+
+float paprtr_cc_impl::papr_after() const
+{
+    paprtr_stats copy;
+
+    stats_snapshot(&copy);
+    return copy.symbols == 0 ? 0.0 : copy.papr_after_sum / copy.symbols;
+}
+
+uint64_t paprtr_cc_impl::total_iterations() const
+{
+    paprtr_stats copy;
+
+    stats_snapshot(&copy);
+    return copy.iterations;
+}
+
+uint64_t paprtr_cc_impl::cancelled_peaks() const
+{
+    paprtr_stats copy;
+
+    stats_snapshot(&copy);
+    return copy.cancelled;
+}
+
+uint64_t paprtr_cc_impl::limited_peaks() const
+{
+    paprtr_stats copy;
+
+    stats_snapshot(&copy);
+    return copy.limited;
+}
+
+float paprtr_cc_impl::peak_before() const
+{
+    paprtr_stats copy;
+
+    stats_snapshot(&copy);
+    return copy.peak_before;
+}
+
+float paprtr_cc_impl::peak_after() const
+{
+    paprtr_stats copy;
+
+    stats_snapshot(&copy);
+    return copy.peak_after;
+}
+
+std::vector<float> paprtr_cc_impl::ccdf() const
+{
+    std::vector<float> probability(CCDF_BINS, 0.0);
+    paprtr_stats copy;
+    uint64_t count = 0;
+
+    stats_snapshot(&copy);
+    if (copy.samples == 0)
+    {
+        return probability;
+    }
+    for (int i = CCDF_BINS - 1; i >= 0; i--)
+    {
+        count += copy.histogram[i];
+        probability[i] = (double)count / copy.samples;
+    }
+    return probability;
+}
+
+void paprtr_cc_impl::reset_stats()
+{
+    stats_write_begin();
+    memset(&stats, 0, sizeof(paprtr_stats));
+    stats_write_end();
+}
+
+// Share what is left of the frame budget over the symbols still to
+// be processed, using the running average cost of one iteration.
+int paprtr_cc_impl::iteration_limit(high_res_timer_type elapsed, int remaining)
+{
+    high_res_timer_type available = frame_budget - budget_debt - elapsed;
+    double limit;
+
+    if (available <= 0)
+    {
+        return 0;
+    }
+    if (iteration_cost == 0.0)
+    {
+        return num_iterations;
+    }
+    remaining = (remaining + num_threads - 1) / num_threads;
+    limit = available / (remaining * iteration_cost);
+    if (limit > num_iterations)
+    {
+        return num_iterations;
+    }
+    return (int)limit;
+}
+
+void paprtr_cc_impl::update_cost(high_res_timer_type elapsed, int iterations)
+{
+    double cost;
+
+    if (iterations == 0)
+    {
+        return;
+    }
+    cost = (double)elapsed / iterations;
+    if (iteration_cost == 0.0)
+    {
+        iteration_cost = cost;
+    }
+    else
+    {
+        iteration_cost = (0.9 * iteration_cost) + (0.1 * cost);
+    }
+}
+
+// Tone reservation of symbol j of the current frame.
+void paprtr_cc_impl::process_symbol(paprtr_scratch *s, const gr_complex *in, gr_complex *out, int j, int limit)
+{
+    int valid, converged, found, cancelled, k;
+    int L_FC = 0;
+    const gr_complex *kernel = NULL;
+    gr_complex *signal;
+    uint32_t m;
+    float y, peak, decimated_peak, sum, papr_before, papr_after;
+
+    if (N_FC != 0)
+    {
+        L_FC = 1;
+    }
+    s->shift = pilot_shift[j % dy];
+    valid = FALSE;
+    if (j < N_P2)
+    {
+        kernel = p2_kernel;
+        s->papr_map = p2_papr_map;
+        valid = TRUE;
+    }
+    else if (j == (num_symbols - L_FC) && (papr_mode == gr::dvbt2::PAPR_TR || papr_mode == gr::dvbt2::PAPR_BOTH))
+    {
+        kernel = fc_kernel;
+        s->papr_map = p2_papr_map;
+        valid = TRUE;
+    }
+    else if (papr_mode == gr::dvbt2::PAPR_TR || papr_mode == gr::dvbt2::PAPR_BOTH)
+    {
+        kernel = data_kernel[j % dy];
+        s->papr_map = tr_papr_map;
+        valid = TRUE;
+    }
+    s->valid = valid;
+    if (valid == FALSE)
+    {
+        memcpy(out, in, sizeof(gr_complex) * papr_fft_size);
+        return;
+    }
+    memset(&s->r[0], 0, sizeof(gr_complex) * N_TR);
+    // Without oversampling the sample powers of the input are those
+    // the first iteration searches, and the output PAPR is taken from
+    // the CCDF pass.
+    if (os_factor > 1)
+    {
+        interpolate(s, in);
+        signal = s->os_signal;
+        papr_before = peak_to_average(s, signal, &peak);
+    }
+    else
+    {
+        memcpy(out, in, sizeof(gr_complex) * papr_fft_size);
+        signal = out;
+        volk_32fc_magnitude_squared_32f(s->magnitude, signal, os_size);
+        papr_before = power_to_average(s, os_size, &s->peak_index[0], &sum);
+        peak = sqrt(s->magnitude[s->peak_index[0]]);
+    }
+    if (peak > s->stats.peak_before)
+    {
+        s->stats.peak_before = peak;
+    }
+    converged = FALSE;
+    s->iterations = limit;
+    for (k = 1; k <= limit; k++)
+    {
+        if (num_peaks == 1)
+        {
+            if (k > 1 || os_factor > 1)
+            {
+                volk_32fc_index_max_32u(&s->peak_index[0], signal, os_size);
+            }
+            found = 1;
+        }
+        else
+        {
+            if (k > 1 || os_factor > 1)
+            {
+                volk_32fc_magnitude_squared_32f(s->magnitude, signal, os_size);
+            }
+            found = find_peaks(s, s->magnitude, (v_clip + v_tolerance) * (v_clip + v_tolerance));
+        }
+        cancelled = 0;
+        for (int p = 0; p < found; p++)
+        {
+            m = s->peak_index[p];
+            y = sqrt((signal[m].real() * signal[m].real()) + (signal[m].imag() * signal[m].imag()));
+            if (y < v_clip + v_tolerance)
+            {
+                continue;
+            }
+            cancel_peak(s, signal, kernel, m, y);
+            cancelled++;
+        }
+        s->stats.cancelled += cancelled;
+        if (cancelled == 0)
+        {
+            converged = TRUE;
+            s->iterations = k;
+            break;
+        }
+    }
+    if (os_factor > 1)
+    {
+        papr_after = peak_to_average(s, signal, &peak);
+        for (int n = 0; n < papr_fft_size; n++)
+        {
+            out[n] = s->os_signal[n * os_factor];
+        }
+        bin_power(s, out, &decimated_peak);
+    }
+    else
+    {
+        papr_after = bin_power(s, out, &peak);
+    }
+    if (peak > s->stats.peak_after)
+    {
+        s->stats.peak_after = peak;
+    }
+    s->stats.symbols++;
+    s->stats.iterations += s->iterations;
+    s->stats.papr_before_sum += papr_before;
+    s->stats.papr_after_sum += papr_after;
+    if (converged == FALSE && limit < num_iterations)
+    {
+        s->stats.under_processed++;
+    }
+}
+
+// Symbols of the current frame are handed out one at a time, so all
+// threads stay busy even when the iteration counts differ. The frame
+// state and the budget are only touched with frame_mutex held, the
+// statistics are kept per thread.
+void paprtr_cc_impl::run_symbols(paprtr_scratch *s, gr::thread::scoped_lock &lock)
+{
+    high_res_timer_type symbol_start = 0;
+    int j, limit;
+
+    while (next_symbol < num_symbols)
+    {
+        j = next_symbol++;
+        limit = num_iterations;
+        if (frame_budget != 0)
+        {
+            symbol_start = high_res_timer_now();
+            limit = iteration_limit(symbol_start - frame_start, num_symbols - j);
+        }
+        lock.unlock();
+        process_symbol(s, &frame_in[j * papr_fft_size], &frame_out[j * papr_fft_size], j, limit);
+        lock.lock();
+        if (s->valid == TRUE && frame_budget != 0)
+        {
+            update_cost(high_res_timer_now() - symbol_start, s->iterations);
+        }
+        if (--pending_symbols == 0)
+        {
+            frame_done.notify_all();
+        }
+    }
+}
+
+void paprtr_cc_impl::worker(int id)
+{
+    unsigned int frame = 0;
+    gr::thread::scoped_lock lock(frame_mutex);
+
+    while (workers_stop == FALSE)
+    {
+        if (frame == frame_count)
+        {
+            frame_ready.wait(lock);
+            continue;
+        }
+        frame = frame_count;
+        run_symbols(scratch[id], lock);
+    }
+}
+
     int
     paprtr_cc_impl::work(int noutput_items,
 			  gr_vector_const_void_star &input_items,
@@ -737,188 +1165,44 @@ void paprtr_cc_impl::init_pilots(int symbol)
     {
         const gr_complex *in = (const gr_complex *) input_items[0];
         gr_complex *out = (gr_complex *) output_items[0];
-        gr_complex zero, one;
-        int index, valid;
-        int L_FC = 0;
-        gr_complex *dst;
-        float normalization = 1.0 / N_TR;
-        int m = 0;
-        float y, a, alpha, center = (C_PS - 1) / 2;
-        float aMax = 5.0 * N_TR * sqrt(10.0 / (27.0 * C_PS));
-        gr_complex u, result, temp;
-        double _Complex vtemp;
-
-        one.real() = 1.0;
-        one.imag() = 0.0;
-        zero.real() = 0.0;
-        zero.imag() = 0.0;
-        if (N_FC != 0)
-        {
-            L_FC = 1;
-        }
+
+        perf_begin();
+
         for (int i = 0; i < noutput_items; i += num_symbols)
         {
             if (papr_mode == gr::dvbt2::PAPR_TR || papr_mode == gr::dvbt2::PAPR_BOTH || (version_num == gr::dvbt2::VERSION_131 && papr_mode == gr::dvbt2::PAPR_OFF))
             {
-                for (int j = 0; j < num_symbols; j++)
+                gr::thread::scoped_lock lock(frame_mutex);
+                frame_in = in;
+                frame_out = out;
+                next_symbol = 0;
+                pending_symbols = num_symbols;
+                if (frame_budget != 0)
                 {
-                    init_pilots(j);
-                    valid = FALSE;
-                    if (j < N_P2)
-                    {
-                        index = 0;
-                        memset(&ones_freq[index], 0, sizeof(gr_complex) * left_nulls);
-                        index = left_nulls;
-                        for (int n = 0; n < C_PS; n++)
-                        {
-                            if (p2_carrier_map[n] == P2PAPR_CARRIER)
-                            {
-                                ones_freq[index++] = one;
-                            }
-                            else
-                            {
-                                ones_freq[index++] = zero;
-                            }
-                        }
-                        memset(&ones_freq[index], 0, sizeof(gr_complex) * right_nulls);
-                        papr_map = p2_papr_map;
-                        valid = TRUE;
-                    }
-                    else if (j == (num_symbols - L_FC) && (papr_mode == gr::dvbt2::PAPR_TR || papr_mode == gr::dvbt2::PAPR_BOTH))
-                    {
-                        index = 0;
-                        memset(&ones_freq[index], 0, sizeof(gr_complex) * left_nulls);
-                        index = left_nulls;
-                        for (int n = 0; n < C_PS; n++)
-                        {
-                            if (fc_carrier_map[n] == TRPAPR_CARRIER)
-                            {
-                                ones_freq[index++] = one;
-                            }
-                            else
-                            {
-                                ones_freq[index++] = zero;
-                            }
-                        }
-                        memset(&ones_freq[index], 0, sizeof(gr_complex) * right_nulls);
-                        papr_map = p2_papr_map;
-                        valid = TRUE;
-                    }
-                    else if (papr_mode == gr::dvbt2::PAPR_TR || papr_mode == gr::dvbt2::PAPR_BOTH)
-                    {
-                        index = 0;
-                        memset(&ones_freq[index], 0, sizeof(gr_complex) * left_nulls);
-                        index = left_nulls;
-                        for (int n = 0; n < C_PS; n++)
-                        {
-                            if (data_carrier_map[n] == TRPAPR_CARRIER)
-                            {
-                                ones_freq[index++] = one;
-                            }
-                            else
-                            {
-                                ones_freq[index++] = zero;
-                            }
-                        }
-                        memset(&ones_freq[index], 0, sizeof(gr_complex) * right_nulls);
-                        papr_map = tr_papr_map;
-                        valid = TRUE;
-                    }
-                    if (valid == TRUE)
+                    frame_start = high_res_timer_now();
+                }
+                frame_count++;
+                frame_ready.notify_all();
+                run_symbols(scratch[0], lock);
+                while (pending_symbols != 0)
+                {
+                    frame_done.wait(lock);
+                }
+                if (frame_budget != 0)
+                {
+                    budget_debt += (high_res_timer_now() - frame_start) - frame_budget;
+                    if (budget_debt < 0)
                     {
-                        dst = papr_fft->get_inbuf();
-                        memcpy(&dst[papr_fft_size / 2], &ones_freq[0], sizeof(gr_complex) * papr_fft_size / 2);
-                        memcpy(&dst[0], &ones_freq[papr_fft_size / 2], sizeof(gr_complex) * papr_fft_size / 2);
-                        papr_fft->execute();
-                        memcpy(ones_time, papr_fft->get_outbuf(), sizeof(gr_complex) * papr_fft_size);
-                        volk_32fc_s32fc_multiply_32fc(ones_time, ones_time, normalization, papr_fft_size);
-                        memset(&r[0], 0, sizeof(gr_complex) * N_TR);
-                        memset(&c[0], 0, sizeof(gr_complex) * papr_fft_size);
-                        for (int k = 1; k <= num_iterations; k++)
-                        {
-                            y = 0.0;
-                            volk_32f_x2_add_32f((float*)ctemp, (float*)in, (float*)c, papr_fft_size * 2);
-                            volk_32fc_magnitude_32f(magnitude, ctemp, papr_fft_size);
-                            for (int n = 0; n < papr_fft_size; n++)
-                            {
-                                if (magnitude[n] > y)
-                                {
-                                    y = magnitude[n];
-                                    m = n;
-                                }
-                            }
-                            if (y < v_clip + 0.01)
-                            {
-                                break;
-                            }
-                            u.real() = (in[m].real() + c[m].real()) / y;
-                            u.imag() = (in[m].imag() + c[m].imag()) / y;
-                            alpha = y - v_clip;
-                            for (int n = 0; n < N_TR; n++)
-                            {
-                                vtemp = 0.0 + ((2 * M_PI * m * ((papr_map[n] + shift) - center)) / papr_fft_size * _Complex_I);
-                                vtemp = cexp(vtemp);
-                                ctemp[n].real() = creal(vtemp);
-                                ctemp[n].imag() = -cimag(vtemp);
-                            }
-                            volk_32fc_s32fc_multiply_32fc(v, ctemp, u, N_TR);
-                            temp.real() = alpha;
-                            temp.imag() = 0.0;
-                            volk_32fc_s32fc_multiply_32fc(rNew, v, temp, N_TR);
-                            volk_32f_x2_subtract_32f((float*)rNew, (float*)r, (float*)rNew, N_TR * 2);
-                            volk_32fc_x2_multiply_conjugate_32fc(ctemp, r, v, N_TR);
-                            for (int n = 0; n < N_TR; n++)
-                            {
-                                alphaLimit[n] = sqrt((aMax * aMax) - (ctemp[n].imag() * ctemp[n].imag())) + ctemp[n].real();
-                            }
-                            index = 0;
-                            volk_32fc_magnitude_32f(magnitude, rNew, N_TR);
-                            for (int n = 0; n < N_TR; n++)
-                            {
-                                if (magnitude[n] > aMax)
-                                {
-                                    alphaLimitMax[index++] = alphaLimit[n];
-                                }
-                            }
-                            if (index != 0)
-                            {
-                                a = 1.0e+30;
-                                for (int n = 0; n < index; n++)
-                                {
-                                    if (alphaLimitMax[n] < a)
-                                    {
-                                        a = alphaLimitMax[n];
-                                    }
-                                }
-                                alpha = a;
-                                temp.real() = alpha;
-                                temp.imag() = 0.0;
-                                volk_32fc_s32fc_multiply_32fc(rNew, v, temp, N_TR);
-                                volk_32f_x2_subtract_32f((float*)rNew, (float*)r, (float*)rNew, N_TR * 2);
-                            }
-                            for (int n = 0; n < papr_fft_size; n++)
-                            {
-                                ones_freq[(n + m) % papr_fft_size] = ones_time[n];
-                            }
-                            temp.real() = alpha;
-                            temp.imag() = 0.0;
-                            result.real() = (u.real() * temp.real()) - (u.imag() * temp.imag());
-                            result.imag() = (u.imag() * temp.real()) + (u.real() * temp.imag());
-                            volk_32fc_s32fc_multiply_32fc(ctemp, ones_freq, result, papr_fft_size);
-                            volk_32f_x2_subtract_32f((float*)c, (float*)c, (float*)ctemp, papr_fft_size * 2);
-                            memcpy(r, rNew, sizeof(gr_complex) * N_TR);
-                        }
-                        volk_32f_x2_add_32f((float*)out, (float*)in, (float*)c, papr_fft_size * 2);
-                        in = in + papr_fft_size;
-                        out = out + papr_fft_size;
+                        budget_debt = 0;
                     }
-                    else
+                    if (budget_debt > frame_budget)
                     {
-                        memcpy(out, in, sizeof(gr_complex) * papr_fft_size);
-                        in = in + papr_fft_size;
-                        out = out + papr_fft_size;
+                        budget_debt = frame_budget;
                     }
                 }
+                publish_stats();
+                in = in + (num_symbols * papr_fft_size);
+                out = out + (num_symbols * papr_fft_size);
             }
             else
             {
@@ -931,6 +1215,8 @@ void paprtr_cc_impl::init_pilots(int symbol)
             }
         }
 
+        perf_end(noutput_items);
+
         // Tell runtime system how many output items we produced.
         return noutput_items;
     }
@@ -23,10 +23,18 @@
 
 #include <dvbt2/paprtr_cc.h>
 #include <gnuradio/fft/fft.h>
+#include <gnuradio/high_res_timer.h>
+#include <gnuradio/thread/thread.h>
+#include "papr_kernels.h"
 
 #define MAX_CARRIERS 27841
 #define MAX_FFTSIZE 32768
 #define MAX_PAPRTONES 288
+#define MAX_PILOTPHASES 16
+#define MAX_PEAKS 64
+#define MAX_THREADS 64
+#define CCDF_BINS 160
+#define CCDF_STEPS_PER_DB 10
 
 enum dvbt2_carrier_type_t {
   DATA_CARRIER = 1,
@@ -40,6 +48,43 @@ enum dvbt2_carrier_type_t {
 namespace gr {
   namespace dvbt2 {
 
+    struct paprtr_stats
+    {
+      uint64_t symbols;
+      uint64_t under_processed;
+      uint64_t iterations;
+      uint64_t cancelled;
+      uint64_t limited;
+      double papr_before_sum;
+      double papr_after_sum;
+      float peak_before;
+      float peak_after;
+      uint64_t samples;
+      uint64_t histogram[CCDF_BINS];
+    };
+
+    struct paprtr_scratch
+    {
+      fft::fft_complex *papr_fft;
+      fft::fft_complex *os_fft;
+      gr_complex *ctemp;
+      float *magnitude;
+      gr_complex *r;
+      gr_complex *rNew;
+      gr_complex *v;
+      gr_complex *os_signal;
+      int32_t *bins;
+      float alphaLimit[MAX_PAPRTONES];
+      float alphaLimitMax[MAX_PAPRTONES];
+      uint32_t peak_index[MAX_PEAKS];
+      float peak_power[MAX_PEAKS];
+      const int *papr_map;
+      int shift;
+      int valid;
+      int iterations;
+      paprtr_stats stats;
+    };
+
     class paprtr_cc_impl : public paprtr_cc
     {
      private:
@@ -53,22 +98,57 @@ namespace gr {
       int version_num;
       double v_clip;
       int num_iterations;
-      const int *papr_map;
+      int num_peaks;
+      int peak_separation;
+      float v_tolerance;
+      float aMax;
+      float center;
+      high_res_timer_type frame_budget;
+      high_res_timer_type budget_debt;
+      double iteration_cost;
+      paprtr_stats stats;
+      unsigned int stats_sequence;
+      int os_factor;
+      int os_size;
+      int num_threads;
+      paprtr_scratch *scratch[MAX_THREADS];
+      boost::thread_group workers;
+      gr::thread::mutex frame_mutex;
+      gr::thread::condition_variable frame_ready;
+      gr::thread::condition_variable frame_done;
+      const gr_complex *frame_in;
+      gr_complex *frame_out;
+      int next_symbol;
+      int pending_symbols;
+      unsigned int frame_count;
+      int workers_stop;
+      high_res_timer_type frame_start;
+      paprtr_scratch *new_scratch(void);
+      void delete_scratch(paprtr_scratch *);
+      void interpolate(paprtr_scratch *, const gr_complex *);
+      float power_to_average(paprtr_scratch *, int, uint32_t *, float *);
+      float peak_to_average(paprtr_scratch *, const gr_complex *, float *);
+      float bin_power(paprtr_scratch *, const gr_complex *, float *);
+      void merge_stats(paprtr_stats *, paprtr_stats *);
+      void stats_write_begin(void);
+      void stats_write_end(void);
+      void stats_snapshot(paprtr_stats *) const;
+      void publish_stats(void);
+      void process_symbol(paprtr_scratch *, const gr_complex *, gr_complex *, int, int);
+      void run_symbols(paprtr_scratch *, gr::thread::scoped_lock &);
+      void worker(int);
+      int iteration_limit(high_res_timer_type, int);
+      void update_cost(high_res_timer_type, int);
       const int *p2_papr_map;
       const int *tr_papr_map;
       int p2_carrier_map[MAX_CARRIERS];
       int data_carrier_map[MAX_CARRIERS];
       int fc_carrier_map[MAX_CARRIERS];
       gr_complex *ones_freq;
-      gr_complex *ones_time;
-      gr_complex *c;
-      gr_complex *ctemp;
-      float *magnitude;
-      gr_complex *r;
-      gr_complex *rNew;
-      gr_complex *v;
-      float alphaLimit[MAX_PAPRTONES];
-      float alphaLimitMax[MAX_PAPRTONES];
+      gr_complex *p2_kernel;
+      gr_complex *fc_kernel;
+      gr_complex *data_kernel[MAX_PILOTPHASES];
+      int pilot_shift[MAX_PILOTPHASES];
       int N_P2;
       int N_FC;
       int K_EXT;
@@ -78,8 +158,14 @@ namespace gr {
       int dy;
       int shift;
       void init_pilots(int);
+      void init_kernel(gr_complex *, const int *, int);
+      // Subtracts the scaled kernel from the signal in a single pass.
+      // The caller splits the circularly shifted kernel into two
+      // contiguous segments.
+      tr_kernel_t subtract_kernel;
+      int find_peaks(paprtr_scratch *, const float *, float);
+      void cancel_peak(paprtr_scratch *, gr_complex *, const gr_complex *, uint32_t, float);
 
-      fft::fft_complex *papr_fft;
       int papr_fft_size;
 
       const static int p2_papr_map_1k[10];
@@ -96,9 +182,21 @@ namespace gr {
       const static int tr_papr_map_32k[288];
 
      public:
-      paprtr_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, float vclip, int iterations, int vlength);
+      paprtr_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, float vclip, int iterations, int vlength, int peaks, int separation, float tolerance, float budget, int oversampling, int nthreads);
       ~paprtr_cc_impl();
 
+      uint64_t processed_symbols() const;
+      uint64_t under_processed_symbols() const;
+      float papr_before() const;
+      float papr_after() const;
+      uint64_t total_iterations() const;
+      uint64_t cancelled_peaks() const;
+      uint64_t limited_peaks() const;
+      float peak_before() const;
+      float peak_after() const;
+      std::vector<float> ccdf() const;
+      void reset_stats();
+
       // Where all the action really happens
       int work(int noutput_items,
 	       gr_vector_const_void_star &input_items,
@@ -0,0 +1,172 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "parallel_engine.h"
+#include <boost/bind.hpp>
+#include <volk/volk.h>
+#include <stdio.h>
+#include <new>
+#include <string.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    parallel_engine::parallel_engine(const std::vector<t2_chain *> &chains, int depth, const std::vector<int> &cores)
+      : chains(chains),
+        cores(cores),
+        push_slot(0),
+        run_slot(0),
+        pop_slot(0),
+        queued(0),
+        pending(0),
+        frame_number(0),
+        stopping(false)
+    {
+        t2_chain *chain = chains[0];
+        int bits_items = chain->bbframe_header_items();
+
+        if (depth < 1)
+        {
+            depth = 1;
+        }
+        frame_output_items = chain->output_items();
+        jobs.resize(chains.size() * depth);
+        for (unsigned int i = 0; i < jobs.size(); i++)
+        {
+            jobs[i].samples = (gr_complex*) volk_malloc(sizeof(gr_complex) * frame_output_items, volk_get_alignment());
+            jobs[i].bits = (unsigned char*) volk_malloc(sizeof(unsigned char) * bits_items, volk_get_alignment());
+            if (jobs[i].samples == NULL || jobs[i].bits == NULL)
+            {
+                fprintf(stderr, "Parallel engine volk_malloc, Out of memory.\n");
+                // resize() left the buffers not allocated yet NULL.
+                for (unsigned int j = 0; j <= i; j++)
+                {
+                    volk_free(jobs[j].bits);
+                    volk_free(jobs[j].samples);
+                }
+                throw std::bad_alloc();
+            }
+            jobs[i].frame_number = 0;
+            jobs[i].done = false;
+        }
+        for (unsigned int n = 0; n < chains.size(); n++)
+        {
+            threads.create_thread(boost::bind(&parallel_engine::worker, this, n));
+        }
+    }
+
+    parallel_engine::~parallel_engine()
+    {
+        {
+            gr::thread::scoped_lock lock(job_mutex);
+            stopping = true;
+            job_queued.notify_all();
+        }
+        threads.join_all();
+        for (unsigned int i = 0; i < jobs.size(); i++)
+        {
+            volk_free(jobs[i].bits);
+            volk_free(jobs[i].samples);
+        }
+    }
+
+    void
+    parallel_engine::worker(int n)
+    {
+        parallel_job *job;
+
+        if (n < (int)cores.size() && cores[n] >= 0)
+        {
+            gr::thread::thread_bind_to_processor(cores[n]);
+        }
+        gr::thread::scoped_lock lock(job_mutex);
+        for (;;)
+        {
+            while (queued == 0 && !stopping)
+            {
+                job_queued.wait(lock);
+            }
+            if (stopping)
+            {
+                break;
+            }
+            // Workers take frames in order, so the oldest frame
+            // is always being worked on.
+            job = &jobs[run_slot];
+            run_slot = (run_slot + 1) % jobs.size();
+            queued--;
+            lock.unlock();
+            chains[n]->encode_frame(job->bits, job->frame_number, job->samples);
+            lock.lock();
+            job->done = true;
+            job_done.notify_one();
+        }
+    }
+
+    int
+    parallel_engine::push(const unsigned char *in)
+    {
+        parallel_job *job = &jobs[push_slot];
+        int consumed;
+
+        // Only this thread changes pending upwards, a slot is free
+        // once its frame is popped.
+        if (pending == (int)jobs.size())
+        {
+            return -1;
+        }
+        consumed = chains[0]->encode_headers(in, job->bits);
+        job->frame_number = frame_number;
+        frame_number = (frame_number + 1) % chains[0]->superframe_frames();
+        job->done = false;
+        push_slot = (push_slot + 1) % jobs.size();
+        pending++;
+        gr::thread::scoped_lock lock(job_mutex);
+        queued++;
+        job_queued.notify_one();
+        return consumed;
+    }
+
+    void
+    parallel_engine::pop(gr_complex *out)
+    {
+        parallel_job *job = &jobs[pop_slot];
+
+        {
+            gr::thread::scoped_lock lock(job_mutex);
+            while (!job->done)
+            {
+                job_done.wait(lock);
+            }
+        }
+        memcpy(out, job->samples, sizeof(gr_complex) * frame_output_items);
+        pop_slot = (pop_slot + 1) % jobs.size();
+        pending--;
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
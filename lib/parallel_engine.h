@@ -0,0 +1,92 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef INCLUDED_DVBT2_PARALLEL_ENGINE_H
+#define INCLUDED_DVBT2_PARALLEL_ENGINE_H
+
+#include <gnuradio/thread/thread.h>
+#include <vector>
+#include "t2_chain.h"
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * Runs whole T2 frames on a pool of worker threads, one t2_chain
+     * per worker. Only the baseband header keeps state from frame to
+     * frame (packet alignment and the CRC), so the caller runs it in
+     * push() on the first chain, and any worker can do the rest of a
+     * frame once it is told the frame number. Frames finish out of
+     * order and pop() hands them back in order. The chains run the
+     * tone reservation without a time budget, which would carry state
+     * from frame to frame.
+     *
+     * The frames in flight live in a window of depth frames per
+     * worker, so the reordering memory is bounded, and push() fails
+     * when the oldest frame still has not been popped. cores[n] pins
+     * worker n to a CPU, -1 leaves it free.
+     */
+    class parallel_engine
+    {
+     private:
+      struct parallel_job
+      {
+        unsigned char *bits;
+        gr_complex *samples;
+        int frame_number;
+        bool done;
+      };
+      std::vector<t2_chain *> chains;
+      std::vector<parallel_job> jobs;
+      std::vector<int> cores;
+      boost::thread_group threads;
+      gr::thread::mutex job_mutex;
+      gr::thread::condition_variable job_queued;
+      gr::thread::condition_variable job_done;
+      int push_slot;
+      int run_slot;
+      int pop_slot;
+      int queued;
+      int pending;
+      int frame_number;
+      int frame_output_items;
+      bool stopping;
+
+      void worker(int n);
+
+     public:
+      parallel_engine(const std::vector<t2_chain *> &chains, int depth, const std::vector<int> &cores);
+      ~parallel_engine();
+
+      //! Starts a frame. Returns the bytes consumed, or -1 when the window is full.
+      int push(const unsigned char *in);
+      //! Copies the oldest frame to out, waits for it if needed.
+      void pop(gr_complex *out);
+      //! Frames pushed and not popped yet.
+      int frames() const { return pending; }
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_PARALLEL_ENGINE_H */
+
@@ -0,0 +1,390 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dvbt2/perf_block.h>
+#include "trace_buffer.h"
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
+#include <gnuradio/high_res_timer.h>
+#include <gnuradio/thread/thread.h>
+#include <boost/bind.hpp>
+#include <string.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace gr {
+  namespace dvbt2 {
+
+    // Hardware counters, read as one group.
+    enum
+    {
+      COUNTER_CYCLES = 0,
+      COUNTER_INSTRUCTIONS,
+      COUNTER_CACHE_MISSES,
+      COUNTERS
+    };
+
+    class perf_monitor
+    {
+     public:
+      gr::block *block;
+      const char *label;
+      gr::thread::mutex mutex;
+      perf_stats stats;
+      double ns_per_tick;
+      bool hardware_wanted;
+      gr::high_res_timer_type interval;
+      gr::high_res_timer_type last_publish;
+
+      // Work thread only.
+      bool running;
+      bool hardware_on;
+      bool hardware_failed;
+      bool last_blocked;
+      gr::high_res_timer_type start;
+      gr::high_res_timer_type last_end;
+      int fd[COUNTERS];
+      uint64_t counter_start[COUNTERS];
+
+      perf_monitor(gr::block *block);
+      ~perf_monitor();
+      bool open_counters();
+      void close_counters();
+      bool read_counters(uint64_t *values);
+      void begin();
+      void end(int produced);
+      void publish(const perf_stats &snapshot);
+      void query(pmt::pmt_t msg);
+    };
+
+    perf_stats::perf_stats()
+    {
+        memset(this, 0, sizeof(perf_stats));
+    }
+
+    double
+    perf_stats::ns_per_frame() const
+    {
+        return frames == 0 ? 0.0 : (double) work_ns / frames;
+    }
+
+    double
+    perf_stats::cycles_per_frame() const
+    {
+        return frames == 0 ? 0.0 : (double) cycles / frames;
+    }
+
+    perf_monitor::perf_monitor(gr::block *block)
+      : block(block),
+        label(NULL),
+        hardware_wanted(false),
+        interval(0),
+        last_publish(0),
+        running(false),
+        hardware_on(false),
+        hardware_failed(false),
+        last_blocked(false),
+        start(0),
+        last_end(0)
+    {
+        ns_per_tick = 1e9 / gr::high_res_timer_tps();
+        for (int i = 0; i < COUNTERS; i++)
+        {
+            fd[i] = -1;
+            counter_start[i] = 0;
+        }
+    }
+
+    perf_monitor::~perf_monitor()
+    {
+        close_counters();
+    }
+
+    bool
+    perf_monitor::open_counters()
+    {
+#ifdef __linux__
+        static const uint64_t config[COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+        struct perf_event_attr attr;
+
+        for (int i = 0; i < COUNTERS; i++)
+        {
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = config[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            // This thread, any CPU, cycles leading the group.
+            fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fd[0], 0);
+            if (fd[i] < 0)
+            {
+                close_counters();
+                return false;
+            }
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void
+    perf_monitor::close_counters()
+    {
+#ifdef __linux__
+        for (int i = COUNTERS - 1; i >= 0; i--)
+        {
+            if (fd[i] >= 0)
+            {
+                close(fd[i]);
+                fd[i] = -1;
+            }
+        }
+#endif
+    }
+
+    bool
+    perf_monitor::read_counters(uint64_t *values)
+    {
+#ifdef __linux__
+        uint64_t group[1 + COUNTERS];
+
+        if (read(fd[0], group, sizeof(group)) != (ssize_t) sizeof(group) || group[0] != COUNTERS)
+        {
+            return false;
+        }
+        memcpy(values, &group[1], sizeof(uint64_t) * COUNTERS);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void
+    perf_monitor::begin()
+    {
+        // Called outside of a flow graph.
+        if (!block->detail())
+        {
+            return;
+        }
+        if (hardware_on && fd[0] < 0 && !hardware_failed)
+        {
+            hardware_failed = !open_counters();
+        }
+        else if (!hardware_on && fd[0] >= 0)
+        {
+            close_counters();
+        }
+        if (fd[0] >= 0 && !read_counters(counter_start))
+        {
+            close_counters();
+            hardware_failed = true;
+        }
+        running = true;
+        start = gr::high_res_timer_now();
+    }
+
+    void
+    perf_monitor::end(int produced)
+    {
+        gr::high_res_timer_type now;
+        uint64_t work_ns, wait_ns = 0;
+        uint64_t counters[COUNTERS];
+        bool counted = false;
+        int bucket = 0;
+        bool due = false;
+        perf_stats snapshot;
+
+        if (!running)
+        {
+            return;
+        }
+        running = false;
+        now = gr::high_res_timer_now();
+        if (fd[0] >= 0 && read_counters(counters))
+        {
+            counted = true;
+        }
+        if (trace_on())
+        {
+            if (label == NULL)
+            {
+                label = trace_name(block->alias());
+            }
+            trace_record(label, TRACE_WORK, produced, start, now);
+        }
+        work_ns = (uint64_t) ((now - start) * ns_per_tick);
+        if (last_end != 0)
+        {
+            wait_ns = (uint64_t) ((start - last_end) * ns_per_tick);
+        }
+        while (bucket < perf_stats::BUCKETS - 1 && (work_ns >> (bucket + 1)) != 0)
+        {
+            bucket++;
+        }
+
+        gr::thread::scoped_lock lock(mutex);
+        stats.work_calls++;
+        stats.items += produced;
+        stats.frames += produced / block->output_multiple();
+        stats.work_ns += work_ns;
+        if (last_blocked)
+        {
+            stats.blocked_ns += wait_ns;
+        }
+        else
+        {
+            stats.starved_ns += wait_ns;
+        }
+        stats.histogram[bucket]++;
+        if (counted)
+        {
+            stats.hardware = true;
+            stats.cycles += counters[COUNTER_CYCLES] - counter_start[COUNTER_CYCLES];
+            stats.instructions += counters[COUNTER_INSTRUCTIONS] - counter_start[COUNTER_INSTRUCTIONS];
+            stats.cache_misses += counters[COUNTER_CACHE_MISSES] - counter_start[COUNTER_CACHE_MISSES];
+        }
+        hardware_on = hardware_wanted;
+        if (interval > 0 && now - last_publish >= interval)
+        {
+            last_publish = now;
+            snapshot = stats;
+            due = true;
+        }
+        lock.unlock();
+
+        // The items just produced are not in the buffer yet.
+        gr::block_detail_sptr detail = block->detail();
+        last_blocked = detail->noutputs() > 0 && detail->output(0)->space_available() - produced < block->output_multiple();
+        last_end = gr::high_res_timer_now();
+        if (due)
+        {
+            publish(snapshot);
+        }
+    }
+
+    void
+    perf_monitor::publish(const perf_stats &snapshot)
+    {
+        pmt::pmt_t dict;
+
+        dict = pmt::make_dict();
+        dict = pmt::dict_add(dict, pmt::mp("name"), pmt::mp(block->alias()));
+        dict = pmt::dict_add(dict, pmt::mp("work_calls"), pmt::from_uint64(snapshot.work_calls));
+        dict = pmt::dict_add(dict, pmt::mp("items"), pmt::from_uint64(snapshot.items));
+        dict = pmt::dict_add(dict, pmt::mp("frames"), pmt::from_uint64(snapshot.frames));
+        dict = pmt::dict_add(dict, pmt::mp("work_ns"), pmt::from_uint64(snapshot.work_ns));
+        dict = pmt::dict_add(dict, pmt::mp("starved_ns"), pmt::from_uint64(snapshot.starved_ns));
+        dict = pmt::dict_add(dict, pmt::mp("blocked_ns"), pmt::from_uint64(snapshot.blocked_ns));
+        dict = pmt::dict_add(dict, pmt::mp("ns_per_frame"), pmt::from_double(snapshot.ns_per_frame()));
+        dict = pmt::dict_add(dict, pmt::mp("histogram"), pmt::init_u64vector(perf_stats::BUCKETS, snapshot.histogram));
+        dict = pmt::dict_add(dict, pmt::mp("hardware"), pmt::from_bool(snapshot.hardware));
+        dict = pmt::dict_add(dict, pmt::mp("cycles"), pmt::from_uint64(snapshot.cycles));
+        dict = pmt::dict_add(dict, pmt::mp("instructions"), pmt::from_uint64(snapshot.instructions));
+        dict = pmt::dict_add(dict, pmt::mp("cache_misses"), pmt::from_uint64(snapshot.cache_misses));
+        dict = pmt::dict_add(dict, pmt::mp("cycles_per_frame"), pmt::from_double(snapshot.cycles_per_frame()));
+        block->message_port_pub(pmt::mp("perf"), dict);
+    }
+
+    void
+    perf_monitor::query(pmt::pmt_t msg)
+    {
+        perf_stats snapshot;
+        {
+            gr::thread::scoped_lock lock(mutex);
+            snapshot = stats;
+        }
+        publish(snapshot);
+    }
+
+    perf_block::perf_block()
+      : monitor(NULL)
+    {
+    }
+
+    perf_block::~perf_block()
+    {
+        delete monitor;
+    }
+
+    void
+    perf_block::perf_attach(gr::block *block)
+    {
+        monitor = new perf_monitor(block);
+        block->message_port_register_out(pmt::mp("perf"));
+        block->message_port_register_in(pmt::mp("perf_query"));
+        block->set_msg_handler(pmt::mp("perf_query"), boost::bind(&perf_monitor::query, monitor, _1));
+    }
+
+    void
+    perf_block::perf_begin()
+    {
+        monitor->begin();
+    }
+
+    void
+    perf_block::perf_end(int produced)
+    {
+        monitor->end(produced);
+    }
+
+    perf_stats
+    perf_block::perf() const
+    {
+        gr::thread::scoped_lock lock(monitor->mutex);
+        return monitor->stats;
+    }
+
+    void
+    perf_block::reset_perf()
+    {
+        gr::thread::scoped_lock lock(monitor->mutex);
+        monitor->stats = perf_stats();
+    }
+
+    void
+    perf_block::set_hardware_counters(bool enable)
+    {
+        gr::thread::scoped_lock lock(monitor->mutex);
+        monitor->hardware_wanted = enable;
+    }
+
+    void
+    perf_block::set_perf_interval(double seconds)
+    {
+        gr::thread::scoped_lock lock(monitor->mutex);
+        monitor->interval = (gr::high_res_timer_type) (seconds * gr::high_res_timer_tps());
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
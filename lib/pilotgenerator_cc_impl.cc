@@ -24,98 +24,57 @@
 
 #include <gnuradio/io_signature.h>
 #include "pilotgenerator_cc_impl.h"
+#include <dvbt2/t2_geometry.h>
+#include "trace_buffer.h"
+#include <boost/bind.hpp>
 #include <volk/volk.h>
 #include <stdio.h>
+#include <new>
 
 namespace gr {
   namespace dvbt2 {
 
     pilotgenerator_cc::sptr
-    pilotgenerator_cc::make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, int vlength)
+    pilotgenerator_cc::make(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, int vlength, dvbt2_constellation_t constellation, dvbt2_rotation_t rotation, float acevclip, float acegain, float acelimit, int aceiterations)
     {
       return gnuradio::get_initial_sptr
-        (new pilotgenerator_cc_impl(carriermode, fftsize, pilotpattern, guardinterval, numdatasyms, paprmode, version, preamble, misogroup, equalization, bandwidth, vlength));
+        (new pilotgenerator_cc_impl(carriermode, fftsize, pilotpattern, guardinterval, numdatasyms, paprmode, version, preamble, misogroup, equalization, bandwidth, vlength, constellation, rotation, acevclip, acegain, acelimit, aceiterations));
     }
 
     /*
      * The private constructor
      */
-    pilotgenerator_cc_impl::pilotgenerator_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, int vlength)
+    pilotgenerator_cc_impl::pilotgenerator_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, int vlength, dvbt2_constellation_t constellation, dvbt2_rotation_t rotation, float acevclip, float acegain, float acelimit, int aceiterations)
       : gr::block("pilotgenerator_cc",
               gr::io_signature::make(1, 1, sizeof(gr_complex)),
-              gr::io_signature::make(1, 1, sizeof(gr_complex) * vlength))
+              gr::io_signature::make(misogroup == gr::dvbt2::MISO_BOTH ? 2 : 1, misogroup == gr::dvbt2::MISO_BOTH ? 2 : 1, sizeof(gr_complex) * vlength))
     {
         int step, ki;
         double x, sinc, sincrms = 0.0;
+        double outer;
         double fs, fstep, f = 0.0;
         miso_group = misogroup;
+        miso_both = FALSE;
+        if (misogroup == gr::dvbt2::MISO_BOTH)
+        {
+            // The maps are built for TX2, TX1 maps the inverted pilots
+            // back to the normal ones in modulate_frame().
+            miso_both = TRUE;
+            miso_group = MISO_TX2;
+        }
+        t2_geometry geometry(carriermode, fftsize, pilotpattern, guardinterval, paprmode, preamble);
+        N_P2 = geometry.N_P2;
+        C_P2 = geometry.C_P2;
+        C_DATA = geometry.C_DATA;
+        N_FC = geometry.N_FC;
+        C_FC = geometry.C_FC;
         if ((preamble == gr::dvbt2::PREAMBLE_T2_SISO) || (preamble == gr::dvbt2::PREAMBLE_T2_LITE_SISO))
         {
             miso = FALSE;
-            switch (fftsize)
-            {
-                case gr::dvbt2::FFTSIZE_1K:
-                    N_P2 = 16;
-                    C_P2 = 558;
-                    break;
-                case gr::dvbt2::FFTSIZE_2K:
-                    N_P2 = 8;
-                    C_P2 = 1118;
-                    break;
-                case gr::dvbt2::FFTSIZE_4K:
-                    N_P2 = 4;
-                    C_P2 = 2236;
-                    break;
-                case gr::dvbt2::FFTSIZE_8K:
-                case gr::dvbt2::FFTSIZE_8K_T2GI:
-                    N_P2 = 2;
-                    C_P2 = 4472;
-                    break;
-                case gr::dvbt2::FFTSIZE_16K:
-                case gr::dvbt2::FFTSIZE_16K_T2GI:
-                    N_P2 = 1;
-                    C_P2 = 8944;
-                    break;
-                case gr::dvbt2::FFTSIZE_32K:
-                case gr::dvbt2::FFTSIZE_32K_T2GI:
-                    N_P2 = 1;
-                    C_P2 = 22432;
-                    break;
-            }
         }
         else
         {
             miso = TRUE;
-            switch (fftsize)
-            {
-                case gr::dvbt2::FFTSIZE_1K:
-                    N_P2 = 16;
-                    C_P2 = 546;
-                    break;
-                case gr::dvbt2::FFTSIZE_2K:
-                    N_P2 = 8;
-                    C_P2 = 1098;
-                    break;
-                case gr::dvbt2::FFTSIZE_4K:
-                    N_P2 = 4;
-                    C_P2 = 2198;
-                    break;
-                case gr::dvbt2::FFTSIZE_8K:
-                case gr::dvbt2::FFTSIZE_8K_T2GI:
-                    N_P2 = 2;
-                    C_P2 = 4398;
-                    break;
-                case gr::dvbt2::FFTSIZE_16K:
-                case gr::dvbt2::FFTSIZE_16K_T2GI:
-                    N_P2 = 1;
-                    C_P2 = 8814;
-                    break;
-                case gr::dvbt2::FFTSIZE_32K:
-                case gr::dvbt2::FFTSIZE_32K_T2GI:
-                    N_P2 = 1;
-                    C_P2 = 17612;
-                    break;
-            }
         }
         switch (fftsize)
         {
@@ -180,542 +139,6 @@ namespace gr {
                 }
                 break;
         }
-        switch (fftsize)
-        {
-            case gr::dvbt2::FFTSIZE_1K:
-                switch (pilotpattern)
-                {
-                    case gr::dvbt2::PILOT_PP1:
-                        C_DATA = 764;
-                        N_FC = 568;
-                        C_FC = 402;
-                        break;
-                    case gr::dvbt2::PILOT_PP2:
-                        C_DATA = 768;
-                        N_FC = 710;
-                        C_FC = 654;
-                        break;
-                    case gr::dvbt2::PILOT_PP3:
-                        C_DATA = 798;
-                        N_FC = 710;
-                        C_FC = 490;
-                        break;
-                    case gr::dvbt2::PILOT_PP4:
-                        C_DATA = 804;
-                        N_FC = 780;
-                        C_FC = 707;
-                        break;
-                    case gr::dvbt2::PILOT_PP5:
-                        C_DATA = 818;
-                        N_FC = 780;
-                        C_FC = 544;
-                        break;
-                    case gr::dvbt2::PILOT_PP6:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP7:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP8:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 10;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 10;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 10;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_2K:
-                switch (pilotpattern)
-                {
-                    case gr::dvbt2::PILOT_PP1:
-                        C_DATA = 1522;
-                        N_FC = 1136;
-                        C_FC = 804;
-                        break;
-                    case gr::dvbt2::PILOT_PP2:
-                        C_DATA = 1532;
-                        N_FC = 1420;
-                        C_FC = 1309;
-                        break;
-                    case gr::dvbt2::PILOT_PP3:
-                        C_DATA = 1596;
-                        N_FC = 1420;
-                        C_FC = 980;
-                        break;
-                    case gr::dvbt2::PILOT_PP4:
-                        C_DATA = 1602;
-                        N_FC = 1562;
-                        C_FC = 1415;
-                        break;
-                    case gr::dvbt2::PILOT_PP5:
-                        C_DATA = 1632;
-                        N_FC = 1562;
-                        C_FC = 1088;
-                        break;
-                    case gr::dvbt2::PILOT_PP6:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP7:
-                        C_DATA = 1646;
-                        N_FC = 1632;
-                        C_FC = 1396;
-                        break;
-                    case gr::dvbt2::PILOT_PP8:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 18;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 18;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 18;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_4K:
-                switch (pilotpattern)
-                {
-                    case gr::dvbt2::PILOT_PP1:
-                        C_DATA = 3084;
-                        N_FC = 2272;
-                        C_FC = 1609;
-                        break;
-                    case gr::dvbt2::PILOT_PP2:
-                        C_DATA = 3092;
-                        N_FC = 2840;
-                        C_FC = 2619;
-                        break;
-                    case gr::dvbt2::PILOT_PP3:
-                        C_DATA = 3228;
-                        N_FC = 2840;
-                        C_FC = 1961;
-                        break;
-                    case gr::dvbt2::PILOT_PP4:
-                        C_DATA = 3234;
-                        N_FC = 3124;
-                        C_FC = 2831;
-                        break;
-                    case gr::dvbt2::PILOT_PP5:
-                        C_DATA = 3298;
-                        N_FC = 3124;
-                        C_FC = 2177;
-                        break;
-                    case gr::dvbt2::PILOT_PP6:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                    case gr::dvbt2::PILOT_PP7:
-                        C_DATA = 3328;
-                        N_FC = 3266;
-                        C_FC = 2792;
-                        break;
-                    case gr::dvbt2::PILOT_PP8:
-                        C_DATA = 0;
-                        N_FC = 0;
-                        C_FC = 0;
-                        break;
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 36;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 36;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 36;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_8K:
-            case gr::dvbt2::FFTSIZE_8K_T2GI:
-                if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 6208;
-                            N_FC = 4544;
-                            C_FC = 3218;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 6214;
-                            N_FC = 5680;
-                            C_FC = 5238;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 6494;
-                            N_FC = 5680;
-                            C_FC = 3922;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 6498;
-                            N_FC = 6248;
-                            C_FC = 5662;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 6634;
-                            N_FC = 6248;
-                            C_FC = 4354;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 6698;
-                            N_FC = 6532;
-                            C_FC = 5585;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 6698;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                else
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 6296;
-                            N_FC = 4608;
-                            C_FC = 3264;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 6298;
-                            N_FC = 5760;
-                            C_FC = 5312;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 6584;
-                            N_FC = 5760;
-                            C_FC = 3978;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 6588;
-                            N_FC = 6336;
-                            C_FC = 5742;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 6728;
-                            N_FC = 6336;
-                            C_FC = 4416;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 6788;
-                            N_FC = 6624;
-                            C_FC = 5664;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 6788;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 72;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 72;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 72;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_16K:
-            case gr::dvbt2::FFTSIZE_16K_T2GI:
-                if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 12418;
-                            N_FC = 9088;
-                            C_FC = 6437;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 12436;
-                            N_FC = 11360;
-                            C_FC = 10476;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 12988;
-                            N_FC = 11360;
-                            C_FC = 7845;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 13002;
-                            N_FC = 12496;
-                            C_FC = 11324;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 13272;
-                            N_FC = 12496;
-                            C_FC = 8709;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 13288;
-                            N_FC = 13064;
-                            C_FC = 11801;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 13416;
-                            N_FC = 13064;
-                            C_FC = 11170;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 13406;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                else
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 12678;
-                            N_FC = 9280;
-                            C_FC = 6573;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 12698;
-                            N_FC = 11600;
-                            C_FC = 10697;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 13262;
-                            N_FC = 11600;
-                            C_FC = 8011;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 13276;
-                            N_FC = 12760;
-                            C_FC = 11563;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 13552;
-                            N_FC = 12760;
-                            C_FC = 8893;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 13568;
-                            N_FC = 13340;
-                            C_FC = 12051;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 13698;
-                            N_FC = 13340;
-                            C_FC = 11406;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 13688;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 144;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 144;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 144;
-                    }
-                }
-                break;
-            case gr::dvbt2::FFTSIZE_32K:
-            case gr::dvbt2::FFTSIZE_32K_T2GI:
-                if (carriermode == gr::dvbt2::CARRIERS_NORMAL)
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 24886;
-                            N_FC = 22720;
-                            C_FC = 20952;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 26022;
-                            N_FC = 24992;
-                            C_FC = 22649;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 26592;
-                            N_FC = 26128;
-                            C_FC = 23603;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 26836;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 26812;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                else
-                {
-                    switch (pilotpattern)
-                    {
-                        case gr::dvbt2::PILOT_PP1:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP2:
-                            C_DATA = 25412;
-                            N_FC = 23200;
-                            C_FC = 21395;
-                            break;
-                        case gr::dvbt2::PILOT_PP3:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP4:
-                            C_DATA = 26572;
-                            N_FC = 25520;
-                            C_FC = 23127;
-                            break;
-                        case gr::dvbt2::PILOT_PP5:
-                            C_DATA = 0;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP6:
-                            C_DATA = 27152;
-                            N_FC = 26680;
-                            C_FC = 24102;
-                            break;
-                        case gr::dvbt2::PILOT_PP7:
-                            C_DATA = 27404;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                        case gr::dvbt2::PILOT_PP8:
-                            C_DATA = 27376;
-                            N_FC = 0;
-                            C_FC = 0;
-                            break;
-                    }
-                }
-                if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
-                {
-                    if (C_DATA != 0)
-                    {
-                        C_DATA -= 288;
-                    }
-                    if (N_FC != 0)
-                    {
-                        N_FC -= 288;
-                    }
-                    if (C_FC != 0)
-                    {
-                        C_FC -= 288;
-                    }
-                }
-                break;
-        }
-        if (miso == FALSE)
-        {
-            if (guardinterval == gr::dvbt2::GI_1_128 && pilotpattern == gr::dvbt2::PILOT_PP7)
-            {
-                N_FC = 0;
-                C_FC = 0;
-            }
-            if (guardinterval == gr::dvbt2::GI_1_32 && pilotpattern == gr::dvbt2::PILOT_PP4)
-            {
-                N_FC = 0;
-                C_FC = 0;
-            }
-            if (guardinterval == gr::dvbt2::GI_1_16 && pilotpattern == gr::dvbt2::PILOT_PP2)
-            {
-                N_FC = 0;
-                C_FC = 0;
-            }
-            if (guardinterval == gr::dvbt2::GI_19_256 && pilotpattern == gr::dvbt2::PILOT_PP2)
-            {
-                N_FC = 0;
-                C_FC = 0;
-            }
-        }
         init_prbs();
         for (int i = 0; i < C_PS; i++)
         {
@@ -1283,14 +706,7 @@ namespace gr {
                     break;
             }
         }
-        if (N_FC == 0)
-        {
-            active_items = (N_P2 * C_P2) + (numdatasyms * C_DATA);
-        }
-        else
-        {
-            active_items = (N_P2 * C_P2) + ((numdatasyms - 1) * C_DATA) + N_FC;
-        }
+        active_items = geometry.frame_cells(numdatasyms);
         fft_size = fftsize;
         pilot_pattern = pilotpattern;
         carrier_mode = carriermode;
@@ -1370,9 +786,96 @@ namespace gr {
         }
         equalization_enable = equalization;
         ofdm_fft_size = vlength;
-        ofdm_fft = new fft::fft_complex(ofdm_fft_size, false, 1);
+        if (paprmode == gr::dvbt2::PAPR_ACE || paprmode == gr::dvbt2::PAPR_BOTH)
+        {
+            // ACE is only allowed with non-rotated constellations. With
+            // rotation on only the ACE half is left out, PAPR_BOTH still
+            // runs tone reservation as it always has. The warning is
+            // given once, not for every chain of a parallel engine.
+            if (rotation == gr::dvbt2::ROTATION_ON)
+            {
+                static bool warned = false;
+                if (!warned)
+                {
+                    fprintf(stderr, "Pilot generator, ACE needs rotation off, ACE disabled.\n");
+                    warned = true;
+                }
+                ace_enable = FALSE;
+            }
+            else
+            {
+                ace_enable = TRUE;
+            }
+        }
+        else
+        {
+            ace_enable = FALSE;
+        }
+        // A cell component is an outer point when it is above the
+        // midpoint between the outer and the next inner level.
+        switch (constellation)
+        {
+            case gr::dvbt2::MOD_QPSK:
+                ace_threshold = 0.0;
+                outer = 1.0 / sqrt(2.0);
+                break;
+            case gr::dvbt2::MOD_16QAM:
+                ace_threshold = 2.0 / sqrt(10.0);
+                outer = 3.0 / sqrt(10.0);
+                break;
+            case gr::dvbt2::MOD_64QAM:
+                ace_threshold = 6.0 / sqrt(42.0);
+                outer = 7.0 / sqrt(42.0);
+                break;
+            case gr::dvbt2::MOD_256QAM:
+                ace_threshold = 14.0 / sqrt(170.0);
+                outer = 15.0 / sqrt(170.0);
+                break;
+            default:
+                ace_threshold = 0.0;
+                outer = 1.0 / sqrt(2.0);
+                break;
+        }
+        ace_vclip = acevclip;
+        ace_gain = acegain;
+        ace_limit = acelimit < outer ? outer : acelimit;
+        ace_iterations = aceiterations;
+        for (int i = 0; i < dy; i++)
+        {
+            init_pilots(i);
+            memcpy(pilot_maps[i], data_carrier_map, sizeof(int) * C_PS);
+        }
+        num_groups = 1;
+        new_group(&group[0]);
+        group[0].p2_inverted = p2_bpsk_inverted;
+        group[0].sp_inverted = sp_bpsk_inverted;
+        group[0].cp_inverted = cp_bpsk_inverted;
+        if (miso_both == TRUE)
+        {
+            tx2_cells = (gr_complex*) volk_malloc(sizeof(gr_complex) * active_items, volk_get_alignment());
+            if (tx2_cells == NULL)
+            {
+                fprintf(stderr, "Pilot generator MISO volk_malloc, Out of memory.\n");
+                delete_group(&group[0]);
+                throw std::bad_alloc();
+            }
+            num_groups = 2;
+            new_group(&group[1]);
+            group[0].p2_inverted = p2_bpsk;
+            group[0].sp_inverted = sp_bpsk;
+            group[0].cp_inverted = cp_bpsk;
+            group[1].p2_inverted = p2_bpsk_inverted;
+            group[1].sp_inverted = sp_bpsk_inverted;
+            group[1].cp_inverted = cp_bpsk_inverted;
+            alamouti = alamouti_select();
+            frame_count = 0;
+            frame_pending = FALSE;
+            workers_stop = FALSE;
+            workers.create_thread(boost::bind(&pilotgenerator_cc_impl::worker, this));
+        }
         num_symbols = numdatasyms + N_P2;
         set_output_multiple(num_symbols);
+        perf_attach(this);
     }
 
     /*
@@ -1380,7 +883,20 @@ namespace gr {
      */
     pilotgenerator_cc_impl::~pilotgenerator_cc_impl()
     {
-        delete ofdm_fft;
+        if (miso_both == TRUE)
+        {
+            {
+                gr::thread::scoped_lock lock(frame_mutex);
+                workers_stop = TRUE;
+                frame_ready.notify_all();
+            }
+            workers.join_all();
+            volk_free(tx2_cells);
+        }
+        for (int i = 0; i < num_groups; i++)
+        {
+            delete_group(&group[i]);
+        }
     }
 
     void
@@ -1389,6 +905,95 @@ namespace gr {
         ninput_items_required[0] = active_items * (noutput_items / num_symbols);
     }
 
+// Each group owns the FFT plans and ACE buffers of one transmitter
+// output, everything else is shared read-only.
+void pilotgenerator_cc_impl::new_group(pilotgenerator_group *g)
+{
+    g->ofdm_fft = new fft::fft_complex(ofdm_fft_size, false, 1);
+    if (ace_enable == TRUE)
+    {
+        g->ace_fft = new fft::fft_complex(ofdm_fft_size, true, 1);
+        g->ace_cells = (gr_complex*) volk_malloc(sizeof(gr_complex) * ofdm_fft_size, volk_get_alignment());
+        if (g->ace_cells == NULL)
+        {
+            fprintf(stderr, "Pilot generator ACE 1st volk_malloc, Out of memory.\n");
+            delete g->ace_fft;
+            delete g->ofdm_fft;
+            throw std::bad_alloc();
+        }
+        g->ace_time = (gr_complex*) volk_malloc(sizeof(gr_complex) * ofdm_fft_size, volk_get_alignment());
+        if (g->ace_time == NULL)
+        {
+            fprintf(stderr, "Pilot generator ACE 2nd volk_malloc, Out of memory.\n");
+            volk_free(g->ace_cells);
+            delete g->ace_fft;
+            delete g->ofdm_fft;
+            throw std::bad_alloc();
+        }
+        g->ace_correction = (gr_complex*) volk_malloc(sizeof(gr_complex) * ofdm_fft_size, volk_get_alignment());
+        if (g->ace_correction == NULL)
+        {
+            fprintf(stderr, "Pilot generator ACE 3rd volk_malloc, Out of memory.\n");
+            volk_free(g->ace_time);
+            volk_free(g->ace_cells);
+            delete g->ace_fft;
+            delete g->ofdm_fft;
+            throw std::bad_alloc();
+        }
+        g->ace_magnitude = (float*) volk_malloc(sizeof(float) * ofdm_fft_size, volk_get_alignment());
+        if (g->ace_magnitude == NULL)
+        {
+            fprintf(stderr, "Pilot generator ACE 4th volk_malloc, Out of memory.\n");
+            volk_free(g->ace_correction);
+            volk_free(g->ace_time);
+            volk_free(g->ace_cells);
+            delete g->ace_fft;
+            delete g->ofdm_fft;
+            throw std::bad_alloc();
+        }
+        g->ace_lower = (float*) volk_malloc(sizeof(float) * ofdm_fft_size * 2, volk_get_alignment());
+        if (g->ace_lower == NULL)
+        {
+            fprintf(stderr, "Pilot generator ACE 5th volk_malloc, Out of memory.\n");
+            volk_free(g->ace_magnitude);
+            volk_free(g->ace_correction);
+            volk_free(g->ace_time);
+            volk_free(g->ace_cells);
+            delete g->ace_fft;
+            delete g->ofdm_fft;
+            throw std::bad_alloc();
+        }
+        g->ace_upper = (float*) volk_malloc(sizeof(float) * ofdm_fft_size * 2, volk_get_alignment());
+        if (g->ace_upper == NULL)
+        {
+            fprintf(stderr, "Pilot generator ACE 6th volk_malloc, Out of memory.\n");
+            volk_free(g->ace_lower);
+            volk_free(g->ace_magnitude);
+            volk_free(g->ace_correction);
+            volk_free(g->ace_time);
+            volk_free(g->ace_cells);
+            delete g->ace_fft;
+            delete g->ofdm_fft;
+            throw std::bad_alloc();
+        }
+    }
+}
+
+void pilotgenerator_cc_impl::delete_group(pilotgenerator_group *g)
+{
+    if (ace_enable == TRUE)
+    {
+        volk_free(g->ace_upper);
+        volk_free(g->ace_lower);
+        volk_free(g->ace_magnitude);
+        volk_free(g->ace_correction);
+        volk_free(g->ace_time);
+        volk_free(g->ace_cells);
+        delete g->ace_fft;
+    }
+    delete g->ofdm_fft;
+}
+
 void pilotgenerator_cc_impl::init_prbs(void)
 {
     int sr = 0x7ff;
@@ -3430,144 +3035,314 @@ void pilotgenerator_cc_impl::init_pilots(int symbol)
     }
 }
 
+// Active Constellation Extension (EN 302 755 section 9.3.1). The clipping
+// noise of the time domain symbol is transformed back to the carriers,
+// scaled by G and added to the data cells. Only the outer components of
+// a cell may move, and only away from the origin, up to ace_limit. The
+// bounds of each component are set once per symbol, so an iteration is
+// an add and a clamp over the whole symbol.
+void pilotgenerator_cc_impl::active_ace(pilotgenerator_group *g, gr_complex *symbol, const int *carrier_map)
+{
+    gr_complex *dst;
+    const gr_complex *src;
+    gr_complex scale;
+    float *cell, *orig, *lower, *upper, factor;
+    unsigned int peak;
+
+    memcpy(g->ace_cells, symbol, sizeof(gr_complex) * ofdm_fft_size);
+    orig = (float *) &g->ace_cells[left_nulls];
+    lower = g->ace_lower;
+    upper = g->ace_upper;
+    for (int n = 0; n < C_PS; n++)
+    {
+        for (int c = 0; c < 2; c++)
+        {
+            if (carrier_map[n] == DATA_CARRIER && orig[c] > ace_threshold)
+            {
+                lower[c] = orig[c];
+                upper[c] = ace_limit;
+            }
+            else if (carrier_map[n] == DATA_CARRIER && orig[c] < -ace_threshold)
+            {
+                lower[c] = -ace_limit;
+                upper[c] = orig[c];
+            }
+            else
+            {
+                lower[c] = orig[c];
+                upper[c] = orig[c];
+            }
+        }
+        orig += 2;
+        lower += 2;
+        upper += 2;
+    }
+    cell = (float *) &symbol[left_nulls];
+    scale.real() = ace_gain / (normalization * ofdm_fft_size);
+    scale.imag() = 0.0;
+    for (int k = 0; k < ace_iterations; k++)
+    {
+        dst = g->ofdm_fft->get_inbuf();
+        memcpy(&dst[ofdm_fft_size / 2], &symbol[0], sizeof(gr_complex) * ofdm_fft_size / 2);
+        memcpy(&dst[0], &symbol[ofdm_fft_size / 2], sizeof(gr_complex) * ofdm_fft_size / 2);
+        g->ofdm_fft->execute();
+        volk_32fc_s32fc_multiply_32fc(g->ace_time, g->ofdm_fft->get_outbuf(), normalization, ofdm_fft_size);
+        volk_32fc_magnitude_32f(g->ace_magnitude, g->ace_time, ofdm_fft_size);
+        volk_32f_index_max_32u(&peak, g->ace_magnitude, ofdm_fft_size);
+        if (g->ace_magnitude[peak] <= ace_vclip)
+        {
+            break;
+        }
+        // clip(x) - x, the magnitude buffer takes the factor
+        for (int n = 0; n < ofdm_fft_size; n++)
+        {
+            factor = ace_vclip / g->ace_magnitude[n];
+            g->ace_magnitude[n] = factor < 1.0f ? factor - 1.0f : 0.0f;
+        }
+        volk_32fc_32f_multiply_32fc(g->ace_fft->get_inbuf(), g->ace_time, g->ace_magnitude, ofdm_fft_size);
+        g->ace_fft->execute();
+        src = g->ace_fft->get_outbuf();
+        volk_32fc_s32fc_multiply_32fc(&g->ace_correction[ofdm_fft_size / 2], &src[0], scale, ofdm_fft_size / 2);
+        volk_32fc_s32fc_multiply_32fc(&g->ace_correction[0], &src[ofdm_fft_size / 2], scale, ofdm_fft_size / 2);
+        volk_32f_x2_add_32f(cell, cell, (const float *) &g->ace_correction[left_nulls], C_PS * 2);
+        volk_32f_x2_max_32f(cell, cell, g->ace_lower, C_PS * 2);
+        volk_32f_x2_min_32f(cell, cell, g->ace_upper, C_PS * 2);
+    }
+}
+
+// One frame of one transmitter output. The INVERTED carriers use the
+// tables of the group, so MISO TX1 and TX2 can share the carrier maps.
+void pilotgenerator_cc_impl::modulate_frame(pilotgenerator_group *g, const gr_complex *in, gr_complex *out)
+{
+    gr_complex zero;
+    gr_complex *dst;
+    const int *data_map;
+    int L_FC = 0;
+    gr::high_res_timer_type start;
+
+    zero.real() = 0.0;
+    zero.imag() = 0.0;
+    if (N_FC != 0)
+    {
+        L_FC = 1;
+    }
+    for (int j = 0; j < num_symbols; j++)
+    {
+        start = trace_now();
+        data_map = pilot_maps[j % dy];
+        if (j < N_P2)
+        {
+            for (int n = 0; n < left_nulls; n++)
+            {
+                *out++ = zero;
+            }
+            for (int n = 0; n < C_PS; n++)
+            {
+                if (p2_carrier_map[n] == P2PILOT_CARRIER)
+                {
+                    *out++ = p2_bpsk[prbs[n + K_OFFSET] ^ pn_sequence[j]];
+                }
+                else if (p2_carrier_map[n] == P2PILOT_CARRIER_INVERTED)
+                {
+                    *out++ = g->p2_inverted[prbs[n + K_OFFSET] ^ pn_sequence[j]];
+                }
+                else if (p2_carrier_map[n] == P2PAPR_CARRIER)
+                {
+                    *out++ = zero;
+                }
+                else
+                {
+                    *out++ = *in++;
+                }
+            }
+            for (int n = 0; n < right_nulls; n++)
+            {
+                *out++ = zero;
+            }
+        }
+        else if (j == (num_symbols - L_FC))
+        {
+            for (int n = 0; n < left_nulls; n++)
+            {
+                *out++ = zero;
+            }
+            for (int n = 0; n < C_PS; n++)
+            {
+                if (fc_carrier_map[n] == SCATTERED_CARRIER)
+                {
+                    *out++ = sp_bpsk[prbs[n + K_OFFSET] ^ pn_sequence[j]];
+                }
+                else if (fc_carrier_map[n] == SCATTERED_CARRIER_INVERTED)
+                {
+                    *out++ = g->sp_inverted[prbs[n + K_OFFSET] ^ pn_sequence[j]];
+                }
+                else if (fc_carrier_map[n] == TRPAPR_CARRIER)
+                {
+                    *out++ = zero;
+                }
+                else
+                {
+                    *out++ = *in++;
+                }
+            }
+            for (int n = 0; n < right_nulls; n++)
+            {
+                *out++ = zero;
+            }
+        }
+        else
+        {
+            for (int n = 0; n < left_nulls; n++)
+            {
+                *out++ = zero;
+            }
+            for (int n = 0; n < C_PS; n++)
+            {
+                if (data_map[n] == SCATTERED_CARRIER)
+                {
+                    *out++ = sp_bpsk[prbs[n + K_OFFSET] ^ pn_sequence[j]];
+                }
+                else if (data_map[n] == SCATTERED_CARRIER_INVERTED)
+                {
+                    *out++ = g->sp_inverted[prbs[n + K_OFFSET] ^ pn_sequence[j]];
+                }
+                else if (data_map[n] == CONTINUAL_CARRIER)
+                {
+                    *out++ = cp_bpsk[prbs[n + K_OFFSET] ^ pn_sequence[j]];
+                }
+                else if (data_map[n] == CONTINUAL_CARRIER_INVERTED)
+                {
+                    *out++ = g->cp_inverted[prbs[n + K_OFFSET] ^ pn_sequence[j]];
+                }
+                else if (data_map[n] == TRPAPR_CARRIER)
+                {
+                    *out++ = zero;
+                }
+                else
+                {
+                    *out++ = *in++;
+                }
+            }
+            for (int n = 0; n < right_nulls; n++)
+            {
+                *out++ = zero;
+            }
+        }
+        out -= ofdm_fft_size;
+        if (ace_enable == TRUE && j >= N_P2)
+        {
+            if (j == (num_symbols - L_FC))
+            {
+                active_ace(g, out, fc_carrier_map);
+            }
+            else
+            {
+                active_ace(g, out, data_map);
+            }
+        }
+        if (equalization_enable == gr::dvbt2::EQUALIZATION_ON)
+        {
+            volk_32fc_x2_multiply_32fc(out, out, inverse_sinc, ofdm_fft_size);
+        }
+        dst = g->ofdm_fft->get_inbuf();
+        memcpy(&dst[ofdm_fft_size / 2], &out[0], sizeof(gr_complex) * ofdm_fft_size / 2);
+        memcpy(&dst[0], &out[ofdm_fft_size / 2], sizeof(gr_complex) * ofdm_fft_size / 2);
+        g->ofdm_fft->execute();
+        volk_32fc_s32fc_multiply_32fc(out, g->ofdm_fft->get_outbuf(), normalization, ofdm_fft_size);
+        out += ofdm_fft_size;
+        trace_span("ofdm_symbol", TRACE_SYMBOL, j, start);
+    }
+}
+
+void pilotgenerator_cc_impl::worker(void)
+{
+    unsigned int frame = 0;
+    const gr_complex *in;
+    gr_complex *out;
+    gr::thread::scoped_lock lock(frame_mutex);
+
+    while (workers_stop == FALSE)
+    {
+        if (frame == frame_count)
+        {
+            frame_ready.wait(lock);
+            continue;
+        }
+        frame = frame_count;
+        in = frame_in;
+        out = frame_out;
+        lock.unlock();
+        modulate_frame(&group[1], in, out);
+        lock.lock();
+        frame_pending = FALSE;
+        frame_done.notify_all();
+    }
+}
+
     int
-    pilotgenerator_cc_impl::general_work (int noutput_items,
-                       gr_vector_int &ninput_items,
+    pilotgenerator_cc_impl::process(int noutput_items,
                        gr_vector_const_void_star &input_items,
                        gr_vector_void_star &output_items)
     {
         const gr_complex *in = (const gr_complex *) input_items[0];
         gr_complex *out = (gr_complex *) output_items[0];
-        gr_complex zero;
-        gr_complex *dst;
-        int L_FC = 0;
+        gr_complex *out2;
 
-        zero.real() = 0.0;
-        zero.imag() = 0.0;
-        if (N_FC != 0)
-        {
-            L_FC = 1;
-        }
         for (int i = 0; i < noutput_items; i += num_symbols)
         {
-            for (int j = 0; j < num_symbols; j++)
+            if (miso_both == TRUE)
             {
-                init_pilots(j);
-                if (j < N_P2)
+                // TX2 is modulated on the worker thread while this
+                // thread does TX1, the two outputs stay sample aligned.
+                out2 = (gr_complex *) output_items[1] + (i * ofdm_fft_size);
+                if (miso == TRUE)
                 {
-                    for (int n = 0; n < left_nulls; n++)
-                    {
-                        *out++ = zero;
-                    }
-                    for (int n = 0; n < C_PS; n++)
-                    {
-                        if (p2_carrier_map[n] == P2PILOT_CARRIER)
-                        {
-                            *out++ = p2_bpsk[prbs[n + K_OFFSET] ^ pn_sequence[j]];
-                        }
-                        else if (p2_carrier_map[n] == P2PILOT_CARRIER_INVERTED)
-                        {
-                            *out++ = p2_bpsk_inverted[prbs[n + K_OFFSET] ^ pn_sequence[j]];
-                        }
-                        else if (p2_carrier_map[n] == P2PAPR_CARRIER)
-                        {
-                            *out++ = zero;
-                        }
-                        else
-                        {
-                            *out++ = *in++;
-                        }
-                    }
-                    for (int n = 0; n < right_nulls; n++)
-                    {
-                        *out++ = zero;
-                    }
+                    alamouti(tx2_cells, in, active_items / 2);
                 }
-                else if (j == (num_symbols - L_FC))
+                else
                 {
-                    for (int n = 0; n < left_nulls; n++)
-                    {
-                        *out++ = zero;
-                    }
-                    for (int n = 0; n < C_PS; n++)
-                    {
-                        if (fc_carrier_map[n] == SCATTERED_CARRIER)
-                        {
-                            *out++ = sp_bpsk[prbs[n + K_OFFSET] ^ pn_sequence[j]];
-                        }
-                        else if (fc_carrier_map[n] == SCATTERED_CARRIER_INVERTED)
-                        {
-                            *out++ = sp_bpsk_inverted[prbs[n + K_OFFSET] ^ pn_sequence[j]];
-                        }
-                        else if (fc_carrier_map[n] == TRPAPR_CARRIER)
-                        {
-                            *out++ = zero;
-                        }
-                        else
-                        {
-                            *out++ = *in++;
-                        }
-                    }
-                    for (int n = 0; n < right_nulls; n++)
-                    {
-                        *out++ = zero;
-                    }
+                    memcpy(tx2_cells, in, sizeof(gr_complex) * active_items);
                 }
-                else
                 {
-                    for (int n = 0; n < left_nulls; n++)
-                    {
-                        *out++ = zero;
-                    }
-                    for (int n = 0; n < C_PS; n++)
-                    {
-                        if (data_carrier_map[n] == SCATTERED_CARRIER)
-                        {
-                            *out++ = sp_bpsk[prbs[n + K_OFFSET] ^ pn_sequence[j]];
-                        }
-                        else if (data_carrier_map[n] == SCATTERED_CARRIER_INVERTED)
-                        {
-                            *out++ = sp_bpsk_inverted[prbs[n + K_OFFSET] ^ pn_sequence[j]];
-                        }
-                        else if (data_carrier_map[n] == CONTINUAL_CARRIER)
-                        {
-                            *out++ = cp_bpsk[prbs[n + K_OFFSET] ^ pn_sequence[j]];
-                        }
-                        else if (data_carrier_map[n] == CONTINUAL_CARRIER_INVERTED)
-                        {
-                            *out++ = cp_bpsk_inverted[prbs[n + K_OFFSET] ^ pn_sequence[j]];
-                        }
-                        else if (data_carrier_map[n] == TRPAPR_CARRIER)
-                        {
-                            *out++ = zero;
-                        }
-                        else
-                        {
-                            *out++ = *in++;
-                        }
-                    }
-                    for (int n = 0; n < right_nulls; n++)
-                    {
-                        *out++ = zero;
-                    }
+                    gr::thread::scoped_lock lock(frame_mutex);
+                    frame_in = tx2_cells;
+                    frame_out = out2;
+                    frame_pending = TRUE;
+                    frame_count++;
+                    frame_ready.notify_all();
                 }
-                out -= ofdm_fft_size;
-                if (equalization_enable == gr::dvbt2::EQUALIZATION_ON)
+                modulate_frame(&group[0], in, out);
+                gr::thread::scoped_lock lock(frame_mutex);
+                while (frame_pending == TRUE)
                 {
-                    volk_32fc_x2_multiply_32fc(out, out, inverse_sinc, ofdm_fft_size);
+                    frame_done.wait(lock);
                 }
-                dst = ofdm_fft->get_inbuf();
-                memcpy(&dst[ofdm_fft_size / 2], &out[0], sizeof(gr_complex) * ofdm_fft_size / 2);
-                memcpy(&dst[0], &out[ofdm_fft_size / 2], sizeof(gr_complex) * ofdm_fft_size / 2);
-                ofdm_fft->execute();
-                volk_32fc_s32fc_multiply_32fc(out, ofdm_fft->get_outbuf(), normalization, ofdm_fft_size);
-                out += ofdm_fft_size;
             }
+            else
+            {
+                modulate_frame(&group[0], in, out);
+            }
+            in += active_items;
+            out += num_symbols * ofdm_fft_size;
         }
 
+        return active_items * (noutput_items / num_symbols);
+    }
+
+    int
+    pilotgenerator_cc_impl::general_work (int noutput_items,
+                       gr_vector_int &ninput_items,
+                       gr_vector_const_void_star &input_items,
+                       gr_vector_void_star &output_items)
+    {
+        perf_begin();
+        int consumed = process(noutput_items, input_items, output_items);
+
         // Tell runtime system how many input items we consumed on
         // each input stream.
-        consume_each (active_items);
+        consume_each (consumed);
+
+        perf_end(noutput_items);
 
         // Tell runtime system how many output items we produced.
         return noutput_items;
@@ -23,9 +23,12 @@
 
 #include <dvbt2/pilotgenerator_cc.h>
 #include <gnuradio/fft/fft.h>
+#include <gnuradio/thread/thread.h>
+#include "miso_kernels.h"
 
 #define CHIPS 2624
 #define MAX_CARRIERS 27841
+#define MAX_PILOTPHASES 16
 
 enum dvbt2_carrier_type_t {
   DATA_CARRIER = 1,
@@ -42,6 +45,21 @@ enum dvbt2_carrier_type_t {
 namespace gr {
   namespace dvbt2 {
 
+    struct pilotgenerator_group
+    {
+      fft::fft_complex *ofdm_fft;
+      fft::fft_complex *ace_fft;
+      gr_complex *ace_cells;
+      gr_complex *ace_time;
+      gr_complex *ace_correction;
+      float *ace_magnitude;
+      float *ace_lower;
+      float *ace_upper;
+      const gr_complex *p2_inverted;
+      const gr_complex *sp_inverted;
+      const gr_complex *cp_inverted;
+    };
+
     class pilotgenerator_cc_impl : public pilotgenerator_cc
     {
      private:
@@ -67,6 +85,7 @@ namespace gr {
       int p2_carrier_map[MAX_CARRIERS];
       int data_carrier_map[MAX_CARRIERS];
       int fc_carrier_map[MAX_CARRIERS];
+      int pilot_maps[MAX_PILOTPHASES][MAX_CARRIERS];
       int N_P2;
       int C_P2;
       int N_FC;
@@ -79,11 +98,36 @@ namespace gr {
       int dy;
       int miso;
       int miso_group;
+      int miso_both;
       void init_prbs(void);
       void init_pilots(int);
+      int ace_enable;
+      int ace_iterations;
+      float ace_vclip;
+      float ace_gain;
+      float ace_limit;
+      float ace_threshold;
+      void active_ace(pilotgenerator_group *, gr_complex *, const int *);
 
-      fft::fft_complex *ofdm_fft;
       int ofdm_fft_size;
+      int num_groups;
+      pilotgenerator_group group[2];
+      void new_group(pilotgenerator_group *);
+      void delete_group(pilotgenerator_group *);
+      void modulate_frame(pilotgenerator_group *, const gr_complex *, gr_complex *);
+
+      alamouti_kernel_t alamouti;
+      gr_complex *tx2_cells;
+      boost::thread_group workers;
+      gr::thread::mutex frame_mutex;
+      gr::thread::condition_variable frame_ready;
+      gr::thread::condition_variable frame_done;
+      const gr_complex *frame_in;
+      gr_complex *frame_out;
+      unsigned int frame_count;
+      int frame_pending;
+      int workers_stop;
+      void worker(void);
 
       const static unsigned char pn_sequence_table[CHIPS / 8];
       const static int p2_papr_map_1k[10];
@@ -154,7 +198,7 @@ namespace gr {
       const static int pp8_32k[6];
 
      public:
-      pilotgenerator_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, int vlength);
+      pilotgenerator_cc_impl(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, int vlength, dvbt2_constellation_t constellation, dvbt2_rotation_t rotation, float acevclip, float acegain, float acelimit, int aceiterations);
       ~pilotgenerator_cc_impl();
 
       // Where all the action really happens
@@ -164,6 +208,12 @@ namespace gr {
 		       gr_vector_int &ninput_items,
 		       gr_vector_const_void_star &input_items,
 		       gr_vector_void_star &output_items);
+
+      // general_work() without the scheduler, returns the input
+      // items consumed. Used by gateway_bc.
+      int process(int noutput_items,
+		  gr_vector_const_void_star &input_items,
+		  gr_vector_void_star &output_items);
     };
 
   } // namespace dvbt2
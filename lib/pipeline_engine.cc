@@ -0,0 +1,147 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "pipeline_engine.h"
+#include <boost/bind.hpp>
+#include <new>
+
+namespace gr {
+  namespace dvbt2 {
+
+    pipeline_engine::pipeline_engine(t2_chain *chain, int depth, bool use_futex, const std::vector<int> &cores)
+      : chain(chain),
+        cores(cores),
+        pending(0)
+    {
+        if (depth < 1)
+        {
+            depth = 1;
+        }
+        for (int n = 0; n <= PIPELINE_STAGES; n++)
+        {
+            rings[n] = NULL;
+        }
+        try
+        {
+            rings[0] = new spsc_ring(depth, sizeof(unsigned char) * chain->bbframe_items(), use_futex);
+            rings[1] = new spsc_ring(depth, sizeof(gr_complex) * chain->stream_cell_items(), use_futex);
+            rings[2] = new spsc_ring(depth, sizeof(gr_complex) * chain->frame_cell_items(), use_futex);
+            rings[3] = new spsc_ring(depth, sizeof(gr_complex) * chain->frame_symbol_items(), use_futex);
+        }
+        catch (...)
+        {
+            for (int n = 0; n <= PIPELINE_STAGES; n++)
+            {
+                delete rings[n];
+            }
+            throw;
+        }
+        for (int n = 0; n < PIPELINE_STAGES; n++)
+        {
+            threads.create_thread(boost::bind(&pipeline_engine::stage, this, n));
+        }
+    }
+
+    pipeline_engine::~pipeline_engine()
+    {
+        for (int n = 0; n <= PIPELINE_STAGES; n++)
+        {
+            rings[n]->stop();
+        }
+        threads.join_all();
+        for (int n = 0; n <= PIPELINE_STAGES; n++)
+        {
+            delete rings[n];
+        }
+    }
+
+    void
+    pipeline_engine::stage(int n)
+    {
+        const void *in;
+        void *out;
+
+        if (n < (int)cores.size() && cores[n] >= 0)
+        {
+            gr::thread::thread_bind_to_processor(cores[n]);
+        }
+        for (;;)
+        {
+            in = rings[n]->read_slot();
+            if (in == NULL)
+            {
+                break;
+            }
+            out = rings[n + 1]->write_slot();
+            if (out == NULL)
+            {
+                break;
+            }
+            switch (n)
+            {
+                case 0:
+                    chain->encode_cells((const unsigned char *) in, (gr_complex *) out);
+                    break;
+                case 1:
+                    chain->map_frame((const gr_complex *) in, (gr_complex *) out);
+                    break;
+                default:
+                    chain->modulate_symbols((const gr_complex *) in, (gr_complex *) out);
+                    break;
+            }
+            rings[n]->commit_read();
+            rings[n + 1]->commit_write();
+        }
+    }
+
+    int
+    pipeline_engine::push(const unsigned char *in)
+    {
+        unsigned char *out = (unsigned char *) rings[0]->try_write_slot();
+        int consumed;
+
+        if (out == NULL)
+        {
+            return -1;
+        }
+        consumed = chain->encode_bbframes(in, out);
+        rings[0]->commit_write();
+        pending++;
+        return consumed;
+    }
+
+    void
+    pipeline_engine::pop(gr_complex *out)
+    {
+        const gr_complex *in = (const gr_complex *) rings[PIPELINE_STAGES]->read_slot();
+
+        chain->insert_guards(in, out);
+        rings[PIPELINE_STAGES]->commit_read();
+        pending--;
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
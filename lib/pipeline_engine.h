@@ -0,0 +1,75 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_DVBT2_PIPELINE_ENGINE_H
+#define INCLUDED_DVBT2_PIPELINE_ENGINE_H
+
+#include <gnuradio/thread/thread.h>
+#include <vector>
+#include "t2_chain.h"
+#include "spsc_ring.h"
+
+#define PIPELINE_STAGES 3
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * Runs a t2_chain as a pipeline, one T2 frame per step. The caller
+     * runs the first stage (baseband frames and BCH) in push() and the
+     * last one (tone reservation, guard intervals and P1) in pop().
+     * Three threads in between run the LDPC to modulator, frame mapping
+     * and pilot/IFFT stages. The stages hand frames on through spsc_ring
+     * rings of depth frames each, so nothing locks and a thread only
+     * waits when its ring is empty or full.
+     *
+     * cores[n] pins stage thread n to a CPU, -1 or a missing entry
+     * leaves it free. use_futex selects how a thread waits, see
+     * spsc_ring.
+     */
+    class pipeline_engine
+    {
+     private:
+      t2_chain *chain;
+      spsc_ring *rings[PIPELINE_STAGES + 1];
+      std::vector<int> cores;
+      boost::thread_group threads;
+      int pending;
+
+      void stage(int n);
+
+     public:
+      pipeline_engine(t2_chain *chain, int depth, bool use_futex, const std::vector<int> &cores);
+      ~pipeline_engine();
+
+      //! Starts a frame. Returns the bytes consumed, or -1 when the pipeline is full.
+      int push(const unsigned char *in);
+      //! Finishes the oldest frame into out, waits for it if needed.
+      void pop(gr_complex *out);
+      //! Frames pushed and not popped yet.
+      int frames() const { return pending; }
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_PIPELINE_ENGINE_H */
+
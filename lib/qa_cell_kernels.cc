@@ -0,0 +1,126 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include "qa_cell_kernels.h"
+#include "cell_kernels.h"
+#include <limits>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    // Every mapper variant must match the generic kernel bit for bit,
+    // for each constellation mask, with and without the cyclic delay of
+    // the rotated constellations, for any length and alignment.
+    void
+    qa_cell_kernels::t1()
+    {
+      mapper_impl list[MAX_CELL_KERNELS];
+      int count = mapper_kernels(list);
+      const int masks[4] = {0x3, 0xf, 0x3f, 0xff};
+      const int max_cells = 70;
+      std::vector<gr_complex> constellation(256);
+      std::vector<unsigned char> cells(max_cells + 2);
+      std::vector<gr_complex> expected(max_cells + 2);
+      std::vector<gr_complex> result(max_cells + 2);
+
+      srand(1);
+      for (unsigned int n = 0; n < constellation.size(); n++)
+      {
+        constellation[n] = gr_complex((rand() / (float)RAND_MAX) - 0.5, (rand() / (float)RAND_MAX) - 0.5);
+      }
+      for (unsigned int n = 0; n < cells.size(); n++)
+      {
+        cells[n] = rand();
+      }
+      for (int k = 1; k < count; k++)
+      {
+        for (int m = 0; m < 4; m++)
+        {
+          for (int delay = 0; delay < 2; delay++)
+          {
+            for (int offset = 0; offset < 2; offset++)
+            {
+              for (int length = 0; length <= max_cells; length++)
+              {
+                memset(&expected[0], 0x55, sizeof(gr_complex) * expected.size());
+                memset(&result[0], 0x55, sizeof(gr_complex) * result.size());
+                mapper_generic(&expected[offset], &cells[offset], &constellation[0], masks[m], length, delay);
+                list[k].kernel(&result[offset], &cells[offset], &constellation[0], masks[m], length, delay);
+                CPPUNIT_ASSERT_MESSAGE(list[k].name, memcmp(&expected[0], &result[0], sizeof(gr_complex) * result.size()) == 0);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // Every gather variant must match the generic kernel bit for bit,
+    // for any length and alignment and for signed zeros, infinities and
+    // NaNs, which must be moved and not converted.
+    void
+    qa_cell_kernels::t2()
+    {
+      gather_impl list[MAX_CELL_KERNELS];
+      int count = gather_kernels(list);
+      const int max_cells = 70;
+      std::vector<gr_complex> in(1000);
+      std::vector<int> index(max_cells + 1);
+      std::vector<gr_complex> expected(max_cells + 1);
+      std::vector<gr_complex> result(max_cells + 1);
+      const float special[6] = {0.0, -0.0, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::signaling_NaN(), std::numeric_limits<float>::denorm_min()};
+
+      srand(2);
+      for (unsigned int n = 0; n < in.size(); n++)
+      {
+        in[n] = gr_complex((rand() / (float)RAND_MAX) - 0.5, (rand() / (float)RAND_MAX) - 0.5);
+      }
+      for (int n = 0; n < 6; n++)
+      {
+        in[n * 3] = gr_complex(special[n], special[5 - n]);
+      }
+      for (unsigned int n = 0; n < index.size(); n++)
+      {
+        index[n] = n < 12 ? n * 3 / 2 : rand() % in.size();
+      }
+      for (int k = 1; k < count; k++)
+      {
+        for (int offset = 0; offset < 2; offset++)
+        {
+          for (int length = 0; length < max_cells; length++)
+          {
+            memset(&expected[0], 0x55, sizeof(gr_complex) * expected.size());
+            memset(&result[0], 0x55, sizeof(gr_complex) * result.size());
+            gather_generic(&expected[offset], &in[0], &index[offset], length);
+            list[k].kernel(&result[offset], &in[0], &index[offset], length);
+            CPPUNIT_ASSERT_MESSAGE(list[k].name, memcmp(&expected[0], &result[0], sizeof(gr_complex) * result.size()) == 0);
+          }
+        }
+      }
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
@@ -26,11 +26,25 @@
  */
 
 #include "qa_dvbt2.h"
+#include "qa_miso_kernels.h"
+#include "qa_fec_kernels.h"
+#include "qa_cell_kernels.h"
+#include "qa_papr_kernels.h"
+#include "qa_spsc_ring.h"
+#include "qa_dvbt2_core.h"
+#include "qa_t2_geometry.h"
 
 CppUnit::TestSuite *
 qa_dvbt2::suite()
 {
   CppUnit::TestSuite *s = new CppUnit::TestSuite("dvbt2");
+  s->addTest(gr::dvbt2::qa_miso_kernels::suite());
+  s->addTest(gr::dvbt2::qa_fec_kernels::suite());
+  s->addTest(gr::dvbt2::qa_cell_kernels::suite());
+  s->addTest(gr::dvbt2::qa_papr_kernels::suite());
+  s->addTest(gr::dvbt2::qa_spsc_ring::suite());
+  s->addTest(gr::dvbt2::qa_dvbt2_core::suite());
+  s->addTest(gr::dvbt2::qa_t2_geometry::suite());
 
   return s;
 }
@@ -0,0 +1,149 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include "qa_dvbt2_core.h"
+#include <dvbt2/dvbt2_config.h>
+#include <dvbt2/dvbt2_core.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace gr {
+  namespace dvbt2 {
+
+    static const char *const settings[][2] = {
+      {"framesize", "SHORT"},
+      {"rate", "C1_2"},
+      {"constellation", "16qam"},
+      {"fecblocks", "2"},
+      {"tiblocks", "1"},
+      {"fftsize", "FFTSIZE_1K"},
+      {"guardinterval", "1_8"},
+      {"l1constellation", "QPSK"},
+      {"pilotpattern", "PP2"},
+      {"t2frames", "3"},
+      {"numdatasyms", "20"},
+    };
+
+    static dvbt2_core_params *
+    small_params()
+    {
+      dvbt2_core_params *params = dvbt2_core_params_new();
+
+      for (unsigned int i = 0; i < sizeof(settings) / sizeof(settings[0]); i++)
+      {
+        CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_params_set(params, settings[i][0], settings[i][1]));
+      }
+      return params;
+    }
+
+    // Names are checked, with or without the enum prefix.
+    void
+    qa_dvbt2_core::t1()
+    {
+      dvbt2_core_params *params = small_params();
+
+      CPPUNIT_ASSERT_EQUAL(-1, dvbt2_core_params_set(params, "rate", "7_8"));
+      CPPUNIT_ASSERT_EQUAL(-1, dvbt2_core_params_set(params, "fecblock", "2"));
+      CPPUNIT_ASSERT_EQUAL(-1, dvbt2_core_params_set(params, "fecblocks", "2x"));
+      CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_params_set(params, "bandwidth", "7_0_MHZ"));
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(8000000.0, dvbt2_core_sample_rate(params), 1e-3);
+      dvbt2_core_params_free(params);
+    }
+
+    // encode() in the calling thread and push()/pop() on the parallel
+    // engine give the same samples.
+    void
+    qa_dvbt2_core::t2()
+    {
+      dvbt2_core_params *params = small_params();
+      dvbt2_core_encoder *single = dvbt2_core_encoder_new(params, ENGINE_SINGLE, 2, NULL, 0);
+      int cores[3] = {-1, -1, -1};
+      dvbt2_core_encoder *parallel = dvbt2_core_encoder_new(params, ENGINE_PARALLEL, 2, cores, 3);
+      int input_bytes = dvbt2_core_input_bytes(single);
+      int samples = dvbt2_core_output_samples(single);
+      const int frames = 8;
+      std::vector<unsigned char> in(input_bytes * frames);
+      std::vector<float> expected(samples * 2 * frames);
+      std::vector<float> result(samples * 2 * frames);
+      int consumed = 0;
+      int used;
+      int produced = 0;
+
+      CPPUNIT_ASSERT(single != NULL && parallel != NULL);
+      CPPUNIT_ASSERT_EQUAL(input_bytes, dvbt2_core_input_bytes(parallel));
+      srand(1);
+      for (unsigned int i = 0; i < in.size(); i++)
+      {
+        in[i] = i % 188 ? rand() : 0x47;
+      }
+      for (int n = 0; n < frames; n++)
+      {
+        consumed += dvbt2_core_encode(single, &in[consumed], &expected[n * samples * 2]);
+      }
+      consumed = 0;
+      CPPUNIT_ASSERT_EQUAL(-1, dvbt2_core_pop(parallel, &result[0]));
+      while (produced < frames)
+      {
+        while (produced + dvbt2_core_frames(parallel) < frames && (used = dvbt2_core_push(parallel, &in[consumed])) >= 0)
+        {
+          consumed += used;
+        }
+        CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_pop(parallel, &result[produced * samples * 2]));
+        produced++;
+      }
+      CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_frames(parallel));
+      CPPUNIT_ASSERT(memcmp(&expected[0], &result[0], sizeof(float) * expected.size()) == 0);
+      dvbt2_core_encoder_free(parallel);
+      dvbt2_core_encoder_free(single);
+      dvbt2_core_params_free(params);
+    }
+
+    // Configurations the chain cannot run give NULL instead of
+    // exceptions or exit().
+    void
+    qa_dvbt2_core::t3()
+    {
+      dvbt2_core_params *params = small_params();
+      dvbt2_core_encoder *encoder;
+
+      CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_params_set(params, "fecblocks", "200"));
+      CPPUNIT_ASSERT(dvbt2_core_encoder_new(params, ENGINE_SINGLE, 2, NULL, 0) == NULL);
+      CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_params_set(params, "fecblocks", "2"));
+      CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_params_set(params, "pilotpattern", "PP8"));
+      CPPUNIT_ASSERT(dvbt2_core_encoder_new(params, ENGINE_SINGLE, 2, NULL, 0) == NULL);
+      // PAPR_BOTH with rotated constellations runs, tone reservation
+      // without ACE.
+      CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_params_set(params, "pilotpattern", "PP2"));
+      CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_params_set(params, "rotation", "ON"));
+      CPPUNIT_ASSERT_EQUAL(0, dvbt2_core_params_set(params, "paprmode", "BOTH"));
+      encoder = dvbt2_core_encoder_new(params, ENGINE_PARALLEL, 2, NULL, 0);
+      CPPUNIT_ASSERT(encoder != NULL);
+      dvbt2_core_encoder_free(encoder);
+      dvbt2_core_params_free(params);
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
@@ -0,0 +1,196 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include "qa_fec_kernels.h"
+#include "fec_kernels.h"
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    static void
+    random_bits(std::vector<unsigned char> &bits)
+    {
+      for (unsigned int n = 0; n < bits.size(); n++)
+      {
+        bits[n] = rand() & 1;
+      }
+    }
+
+    // A table shaped like an Annex A or B one, with entries addresses
+    // in each of groups groups.
+    static void
+    random_ldpc_table(ldpc_table *table, int q, int groups, int entries)
+    {
+      int e = 0;
+
+      table->q = q;
+      table->groups = groups;
+      for (int g = 0; g < groups; g++)
+      {
+        table->first[g] = e;
+        for (int n = 0; n < entries; n++)
+        {
+          table->address[e++] = rand() % (360 * q);
+        }
+      }
+      table->first[groups] = e;
+    }
+
+    // Every BCH variant must match the generic kernel bit for bit, for
+    // each register width, any length and alignment.
+    void
+    qa_fec_kernels::t1()
+    {
+      bch_impl list[MAX_FEC_KERNELS];
+      int count = bch_kernels(list);
+      const int widths[4] = {128, 160, 168, 192};
+      const int lengths[6] = {0, 31, 32, 97, 5232, 7032};
+      bch_table *table = new bch_table;
+      std::vector<unsigned char> bits(7032 + 3);
+      std::vector<unsigned char> expected(192 + 1);
+      std::vector<unsigned char> result(192 + 1);
+      uint64_t poly[4];
+
+      srand(1);
+      random_bits(bits);
+      for (int w = 0; w < 4; w++)
+      {
+        for (int n = 0; n < 4; n++)
+        {
+          poly[n] = ((uint64_t)rand() << 33) ^ ((uint64_t)rand() << 12) ^ rand();
+          if (widths[w] < (n + 1) * 64)
+          {
+            poly[n] &= widths[w] > n * 64 ? ~0ULL >> ((n + 1) * 64 - widths[w]) : 0;
+          }
+        }
+        bch_table_init(table, poly, widths[w]);
+        for (int k = 1; k < count; k++)
+        {
+          for (int offset = 0; offset < 3; offset++)
+          {
+            for (int l = 0; l < 6; l++)
+            {
+              memset(&expected[0], 0x55, expected.size());
+              memset(&result[0], 0x55, result.size());
+              bch_generic(&expected[0], &bits[offset], lengths[l], table);
+              list[k].kernel(&result[0], &bits[offset], lengths[l], table);
+              CPPUNIT_ASSERT_MESSAGE(list[k].name, memcmp(&expected[0], &result[0], result.size()) == 0);
+            }
+          }
+        }
+      }
+      delete table;
+    }
+
+    // Every LDPC variant must match the generic kernel bit for bit,
+    // for each q of Annex A and B and any alignment.
+    void
+    qa_fec_kernels::t2()
+    {
+      ldpc_impl list[MAX_FEC_KERNELS];
+      int count = ldpc_kernels(list);
+      const int q[6] = {8, 25, 30, 45, 72, 90};
+      ldpc_table table;
+      std::vector<unsigned char> info(360 * 40 + 3);
+      std::vector<unsigned char> expected(360 * 90 + 3);
+      std::vector<unsigned char> result(360 * 90 + 3);
+
+      srand(2);
+      random_bits(info);
+      for (int k = 1; k < count; k++)
+      {
+        for (int n = 0; n < 6; n++)
+        {
+          for (int offset = 0; offset < 3; offset++)
+          {
+            random_ldpc_table(&table, q[n], 40, (n % 3) + 3 + (offset * 4));
+            memset(&expected[0], 0x55, expected.size());
+            memset(&result[0], 0x55, result.size());
+            ldpc_generic(&expected[offset], &info[offset], &table);
+            list[k].kernel(&result[offset], &info[offset], &table);
+            CPPUNIT_ASSERT_MESSAGE(list[k].name, memcmp(&expected[0], &result[0], result.size()) == 0);
+          }
+        }
+      }
+    }
+
+    // Every bit interleaving variant must match the generic kernel bit
+    // for bit, for each cell size, a count of cells that is not a
+    // multiple of the vector width, and input bytes that are not bits.
+    void
+    qa_fec_kernels::t3()
+    {
+      interleave_impl list[MAX_FEC_KERNELS];
+      int count = interleave_kernels(list);
+      const int cells[5] = {2, 15, 17, 100, 2025};
+      std::vector<unsigned char> bits(2025 * 8);
+      std::vector<unsigned char> expected(2025 + 1);
+      std::vector<unsigned char> result(2025 + 1);
+      std::vector<int> perm;
+      std::vector<int> table;
+
+      srand(3);
+      for (unsigned int n = 0; n < bits.size(); n++)
+      {
+        bits[n] = rand();
+      }
+      for (int mod = 2; mod <= 8; mod += 2)
+      {
+        for (int c = 0; c < 5; c++)
+        {
+          perm.resize(cells[c] * mod);
+          for (unsigned int n = 0; n < perm.size(); n++)
+          {
+            perm[n] = n;
+          }
+          std::random_shuffle(perm.begin(), perm.end());
+          table.resize(interleave_table_size(cells[c], mod));
+          interleave_table(&table[0], &perm[0], cells[c], mod, cells[c] * mod);
+          memset(&expected[0], 0x55, expected.size());
+          interleave_generic(&expected[0], &bits[0], &table[0], cells[c], mod);
+          for (int n = 0; n < cells[c]; n++)
+          {
+            unsigned int cell = 0;
+            for (int b = 0; b < mod; b++)
+            {
+              cell = (cell << 1) | (bits[perm[(n * mod) + b]] & 1);
+            }
+            CPPUNIT_ASSERT_EQUAL(cell, (unsigned int)expected[n]);
+          }
+          for (int k = 1; k < count; k++)
+          {
+            memset(&result[0], 0x55, result.size());
+            list[k].kernel(&result[0], &bits[0], &table[0], cells[c], mod);
+            CPPUNIT_ASSERT_MESSAGE(list[k].name, memcmp(&expected[0], &result[0], result.size()) == 0);
+          }
+        }
+      }
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
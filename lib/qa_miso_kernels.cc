@@ -0,0 +1,74 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include "qa_miso_kernels.h"
+#include "miso_kernels.h"
+#include <limits>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    // Every variant must match the generic kernel bit for bit, for
+    // any length and alignment and for signed zeros, infinities and NaNs.
+    void
+    qa_miso_kernels::t1()
+    {
+      alamouti_impl list[MAX_ALAMOUTI_KERNELS];
+      int count = alamouti_kernels(list);
+      const int max_pairs = 67;
+      std::vector<gr_complex> in(max_pairs * 2 + 1);
+      std::vector<gr_complex> expected(max_pairs * 2 + 1);
+      std::vector<gr_complex> result(max_pairs * 2 + 1);
+      const float special[6] = {0.0, -0.0, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::denorm_min()};
+
+      srand(1);
+      for (unsigned int n = 0; n < in.size(); n++)
+      {
+        in[n] = gr_complex((rand() / (float)RAND_MAX) - 0.5, (rand() / (float)RAND_MAX) - 0.5);
+      }
+      for (int n = 0; n < 6; n++)
+      {
+        in[n * 3] = gr_complex(special[n], special[5 - n]);
+      }
+      for (int k = 1; k < count; k++)
+      {
+        for (int offset = 0; offset < 2; offset++)
+        {
+          for (int pairs = 0; pairs <= max_pairs; pairs++)
+          {
+            memset(&expected[0], 0x55, sizeof(gr_complex) * expected.size());
+            memset(&result[0], 0x55, sizeof(gr_complex) * result.size());
+            alamouti_generic(&expected[offset], &in[offset], pairs);
+            list[k].kernel(&result[offset], &in[offset], pairs);
+            CPPUNIT_ASSERT_MESSAGE(list[k].name, memcmp(&expected[0], &result[0], sizeof(gr_complex) * result.size()) == 0);
+          }
+        }
+      }
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
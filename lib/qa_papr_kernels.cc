@@ -0,0 +1,81 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include "qa_papr_kernels.h"
+#include "papr_kernels.h"
+#include <limits>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    // Every variant must match the generic kernel bit for bit, for any
+    // length and alignment and for signed zeros, infinities and NaNs.
+    void
+    qa_papr_kernels::t1()
+    {
+      tr_impl list[MAX_PAPR_KERNELS];
+      int count = tr_kernels(list);
+      const int max_length = 70;
+      std::vector<gr_complex> signal(max_length + 1);
+      std::vector<gr_complex> kernel(max_length + 1);
+      std::vector<gr_complex> expected(max_length + 1);
+      std::vector<gr_complex> result(max_length + 1);
+      const float special[6] = {0.0, -0.0, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::denorm_min()};
+      const gr_complex scales[3] = {gr_complex(0.3125, -1.75), gr_complex(-0.0, 0.0), gr_complex(1.0e-20, 3.0e25)};
+
+      srand(1);
+      for (unsigned int n = 0; n < signal.size(); n++)
+      {
+        signal[n] = gr_complex((rand() / (float)RAND_MAX) - 0.5, (rand() / (float)RAND_MAX) - 0.5);
+        kernel[n] = gr_complex((rand() / (float)RAND_MAX) - 0.5, (rand() / (float)RAND_MAX) - 0.5);
+      }
+      for (int n = 0; n < 6; n++)
+      {
+        signal[n * 3] = gr_complex(special[n], special[5 - n]);
+        kernel[(n * 5) + 1] = gr_complex(special[5 - n], special[n]);
+      }
+      for (int k = 1; k < count; k++)
+      {
+        for (int s = 0; s < 3; s++)
+        {
+          for (int offset = 0; offset < 2; offset++)
+          {
+            for (int length = 0; length < max_length; length++)
+            {
+              expected = signal;
+              result = signal;
+              tr_generic(&expected[offset], &kernel[0], scales[s], length);
+              list[k].kernel(&result[offset], &kernel[0], scales[s], length);
+              CPPUNIT_ASSERT_MESSAGE(list[k].name, memcmp(&expected[0], &result[0], sizeof(gr_complex) * result.size()) == 0);
+            }
+          }
+        }
+      }
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
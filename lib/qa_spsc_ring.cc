@@ -0,0 +1,116 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include "qa_spsc_ring.h"
+#include "spsc_ring.h"
+#include <string.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    static const int slot_words = 1000;
+    static const int count = 20000;
+
+    static void
+    producer(spsc_ring *ring)
+    {
+      unsigned int *slot;
+
+      for (int n = 0; n < count; n++)
+      {
+        slot = (unsigned int *) ring->write_slot();
+        for (int i = 0; i < slot_words; i++)
+        {
+          slot[i] = n * slot_words + i;
+        }
+        ring->commit_write();
+      }
+    }
+
+    // Every slot arrives once, in order and complete, for both wait
+    // modes and for a ring of one slot and of several.
+    void
+    qa_spsc_ring::t1()
+    {
+      const unsigned int *slot;
+      int errors;
+
+      for (int futex = 0; futex < 2; futex++)
+      {
+        for (int depth = 1; depth <= 3; depth += 2)
+        {
+          spsc_ring ring(depth, sizeof(unsigned int) * slot_words, futex == 1);
+          boost::thread thread(boost::bind(producer, &ring));
+          errors = 0;
+          for (int n = 0; n < count; n++)
+          {
+            slot = (const unsigned int *) ring.read_slot();
+            for (int i = 0; i < slot_words; i++)
+            {
+              if (slot[i] != (unsigned int)(n * slot_words + i))
+              {
+                errors++;
+              }
+            }
+            ring.commit_read();
+          }
+          thread.join();
+          CPPUNIT_ASSERT_EQUAL(0, errors);
+        }
+      }
+    }
+
+    // The non waiting calls report a full and an empty ring, and stop()
+    // releases a waiting thread.
+    void
+    qa_spsc_ring::t2()
+    {
+      spsc_ring ring(2, 16, true);
+      void *first;
+
+      CPPUNIT_ASSERT(ring.try_read_slot() == NULL);
+      first = ring.try_write_slot();
+      CPPUNIT_ASSERT(first != NULL);
+      memset(first, 0x5a, 16);
+      ring.commit_write();
+      CPPUNIT_ASSERT(ring.try_write_slot() != NULL);
+      ring.commit_write();
+      CPPUNIT_ASSERT(ring.try_write_slot() == NULL);
+      CPPUNIT_ASSERT(ring.try_read_slot() == first);
+      CPPUNIT_ASSERT_EQUAL(0x5a, (int)((const unsigned char *) ring.read_slot())[15]);
+      ring.commit_read();
+      ring.commit_read();
+      CPPUNIT_ASSERT(ring.try_read_slot() == NULL);
+
+      boost::thread thread(boost::bind(&spsc_ring::read_slot, &ring));
+      boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+      ring.stop();
+      thread.join();
+      CPPUNIT_ASSERT(ring.read_slot() == NULL);
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
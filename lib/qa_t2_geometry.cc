@@ -0,0 +1,141 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#include <gnuradio/attributes.h>
+#include <cppunit/TestAssert.h>
+#include "qa_t2_geometry.h"
+#include <dvbt2/t2_geometry.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    // The VV003-CR23 profile, 32K extended carriers, PP7 and 1/128.
+    static t2_params
+    vv003_params()
+    {
+      t2_params params;
+
+      params.constellation = MOD_256QAM;
+      params.rate = C2_3;
+      params.carriermode = CARRIERS_EXTENDED;
+      params.fftsize = FFTSIZE_32K;
+      params.guardinterval = GI_1_128;
+      params.pilotpattern = PILOT_PP7;
+      params.l1constellation = L1_MOD_64QAM;
+      params.numdatasyms = 59;
+      params.fecblocks = 202;
+      params.tiblocks = 3;
+      return params;
+    }
+
+    // Table values, tone reservation, MISO and the frame closing
+    // symbol exceptions.
+    void
+    qa_t2_geometry::t1()
+    {
+      t2_geometry siso(CARRIERS_EXTENDED, FFTSIZE_32K, PILOT_PP7, GI_1_128, PAPR_OFF, PREAMBLE_T2_SISO);
+      CPPUNIT_ASSERT_EQUAL(32768, siso.fft_size);
+      CPPUNIT_ASSERT_EQUAL(256, siso.guard_interval);
+      CPPUNIT_ASSERT_EQUAL(1, siso.N_P2);
+      CPPUNIT_ASSERT_EQUAL(22432, siso.C_P2);
+      CPPUNIT_ASSERT_EQUAL(27404, siso.C_DATA);
+      CPPUNIT_ASSERT_EQUAL(0, siso.N_FC);
+      CPPUNIT_ASSERT_EQUAL(22432 + 59 * 27404, siso.frame_cells(59));
+      CPPUNIT_ASSERT_EQUAL(60 * (32768 + 256) + 2048, siso.frame_samples(59));
+
+      t2_geometry tr(CARRIERS_NORMAL, FFTSIZE_4K, PILOT_PP4, GI_1_8, PAPR_TR, PREAMBLE_T2_SISO);
+      CPPUNIT_ASSERT_EQUAL(3234 - 36, tr.C_DATA);
+      CPPUNIT_ASSERT_EQUAL(3124 - 36, tr.N_FC);
+      CPPUNIT_ASSERT_EQUAL(2831 - 36, tr.C_FC);
+      CPPUNIT_ASSERT_EQUAL(4 * 2236 + 9 * tr.C_DATA + tr.N_FC, tr.frame_cells(10));
+
+      t2_geometry closed(CARRIERS_NORMAL, FFTSIZE_8K, PILOT_PP4, GI_1_32, PAPR_OFF, PREAMBLE_T2_SISO);
+      t2_geometry miso(CARRIERS_NORMAL, FFTSIZE_8K, PILOT_PP4, GI_1_32, PAPR_OFF, PREAMBLE_T2_MISO);
+      CPPUNIT_ASSERT_EQUAL(0, closed.N_FC);
+      CPPUNIT_ASSERT_EQUAL(6248, miso.N_FC);
+      CPPUNIT_ASSERT_EQUAL(4398, miso.C_P2);
+
+      CPPUNIT_ASSERT(t2_geometry::allowed(CARRIERS_EXTENDED, FFTSIZE_32K, GI_1_128, PILOT_PP7));
+      CPPUNIT_ASSERT(!t2_geometry::allowed(CARRIERS_NORMAL, FFTSIZE_32K, GI_1_4, PILOT_PP1));
+      CPPUNIT_ASSERT(!t2_geometry::allowed(CARRIERS_EXTENDED, FFTSIZE_4K, GI_1_8, PILOT_PP4));
+      CPPUNIT_ASSERT(!t2_geometry::allowed(CARRIERS_NORMAL, FFTSIZE_1K, GI_1_32, PILOT_PP4));
+    }
+
+    // VV003-CR23 fills its frame with 202 FEC blocks and carries
+    // 202 BBFRAMEs of K_bch - 80 bits per frame.
+    void
+    qa_t2_geometry::t2()
+    {
+      t2_params params = vv003_params();
+      t2_capacity capacity(params);
+
+      CPPUNIT_ASSERT_EQUAL(202, capacity.fec_capacity);
+      CPPUNIT_ASSERT_EQUAL(68 * 8100, capacity.ti_cells);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL((60.0 * (32768 + 256) + 2048) * 7.0 / 64e6, capacity.frame_seconds, 1e-12);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(202.0 * (43040 - 80) / capacity.frame_seconds, capacity.bitrate, 1e-3);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(60.0 / capacity.frame_seconds, capacity.symbols_per_second, 1e-6);
+      CPPUNIT_ASSERT(capacity.check(params) == NULL);
+
+      params.inputmode = INPUTMODE_HIEFF;
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(202.0 * (43040 - 80) * 188.0 / 187.0 / capacity.frame_seconds, t2_capacity(params).bitrate, 1e-3);
+
+      params.fecblocks = 203;
+      CPPUNIT_ASSERT(t2_capacity(params).check(params) != NULL);
+      params.fecblocks = 202;
+      params.tiblocks = 1;
+      CPPUNIT_ASSERT(t2_capacity(params).check(params) != NULL);
+      params.tiblocks = 3;
+      params.numdatasyms = 100;
+      CPPUNIT_ASSERT(t2_capacity(params).check(params) != NULL);
+    }
+
+    // The solver's choice is valid, full and at least as fast as any
+    // frame length.
+    void
+    qa_t2_geometry::t3()
+    {
+      t2_params params = vv003_params();
+      t2_constraints constraints;
+
+      CPPUNIT_ASSERT(t2_capacity::solve(params, constraints));
+      t2_capacity best(params);
+      CPPUNIT_ASSERT(best.check(params, constraints) == NULL);
+      CPPUNIT_ASSERT_EQUAL(best.fec_capacity, params.fecblocks);
+      CPPUNIT_ASSERT(best.frame_seconds <= 0.25);
+      for (int numdatasyms = 1; numdatasyms < 80; numdatasyms++)
+      {
+        t2_params trial = vv003_params();
+        trial.numdatasyms = numdatasyms;
+        trial.fecblocks = t2_capacity(trial).fec_capacity;
+        trial.tiblocks = (trial.fecblocks + 67) / 68;
+        t2_capacity capacity(trial);
+        if (capacity.check(trial, constraints) == NULL)
+        {
+          CPPUNIT_ASSERT(capacity.bitrate <= best.bitrate);
+        }
+      }
+
+      constraints.max_frame_ms = 5.0;
+      CPPUNIT_ASSERT(!t2_capacity::solve(params, constraints));
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
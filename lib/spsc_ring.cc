@@ -0,0 +1,209 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "spsc_ring.h"
+#include <boost/thread/thread.hpp>
+#include <volk/volk.h>
+#include <stdio.h>
+#include <new>
+#include <stdlib.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#include <time.h>
+#endif
+
+#define RING_SPINS 256
+
+namespace gr {
+  namespace dvbt2 {
+
+static inline void
+cpu_relax(void)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_ia32_pause();
+#endif
+}
+
+static void
+futex_wait(unsigned int *counter, unsigned int value)
+{
+#ifdef __linux__
+    // The timeout only bounds a missed stop().
+    struct timespec timeout = {0, 100000000};
+    syscall(SYS_futex, counter, FUTEX_WAIT_PRIVATE, value, &timeout, NULL, 0);
+#else
+    boost::this_thread::yield();
+#endif
+}
+
+static void
+futex_wake(unsigned int *counter)
+{
+#ifdef __linux__
+    syscall(SYS_futex, counter, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+    spsc_ring::spsc_ring(unsigned int slots, size_t size, bool use_futex)
+      : slots(slots),
+        use_futex(use_futex),
+        head(0),
+        head_waiting(0),
+        tail(0),
+        tail_waiting(0),
+        stopped(0)
+    {
+        size_t alignment = volk_get_alignment();
+        slot_size = ((size + alignment - 1) / alignment) * alignment;
+        buffer = (unsigned char*) volk_malloc(slot_size * slots, alignment);
+        if (buffer == NULL)
+        {
+            fprintf(stderr, "Ring volk_malloc, Out of memory.\n");
+            throw std::bad_alloc();
+        }
+    }
+
+    spsc_ring::~spsc_ring()
+    {
+        volk_free(buffer);
+    }
+
+    // Waits while *counter is value. False if stopped.
+    bool
+    spsc_ring::wait(unsigned int *counter, unsigned int *waiting, unsigned int value)
+    {
+        int spins = 0;
+        while (__atomic_load_n(counter, __ATOMIC_ACQUIRE) == value)
+        {
+            if (__atomic_load_n(&stopped, __ATOMIC_ACQUIRE))
+            {
+                return false;
+            }
+            if (spins < RING_SPINS)
+            {
+                cpu_relax();
+                spins++;
+                continue;
+            }
+            if (!use_futex)
+            {
+                // Still polling, but gives the core away when there
+                // are more threads than cores.
+                boost::this_thread::yield();
+                continue;
+            }
+            // The flag and the counter are both sequentially consistent,
+            // so either notify() sees the flag or this sees the new count.
+            __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(counter, __ATOMIC_SEQ_CST) == value)
+            {
+                futex_wait(counter, value);
+            }
+            __atomic_store_n(waiting, 0, __ATOMIC_RELAXED);
+        }
+        return true;
+    }
+
+    void
+    spsc_ring::notify(unsigned int *counter, unsigned int *waiting, unsigned int value)
+    {
+        __atomic_store_n(counter, value, __ATOMIC_SEQ_CST);
+        if (use_futex && __atomic_load_n(waiting, __ATOMIC_SEQ_CST))
+        {
+            futex_wake(counter);
+        }
+    }
+
+    void *
+    spsc_ring::write_slot()
+    {
+        unsigned int written = head;
+        if (!wait(&tail, &tail_waiting, written - slots))
+        {
+            return NULL;
+        }
+        return &buffer[(written % slots) * slot_size];
+    }
+
+    void *
+    spsc_ring::try_write_slot()
+    {
+        unsigned int written = head;
+        if (written - __atomic_load_n(&tail, __ATOMIC_ACQUIRE) == slots)
+        {
+            return NULL;
+        }
+        return &buffer[(written % slots) * slot_size];
+    }
+
+    void
+    spsc_ring::commit_write()
+    {
+        notify(&head, &head_waiting, head + 1);
+    }
+
+    const void *
+    spsc_ring::read_slot()
+    {
+        unsigned int read = tail;
+        if (!wait(&head, &head_waiting, read))
+        {
+            return NULL;
+        }
+        return &buffer[(read % slots) * slot_size];
+    }
+
+    const void *
+    spsc_ring::try_read_slot()
+    {
+        unsigned int read = tail;
+        if (__atomic_load_n(&head, __ATOMIC_ACQUIRE) == read)
+        {
+            return NULL;
+        }
+        return &buffer[(read % slots) * slot_size];
+    }
+
+    void
+    spsc_ring::commit_read()
+    {
+        notify(&tail, &tail_waiting, tail + 1);
+    }
+
+    void
+    spsc_ring::stop()
+    {
+        __atomic_store_n(&stopped, 1, __ATOMIC_SEQ_CST);
+        futex_wake(&head);
+        futex_wake(&tail);
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
@@ -0,0 +1,84 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_DVBT2_SPSC_RING_H
+#define INCLUDED_DVBT2_SPSC_RING_H
+
+#include <stddef.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * Bounded ring of fixed size slots for one producer thread and one
+     * consumer thread, without locks. The producer fills the slot from
+     * write_slot() and calls commit_write(), the consumer reads the
+     * slot from read_slot() and calls commit_read().
+     *
+     * A thread that has to wait spins on the counter for a while, then
+     * either keeps polling it, yielding between polls, or sleeps on it
+     * with a futex. Without futexes (not Linux) the sleep is a yield.
+     */
+    class spsc_ring
+    {
+     private:
+      unsigned char *buffer;
+      size_t slot_size;
+      unsigned int slots;
+      bool use_futex;
+      // Slots written and slots read, free running. Each on its own
+      // cache line, next to the flag of the thread that waits on it.
+      unsigned int head;
+      unsigned int head_waiting;
+      char head_pad[56];
+      unsigned int tail;
+      unsigned int tail_waiting;
+      char tail_pad[56];
+      unsigned int stopped;
+
+      bool wait(unsigned int *counter, unsigned int *waiting, unsigned int value);
+      void notify(unsigned int *counter, unsigned int *waiting, unsigned int value);
+
+     public:
+      spsc_ring(unsigned int slots, size_t size, bool use_futex);
+      ~spsc_ring();
+
+      //! Producer: next free slot, waits while the ring is full. NULL if stopped while waiting.
+      void *write_slot();
+      //! Producer: next free slot, or NULL when the ring is full.
+      void *try_write_slot();
+      void commit_write();
+
+      //! Consumer: oldest full slot, waits while the ring is empty. NULL if stopped while waiting.
+      const void *read_slot();
+      //! Consumer: oldest full slot, or NULL when the ring is empty.
+      const void *try_read_slot();
+      void commit_read();
+
+      //! Wakes both threads, a call that has to wait returns NULL from now on.
+      void stop();
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_SPSC_RING_H */
+
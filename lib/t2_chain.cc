@@ -0,0 +1,469 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "t2_chain.h"
+#include "trace_buffer.h"
+#include <volk/volk.h>
+#include <stdio.h>
+#include <new>
+
+namespace gr {
+  namespace dvbt2 {
+
+    t2_chain::t2_chain(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_constellation_t constellation, dvbt2_rotation_t rotation, int fecblocks, int tiblocks, dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, dvbt2_l1constellation_t l1constellation, dvbt2_pilotpattern_t pilotpattern, int t2frames, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_inputmode_t inputmode, dvbt2_reservedbiasbits_t reservedbiasbits, dvbt2_l1scrambled_t l1scrambled, dvbt2_inband_t inband, int tsrate, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, float vclip, int iterations, float acevclip, float acegain, float acelimit, int aceiterations)
+    {
+        gr_vector_int required(1);
+        block_ticks = NULL;
+        frame_count = 0;
+        for (int i = 0; i < CALLS; i++)
+        {
+            call_in[i].resize(1);
+            call_out[i].resize(1);
+        }
+        if (misogroup == gr::dvbt2::MISO_BOTH)
+        {
+            fprintf(stderr, "Gateway has one output, using MISO group TX1.\n");
+            misogroup = gr::dvbt2::MISO_TX1;
+        }
+        bbheader = NULL;
+        bch = NULL;
+        ldpc = NULL;
+        interleaver = NULL;
+        modulator = NULL;
+        framemapper = NULL;
+        pilotgenerator = NULL;
+        gi_p1_insertion = NULL;
+        header_bits = NULL;
+        codeword_bits = NULL;
+        cells_a = NULL;
+        frame_symbols = NULL;
+        // The blocks throw std::bad_alloc when they run out of memory,
+        // free what was built so far before passing it on.
+        try
+        {
+            gi_p1_insertion = new gi_p1_insertion_cc_impl(carriermode, fftsize, guardinterval, numdatasyms, preamble);
+            symbol_items = gi_p1_insertion->input_signature()->sizeof_stream_item(0) / sizeof(gr_complex);
+            // A fixed number of TS bytes per T2 frame, so without null packet
+            // deletion.
+            bbheader = new bbheader_bb_impl(framesize, rate, inputmode, inband, fecblocks, tsrate, gr::dvbt2::NPD_OFF);
+            bbscrambler = bbscrambler_bb::make(framesize, rate);
+            bch = new bch_bb_impl(framesize, rate);
+            ldpc = new ldpc_bb_impl(framesize, rate);
+            interleaver = new interleaver_bb_impl(framesize, rate, constellation);
+            modulator = new modulator_bc_impl(framesize, constellation, rotation);
+            cellinterleaver = cellinterleaver_cc::make(framesize, constellation, fecblocks, tiblocks);
+            framemapper = new framemapper_cc_impl(framesize, rate, constellation, rotation, fecblocks, tiblocks, carriermode, fftsize, guardinterval, l1constellation, pilotpattern, t2frames, numdatasyms, paprmode, version, preamble, inputmode, reservedbiasbits, l1scrambled, inband);
+            freqinterleaver = freqinterleaver_cc::make(carriermode, fftsize, pilotpattern, guardinterval, numdatasyms, paprmode, version, preamble);
+            pilotgenerator = new pilotgenerator_cc_impl(carriermode, fftsize, pilotpattern, guardinterval, numdatasyms, paprmode, version, preamble, misogroup, equalization, bandwidth, symbol_items, constellation, rotation, acevclip, acegain, acelimit, aceiterations);
+            // Same condition as paprtr_cc::work(), otherwise it only copies.
+            if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH || (version == gr::dvbt2::VERSION_131 && paprmode == gr::dvbt2::PAPR_OFF))
+            {
+                // No time budget. Its debt and cost estimate carry from one
+                // frame to the next and depend on timing, so the output would
+                // differ between the engines and from run to run.
+                paprtr = paprtr_cc::make(carriermode, fftsize, pilotpattern, guardinterval, numdatasyms, paprmode, version, vclip, iterations, symbol_items, 1, 1, 0.01, 0.0);
+            }
+            alamouti = NULL;
+            if ((preamble == gr::dvbt2::PREAMBLE_T2_MISO || preamble == gr::dvbt2::PREAMBLE_T2_LITE_MISO) && misogroup == gr::dvbt2::MISO_TX2)
+            {
+                alamouti = alamouti_select();
+            }
+            fec_blocks = fecblocks;
+            t2_frames = t2frames;
+            kbch = bbheader->output_multiple();
+            nbch = bch->output_multiple();
+            frame_size = ldpc->output_multiple();
+            cell_size = modulator->output_multiple();
+            stream_items = cellinterleaver->output_multiple();
+            mapped_items = framemapper->output_multiple();
+            num_symbols = pilotgenerator->output_multiple();
+            insertion_items = gi_p1_insertion->output_multiple();
+            bbheader->forecast(kbch, required);
+            bbheader_items = required[0];
+            cell_items = stream_items > mapped_items ? stream_items : mapped_items;
+            header_bits = (unsigned char*) volk_malloc(sizeof(unsigned char) * kbch * 2, volk_get_alignment());
+            if (header_bits == NULL)
+            {
+                fprintf(stderr, "Gateway 1st volk_malloc, Out of memory.\n");
+                throw std::bad_alloc();
+            }
+            scrambled_bits = &header_bits[kbch];
+            codeword_bits = (unsigned char*) volk_malloc(sizeof(unsigned char) * (frame_size + cell_size + nbch), volk_get_alignment());
+            if (codeword_bits == NULL)
+            {
+                fprintf(stderr, "Gateway 2nd volk_malloc, Out of memory.\n");
+                throw std::bad_alloc();
+            }
+            cell_bits = &codeword_bits[frame_size];
+            frame_bits = &cell_bits[cell_size];
+            cells_a = (gr_complex*) volk_malloc(sizeof(gr_complex) * cell_items * 4, volk_get_alignment());
+            if (cells_a == NULL)
+            {
+                fprintf(stderr, "Gateway 3rd volk_malloc, Out of memory.\n");
+                throw std::bad_alloc();
+            }
+            cells_b = &cells_a[cell_items];
+            frame_cells = &cells_b[cell_items];
+            frame_mapped = &frame_cells[cell_items];
+            frame_symbols = (gr_complex*) volk_malloc(sizeof(gr_complex) * num_symbols * symbol_items * 2, volk_get_alignment());
+            if (frame_symbols == NULL)
+            {
+                fprintf(stderr, "Gateway 4th volk_malloc, Out of memory.\n");
+                throw std::bad_alloc();
+            }
+            papr_symbols = &frame_symbols[num_symbols * symbol_items];
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    t2_chain::~t2_chain()
+    {
+        release();
+    }
+
+    void
+    t2_chain::release()
+    {
+        volk_free(frame_symbols);
+        volk_free(cells_a);
+        volk_free(codeword_bits);
+        volk_free(header_bits);
+        delete pilotgenerator;
+        delete framemapper;
+        delete modulator;
+        delete interleaver;
+        delete ldpc;
+        delete bch;
+        delete bbheader;
+        delete gi_p1_insertion;
+    }
+
+    t2_chain *
+    t2_chain::make(const t2_params &p)
+    {
+        return new t2_chain(p.framesize, p.rate, p.constellation, p.rotation, p.fecblocks, p.tiblocks, p.carriermode, p.fftsize, p.guardinterval, p.l1constellation, p.pilotpattern, p.t2frames, p.numdatasyms, p.paprmode, p.version, p.preamble, p.inputmode, p.reservedbiasbits, p.l1scrambled, p.inband, p.tsrate, p.misogroup, p.equalization, p.bandwidth, p.vclip, p.iterations, p.acevclip, p.acegain, p.acelimit, p.aceiterations);
+    }
+
+    const char *
+    t2_chain::block_name(int block)
+    {
+        static const char *names[BLOCKS] =
+        {
+            "bbheader_bb",
+            "bbscrambler_bb",
+            "bch_bb",
+            "ldpc_bb",
+            "interleaver_bb",
+            "modulator_bc",
+            "cellinterleaver_cc",
+            "framemapper_cc",
+            "freqinterleaver_cc",
+            "pilotgenerator_cc",
+            "paprtr_cc",
+            "gi_p1_insertion_cc"
+        };
+
+        return block >= 0 && block < BLOCKS ? names[block] : NULL;
+    }
+
+    int
+    t2_chain::block_items(int block) const
+    {
+        switch (block)
+        {
+            case BLOCK_BBHEADER:
+            case BLOCK_BBSCRAMBLER:
+                return kbch * fec_blocks;
+            case BLOCK_BCH:
+                return nbch * fec_blocks;
+            case BLOCK_LDPC:
+                return frame_size * fec_blocks;
+            case BLOCK_INTERLEAVER:
+            case BLOCK_MODULATOR:
+                return cell_size * fec_blocks;
+            case BLOCK_CELLINTERLEAVER:
+                return stream_items;
+            case BLOCK_FRAMEMAPPER:
+            case BLOCK_FREQINTERLEAVER:
+                return mapped_items;
+            case BLOCK_PILOTGENERATOR:
+            case BLOCK_PAPRTR:
+                return num_symbols;
+            case BLOCK_GI_P1_INSERTION:
+                return insertion_items;
+            default:
+                return 0;
+        }
+    }
+
+    int
+    t2_chain::block_units(int block) const
+    {
+        return block <= BLOCK_CELLINTERLEAVER ? fec_blocks : num_symbols;
+    }
+
+    inline gr::high_res_timer_type
+    t2_chain::lap_start()
+    {
+        return block_ticks != NULL ? gr::high_res_timer_now() : trace_now();
+    }
+
+    // Ends the span of block that began at start, and starts the next.
+    inline void
+    t2_chain::lap(int block, int index, gr::high_res_timer_type &start)
+    {
+        if (start != 0)
+        {
+            gr::high_res_timer_type now = gr::high_res_timer_now();
+            if (block_ticks != NULL)
+            {
+                block_ticks[block] += now - start;
+            }
+            if (trace_on())
+            {
+                trace_record(block_name(block), block <= BLOCK_MODULATOR ? TRACE_FECFRAME : TRACE_T2FRAME, index, start, now);
+            }
+            start = now;
+        }
+    }
+
+    int
+    t2_chain::frame(const unsigned char *in, gr_complex *out)
+    {
+        gr_vector_const_void_star &stage_in = call_in[CALL_FRAME];
+        gr_vector_void_star &stage_out = call_out[CALL_FRAME];
+        gr::high_res_timer_type frame_start = trace_now();
+        gr::high_res_timer_type start = lap_start();
+        int consumed = 0;
+
+        // The bit stages run one FEC block at a time, so the bit
+        // buffers stay in cache, and the cells are collected for
+        // the frame stages.
+        for (int j = 0; j < fec_blocks; j++)
+        {
+            stage_in[0] = &in[consumed];
+            stage_out[0] = header_bits;
+            consumed += bbheader->process(kbch, stage_in, stage_out);
+            lap(BLOCK_BBHEADER, j, start);
+            stage_in[0] = header_bits;
+            stage_out[0] = scrambled_bits;
+            bbscrambler->work(kbch, stage_in, stage_out);
+            lap(BLOCK_BBSCRAMBLER, j, start);
+            stage_in[0] = scrambled_bits;
+            stage_out[0] = frame_bits;
+            bch->process(nbch, stage_in, stage_out);
+            lap(BLOCK_BCH, j, start);
+            stage_in[0] = frame_bits;
+            stage_out[0] = codeword_bits;
+            ldpc->process(frame_size, stage_in, stage_out);
+            lap(BLOCK_LDPC, j, start);
+            stage_in[0] = codeword_bits;
+            stage_out[0] = cell_bits;
+            interleaver->process(cell_size, stage_in, stage_out);
+            lap(BLOCK_INTERLEAVER, j, start);
+            stage_in[0] = cell_bits;
+            stage_out[0] = &frame_cells[j * cell_size];
+            modulator->process(cell_size, stage_in, stage_out);
+            lap(BLOCK_MODULATOR, j, start);
+        }
+        map_frame(frame_cells, frame_mapped);
+        modulate_symbols(frame_mapped, frame_symbols);
+        insert_guards(frame_symbols, out);
+        trace_span("t2_frame", TRACE_T2FRAME, frame_count++, frame_start);
+        return consumed;
+    }
+
+    int
+    t2_chain::encode_bbframes(const unsigned char *in, unsigned char *out)
+    {
+        gr_vector_const_void_star &stage_in = call_in[CALL_BBFRAMES];
+        gr_vector_void_star &stage_out = call_out[CALL_BBFRAMES];
+        gr::high_res_timer_type start = trace_now();
+        int consumed = 0;
+
+        for (int j = 0; j < fec_blocks; j++)
+        {
+            stage_in[0] = &in[consumed];
+            stage_out[0] = header_bits;
+            consumed += bbheader->process(kbch, stage_in, stage_out);
+            lap(BLOCK_BBHEADER, j, start);
+            stage_in[0] = header_bits;
+            stage_out[0] = scrambled_bits;
+            bbscrambler->work(kbch, stage_in, stage_out);
+            lap(BLOCK_BBSCRAMBLER, j, start);
+            stage_in[0] = scrambled_bits;
+            stage_out[0] = &out[j * nbch];
+            bch->process(nbch, stage_in, stage_out);
+            lap(BLOCK_BCH, j, start);
+        }
+        return consumed;
+    }
+
+    void
+    t2_chain::encode_cells(const unsigned char *in, gr_complex *out)
+    {
+        gr_vector_const_void_star &stage_in = call_in[CALL_CELLS];
+        gr_vector_void_star &stage_out = call_out[CALL_CELLS];
+        gr::high_res_timer_type start = trace_now();
+
+        for (int j = 0; j < fec_blocks; j++)
+        {
+            stage_in[0] = &in[j * nbch];
+            stage_out[0] = codeword_bits;
+            ldpc->process(frame_size, stage_in, stage_out);
+            lap(BLOCK_LDPC, j, start);
+            stage_in[0] = codeword_bits;
+            stage_out[0] = cell_bits;
+            interleaver->process(cell_size, stage_in, stage_out);
+            lap(BLOCK_INTERLEAVER, j, start);
+            stage_in[0] = cell_bits;
+            stage_out[0] = &out[j * cell_size];
+            modulator->process(cell_size, stage_in, stage_out);
+            lap(BLOCK_MODULATOR, j, start);
+        }
+    }
+
+    void
+    t2_chain::map_frame(const gr_complex *in, gr_complex *out)
+    {
+        gr_vector_const_void_star &stage_in = call_in[CALL_MAP];
+        gr_vector_void_star &stage_out = call_out[CALL_MAP];
+
+        gr::high_res_timer_type start = lap_start();
+
+        stage_in[0] = in;
+        stage_out[0] = cells_a;
+        cellinterleaver->work(stream_items, stage_in, stage_out);
+        lap(BLOCK_CELLINTERLEAVER, -1, start);
+        stage_in[0] = cells_a;
+        stage_out[0] = cells_b;
+        framemapper->process(mapped_items, stage_in, stage_out);
+        lap(BLOCK_FRAMEMAPPER, -1, start);
+        stage_in[0] = cells_b;
+        stage_out[0] = alamouti != NULL ? cells_a : out;
+        freqinterleaver->work(mapped_items, stage_in, stage_out);
+        if (alamouti != NULL)
+        {
+            alamouti(out, cells_a, mapped_items / 2);
+        }
+        lap(BLOCK_FREQINTERLEAVER, -1, start);
+    }
+
+    void
+    t2_chain::modulate_symbols(const gr_complex *in, gr_complex *out)
+    {
+        gr_vector_const_void_star &stage_in = call_in[CALL_SYMBOLS];
+        gr_vector_void_star &stage_out = call_out[CALL_SYMBOLS];
+        gr::high_res_timer_type start = lap_start();
+
+        stage_in[0] = in;
+        stage_out[0] = out;
+        pilotgenerator->process(num_symbols, stage_in, stage_out);
+        lap(BLOCK_PILOTGENERATOR, -1, start);
+    }
+
+    void
+    t2_chain::insert_guards(const gr_complex *in, gr_complex *out)
+    {
+        gr_vector_const_void_star &stage_in = call_in[CALL_GUARDS];
+        gr_vector_void_star &stage_out = call_out[CALL_GUARDS];
+        gr::high_res_timer_type start = lap_start();
+
+        stage_in[0] = in;
+        if (paprtr)
+        {
+            stage_out[0] = papr_symbols;
+            paprtr->work(num_symbols, stage_in, stage_out);
+            stage_in[0] = papr_symbols;
+            lap(BLOCK_PAPRTR, -1, start);
+        }
+        stage_out[0] = out;
+        gi_p1_insertion->process(insertion_items, stage_in, stage_out);
+        lap(BLOCK_GI_P1_INSERTION, -1, start);
+    }
+
+    int
+    t2_chain::encode_headers(const unsigned char *in, unsigned char *out)
+    {
+        gr_vector_const_void_star &stage_in = call_in[CALL_HEADERS];
+        gr_vector_void_star &stage_out = call_out[CALL_HEADERS];
+        gr::high_res_timer_type start = trace_now();
+        int consumed = 0;
+
+        for (int j = 0; j < fec_blocks; j++)
+        {
+            stage_in[0] = &in[consumed];
+            stage_out[0] = &out[j * kbch];
+            consumed += bbheader->process(kbch, stage_in, stage_out);
+            lap(BLOCK_BBHEADER, j, start);
+        }
+        return consumed;
+    }
+
+    void
+    t2_chain::encode_frame(const unsigned char *in, int frame_number, gr_complex *out)
+    {
+        gr_vector_const_void_star &stage_in = call_in[CALL_ENCODE];
+        gr_vector_void_star &stage_out = call_out[CALL_ENCODE];
+        gr::high_res_timer_type frame_start = trace_now();
+        gr::high_res_timer_type start = frame_start;
+
+        for (int j = 0; j < fec_blocks; j++)
+        {
+            stage_in[0] = &in[j * kbch];
+            stage_out[0] = scrambled_bits;
+            bbscrambler->work(kbch, stage_in, stage_out);
+            lap(BLOCK_BBSCRAMBLER, j, start);
+            stage_in[0] = scrambled_bits;
+            stage_out[0] = frame_bits;
+            bch->process(nbch, stage_in, stage_out);
+            lap(BLOCK_BCH, j, start);
+            stage_in[0] = frame_bits;
+            stage_out[0] = codeword_bits;
+            ldpc->process(frame_size, stage_in, stage_out);
+            lap(BLOCK_LDPC, j, start);
+            stage_in[0] = codeword_bits;
+            stage_out[0] = cell_bits;
+            interleaver->process(cell_size, stage_in, stage_out);
+            lap(BLOCK_INTERLEAVER, j, start);
+            stage_in[0] = cell_bits;
+            stage_out[0] = &frame_cells[j * cell_size];
+            modulator->process(cell_size, stage_in, stage_out);
+            lap(BLOCK_MODULATOR, j, start);
+        }
+        framemapper->set_frame_number(frame_number);
+        map_frame(frame_cells, frame_mapped);
+        modulate_symbols(frame_mapped, frame_symbols);
+        insert_guards(frame_symbols, out);
+        trace_span("t2_frame", TRACE_T2FRAME, frame_number, frame_start);
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
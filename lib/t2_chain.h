@@ -0,0 +1,206 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_DVBT2_T2_CHAIN_H
+#define INCLUDED_DVBT2_T2_CHAIN_H
+
+#include <dvbt2/dvbt2_config.h>
+#include <dvbt2/t2_params.h>
+#include <dvbt2/bbscrambler_bb.h>
+#include <dvbt2/cellinterleaver_cc.h>
+#include <dvbt2/freqinterleaver_cc.h>
+#include <dvbt2/paprtr_cc.h>
+#include "bbheader_bb_impl.h"
+#include "bch_bb_impl.h"
+#include "ldpc_bb_impl.h"
+#include "interleaver_bb_impl.h"
+#include "modulator_bc_impl.h"
+#include "framemapper_cc_impl.h"
+#include "pilotgenerator_cc_impl.h"
+#include "gi_p1_insertion_cc_impl.h"
+#include "miso_kernels.h"
+#include <gnuradio/high_res_timer.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * The modulator blocks from bbheader_bb to gi_p1_insertion_cc,
+     * driven directly, one T2 frame per call. frame() runs the whole
+     * chain. The five stage methods run it in parts, each with its own
+     * scratch buffers, so different stages can run on different
+     * threads at the same time. Both give the same output. frame()
+     * uses the stage buffers, so it must not run while stage methods
+     * run on other threads.
+     *
+     * encode_headers() and encode_frame() split the chain after the
+     * baseband header instead, the only stage with state from frame
+     * to frame besides the T2 frame number, which encode_frame() is
+     * given. They use separate buffers, so one thread can frame the
+     * input while another encodes a frame on the same chain.
+     *
+     * profile() makes frame() add up the time spent in each block,
+     * for bench-dvbt2. It is meant for a chain driven by one thread.
+     * While dvbt2::tracer records, every entry point records a span
+     * per block and FEC frame or T2 frame.
+     */
+    class t2_chain
+    {
+     private:
+      bbheader_bb_impl *bbheader;
+      bbscrambler_bb::sptr bbscrambler;
+      bch_bb_impl *bch;
+      ldpc_bb_impl *ldpc;
+      interleaver_bb_impl *interleaver;
+      modulator_bc_impl *modulator;
+      cellinterleaver_cc::sptr cellinterleaver;
+      framemapper_cc_impl *framemapper;
+      freqinterleaver_cc::sptr freqinterleaver;
+      pilotgenerator_cc_impl *pilotgenerator;
+      paprtr_cc::sptr paprtr;
+      gi_p1_insertion_cc_impl *gi_p1_insertion;
+      alamouti_kernel_t alamouti;
+      int fec_blocks;
+      int t2_frames;
+      int bbheader_items;
+      int kbch;
+      int nbch;
+      int frame_size;
+      int cell_size;
+      int stream_items;
+      int mapped_items;
+      int cell_items;
+      int num_symbols;
+      int symbol_items;
+      int insertion_items;
+      unsigned char *header_bits;
+      unsigned char *scrambled_bits;
+      unsigned char *codeword_bits;
+      unsigned char *cell_bits;
+      unsigned char *frame_bits;
+      gr_complex *frame_cells;
+      gr_complex *frame_mapped;
+      gr_complex *frame_symbols;
+      gr_complex *cells_a;
+      gr_complex *cells_b;
+      gr_complex *papr_symbols;
+      // Item pointers for each entry point, so that they can run on
+      // different threads and nothing is allocated per frame.
+      enum
+      {
+        CALL_FRAME = 0,
+        CALL_BBFRAMES,
+        CALL_CELLS,
+        CALL_MAP,
+        CALL_SYMBOLS,
+        CALL_GUARDS,
+        CALL_HEADERS,
+        CALL_ENCODE,
+        CALLS
+      };
+      gr_vector_const_void_star call_in[CALLS];
+      gr_vector_void_star call_out[CALLS];
+      gr::high_res_timer_type *block_ticks;
+      int frame_count;
+
+      void release();
+      gr::high_res_timer_type lap_start();
+      void lap(int block, int index, gr::high_res_timer_type &start);
+
+     public:
+      //! The blocks, in chain order, for profile().
+      enum
+      {
+        BLOCK_BBHEADER = 0,
+        BLOCK_BBSCRAMBLER,
+        BLOCK_BCH,
+        BLOCK_LDPC,
+        BLOCK_INTERLEAVER,
+        BLOCK_MODULATOR,
+        BLOCK_CELLINTERLEAVER,
+        BLOCK_FRAMEMAPPER,
+        BLOCK_FREQINTERLEAVER,
+        BLOCK_PILOTGENERATOR,
+        BLOCK_PAPRTR,
+        BLOCK_GI_P1_INSERTION,
+        BLOCKS
+      };
+
+      t2_chain(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate, dvbt2_constellation_t constellation, dvbt2_rotation_t rotation, int fecblocks, int tiblocks, dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, dvbt2_l1constellation_t l1constellation, dvbt2_pilotpattern_t pilotpattern, int t2frames, int numdatasyms, dvbt2_papr_t paprmode, dvbt2_version_t version, dvbt2_preamble_t preamble, dvbt2_inputmode_t inputmode, dvbt2_reservedbiasbits_t reservedbiasbits, dvbt2_l1scrambled_t l1scrambled, dvbt2_inband_t inband, int tsrate, dvbt2_misogroup_t misogroup, dvbt2_equalization_t equalization, dvbt2_bandwidth_t bandwidth, float vclip, int iterations, float acevclip, float acegain, float acelimit, int aceiterations);
+      ~t2_chain();
+
+      //! Builds the chain from params.
+      static t2_chain *make(const t2_params &params);
+
+      //! Transport stream bytes a frame can consume, at most.
+      int input_items() const { return bbheader_items * fec_blocks; }
+      //! Complex samples per frame.
+      int output_items() const { return insertion_items; }
+      //! Items per frame between the stages.
+      int bbframe_items() const { return nbch * fec_blocks; }
+      int bbframe_header_items() const { return kbch * fec_blocks; }
+      int stream_cell_items() const { return stream_items; }
+      int frame_cell_items() const { return cell_items; }
+      int frame_symbol_items() const { return num_symbols * symbol_items; }
+      //! T2 frames per super-frame.
+      int superframe_frames() const { return t2_frames; }
+
+      //! Adds the high_res_timer ticks each block takes in frame() to
+      //! ticks[block], until called with NULL. The Alamouti encoding
+      //! of MISO group TX2 counts as freqinterleaver time.
+      void profile(gr::high_res_timer_type *ticks) { block_ticks = ticks; }
+      //! Name of block.
+      static const char *block_name(int block);
+      //! False for blocks the chain leaves out.
+      bool block_present(int block) const { return block != BLOCK_PAPRTR || paprtr; }
+      //! Output items of block per frame.
+      int block_items(int block) const;
+      //! FEC blocks per frame for the blocks up to cellinterleaver,
+      //! OFDM symbols per frame for the others.
+      int block_units(int block) const;
+
+      //! Whole chain, returns the transport stream bytes consumed.
+      int frame(const unsigned char *in, gr_complex *out);
+
+      //! bbheader, bbscrambler and bch, returns the bytes consumed.
+      int encode_bbframes(const unsigned char *in, unsigned char *out);
+      //! ldpc, interleaver and modulator.
+      void encode_cells(const unsigned char *in, gr_complex *out);
+      //! Cell and frequency interleavers, frame mapper and Alamouti.
+      void map_frame(const gr_complex *in, gr_complex *out);
+      //! Pilots, PAPR and IFFT.
+      void modulate_symbols(const gr_complex *in, gr_complex *out);
+      //! Tone reservation, guard intervals and P1.
+      void insert_guards(const gr_complex *in, gr_complex *out);
+
+      //! bbheader only, returns the bytes consumed. The headed frames
+      //! are bbframe_header_items() bits.
+      int encode_headers(const unsigned char *in, unsigned char *out);
+      //! Everything after bbheader for T2 frame number frame_number.
+      //! Keeps no state between calls, so chains can run any frames.
+      void encode_frame(const unsigned char *in, int frame_number, gr_complex *out);
+    };
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_T2_CHAIN_H */
+
@@ -0,0 +1,190 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dvbt2/t2_encoder.h>
+#include "t2_chain.h"
+#include "pipeline_engine.h"
+#include "parallel_engine.h"
+#include <volk/volk.h>
+#include <stdio.h>
+#include <string.h>
+#include <new>
+
+namespace gr {
+  namespace dvbt2 {
+
+    t2_encoder::t2_encoder(const t2_params &params, dvbt2_engine_t engine, int depth, const std::vector<int> &cores)
+      : pipeline(NULL),
+        parallel(NULL),
+        frame(NULL),
+        pending(0)
+    {
+        chain = t2_chain::make(params);
+        try
+        {
+            if (engine == gr::dvbt2::ENGINE_PIPELINE_POLL || engine == gr::dvbt2::ENGINE_PIPELINE_FUTEX)
+            {
+                pipeline = new pipeline_engine(chain, depth, engine == gr::dvbt2::ENGINE_PIPELINE_FUTEX, cores);
+            }
+            else if (engine == gr::dvbt2::ENGINE_PARALLEL)
+            {
+                // One worker per entry of cores, or per CPU without them.
+                int num_workers = cores.size() ? cores.size() : boost::thread::hardware_concurrency();
+                if (num_workers < 1)
+                {
+                    num_workers = 1;
+                }
+                workers.push_back(chain);
+                for (int n = 1; n < num_workers; n++)
+                {
+                    workers.push_back(t2_chain::make(params));
+                }
+                parallel = new parallel_engine(workers, depth, cores);
+            }
+            else
+            {
+                frame = (gr_complex*) volk_malloc(sizeof(gr_complex) * chain->output_items(), volk_get_alignment());
+                if (frame == NULL)
+                {
+                    fprintf(stderr, "Encoder 1st volk_malloc, Out of memory.\n");
+                    throw std::bad_alloc();
+                }
+            }
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    t2_encoder::~t2_encoder()
+    {
+        release();
+    }
+
+    void
+    t2_encoder::release()
+    {
+        delete parallel;
+        delete pipeline;
+        for (unsigned int n = 1; n < workers.size(); n++)
+        {
+            delete workers[n];
+        }
+        delete chain;
+        if (frame != NULL)
+        {
+            volk_free(frame);
+        }
+    }
+
+    int
+    t2_encoder::input_items() const
+    {
+        return chain->input_items();
+    }
+
+    int
+    t2_encoder::output_items() const
+    {
+        return chain->output_items();
+    }
+
+    int
+    t2_encoder::encode(const unsigned char *in, gr_complex *out)
+    {
+        int consumed;
+
+        if (frame != NULL)
+        {
+            return chain->frame(in, out);
+        }
+        consumed = push(in);
+        pop(out);
+        return consumed;
+    }
+
+    int
+    t2_encoder::push(const unsigned char *in)
+    {
+        if (pipeline != NULL)
+        {
+            return pipeline->push(in);
+        }
+        if (parallel != NULL)
+        {
+            return parallel->push(in);
+        }
+        // The single engine holds one frame.
+        if (pending)
+        {
+            return -1;
+        }
+        pending = 1;
+        return chain->frame(in, frame);
+    }
+
+    bool
+    t2_encoder::pop(gr_complex *out)
+    {
+        if (frames() == 0)
+        {
+            return false;
+        }
+        if (pipeline != NULL)
+        {
+            pipeline->pop(out);
+        }
+        else if (parallel != NULL)
+        {
+            parallel->pop(out);
+        }
+        else
+        {
+            memcpy(out, frame, sizeof(gr_complex) * chain->output_items());
+            pending = 0;
+        }
+        return true;
+    }
+
+    int
+    t2_encoder::frames() const
+    {
+        if (pipeline != NULL)
+        {
+            return pipeline->frames();
+        }
+        if (parallel != NULL)
+        {
+            return parallel->frames();
+        }
+        return pending;
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
@@ -0,0 +1,423 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/gr_complex.h>
+#include <dvbt2/t2_geometry.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * L1 signalling, clause 7.3: the L1-pre is always 1840 BPSK cells,
+     * the L1-post, without FEF, one shortened and punctured 16K LDPC
+     * block of K_sig bits.
+     */
+    static const int l1_pre_cells = 1840;
+    static const int l1_post_info_bits = 350;
+    static const int l1_kbch = 7032;
+    static const int l1_bch_parity = 168;
+
+    // Largest TI block, in cells.
+    static const int ti_memory_cells = (1 << 19) + (1 << 15);
+
+    // L1 field widths of PLP_NUM_BLOCKS, TIME_IL_LENGTH and
+    // NUM_DATA_SYMBOLS, and the samples of the P1 symbol.
+    static const int max_fecblocks = 1023;
+    static const int max_tiblocks = 255;
+    static const int max_numdatasyms = 4095;
+    static const int p1_samples = 2048;
+
+    struct carrier_cells
+    {
+      int C_DATA;
+      int N_FC;
+      int C_FC;
+    };
+
+    // 1K, 2K, 4K, 8K, 16K and 32K.
+    static const int fft_sizes[6] = {1024, 2048, 4096, 8192, 16384, 32768};
+    static const int p2_symbol_count[6] = {16, 8, 4, 2, 1, 1};
+    static const int p2_cells_siso[6] = {558, 1118, 2236, 4472, 8944, 22432};
+    static const int p2_cells_miso[6] = {546, 1098, 2198, 4398, 8814, 17612};
+    static const int tr_carriers[6] = {10, 18, 36, 72, 144, 288};
+
+    // Tables 42 and 43, normal and extended carrier mode, PP1 to PP8.
+    static const carrier_cells data_cells[2][6][8] =
+    {
+      {
+        {{764, 568, 402}, {768, 710, 654}, {798, 710, 490}, {804, 780, 707}, {818, 780, 544}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+        {{1522, 1136, 804}, {1532, 1420, 1309}, {1596, 1420, 980}, {1602, 1562, 1415}, {1632, 1562, 1088}, {0, 0, 0}, {1646, 1632, 1396}, {0, 0, 0}},
+        {{3084, 2272, 1609}, {3092, 2840, 2619}, {3228, 2840, 1961}, {3234, 3124, 2831}, {3298, 3124, 2177}, {0, 0, 0}, {3328, 3266, 2792}, {0, 0, 0}},
+        {{6208, 4544, 3218}, {6214, 5680, 5238}, {6494, 5680, 3922}, {6498, 6248, 5662}, {6634, 6248, 4354}, {0, 0, 0}, {6698, 6532, 5585}, {6698, 0, 0}},
+        {{12418, 9088, 6437}, {12436, 11360, 10476}, {12988, 11360, 7845}, {13002, 12496, 11324}, {13272, 12496, 8709}, {13288, 13064, 11801}, {13416, 13064, 11170}, {13406, 0, 0}},
+        {{0, 0, 0}, {24886, 22720, 20952}, {0, 0, 0}, {26022, 24992, 22649}, {0, 0, 0}, {26592, 26128, 23603}, {26836, 0, 0}, {26812, 0, 0}}
+      },
+      {
+        {{764, 568, 402}, {768, 710, 654}, {798, 710, 490}, {804, 780, 707}, {818, 780, 544}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+        {{1522, 1136, 804}, {1532, 1420, 1309}, {1596, 1420, 980}, {1602, 1562, 1415}, {1632, 1562, 1088}, {0, 0, 0}, {1646, 1632, 1396}, {0, 0, 0}},
+        {{3084, 2272, 1609}, {3092, 2840, 2619}, {3228, 2840, 1961}, {3234, 3124, 2831}, {3298, 3124, 2177}, {0, 0, 0}, {3328, 3266, 2792}, {0, 0, 0}},
+        {{6296, 4608, 3264}, {6298, 5760, 5312}, {6584, 5760, 3978}, {6588, 6336, 5742}, {6728, 6336, 4416}, {0, 0, 0}, {6788, 6624, 5664}, {6788, 0, 0}},
+        {{12678, 9280, 6573}, {12698, 11600, 10697}, {13262, 11600, 8011}, {13276, 12760, 11563}, {13552, 12760, 8893}, {13568, 13340, 12051}, {13698, 13340, 11406}, {13688, 0, 0}},
+        {{0, 0, 0}, {25412, 23200, 21395}, {0, 0, 0}, {26572, 25520, 23127}, {0, 0, 0}, {27152, 26680, 24102}, {27404, 0, 0}, {27376, 0, 0}}
+      }
+    };
+
+    static int
+    fft_index(dvbt2_fftsize_t fftsize)
+    {
+        switch (fftsize)
+        {
+            case gr::dvbt2::FFTSIZE_1K:
+                return 0;
+            case gr::dvbt2::FFTSIZE_2K:
+                return 1;
+            case gr::dvbt2::FFTSIZE_4K:
+                return 2;
+            case gr::dvbt2::FFTSIZE_8K:
+            case gr::dvbt2::FFTSIZE_8K_T2GI:
+                return 3;
+            case gr::dvbt2::FFTSIZE_16K:
+            case gr::dvbt2::FFTSIZE_16K_T2GI:
+                return 4;
+            default:
+                return 5;
+        }
+    }
+
+    static bool
+    siso_preamble(dvbt2_preamble_t preamble)
+    {
+        return preamble == gr::dvbt2::PREAMBLE_T2_SISO || preamble == gr::dvbt2::PREAMBLE_T2_LITE_SISO;
+    }
+
+    static int
+    bits_per_cell(dvbt2_constellation_t constellation)
+    {
+        switch (constellation)
+        {
+            case gr::dvbt2::MOD_QPSK:
+                return 2;
+            case gr::dvbt2::MOD_16QAM:
+                return 4;
+            case gr::dvbt2::MOD_64QAM:
+                return 6;
+            default:
+                return 8;
+        }
+    }
+
+    /*
+     * K_bch of Tables 6a and 6b, as bbheader_bb takes it.
+     */
+    static int
+    bch_info_bits(dvbt2_framesize_t framesize, dvbt2_code_rate_t rate)
+    {
+        static const int normal[8] = {32208, 38688, 43040, 48408, 51648, 53840, 32208, 32208};
+        static const int shortframe[8] = {7032, 9552, 10632, 11712, 12432, 13152, 5232, 6312};
+
+        return framesize == gr::dvbt2::FECFRAME_NORMAL ? normal[rate] : shortframe[rate];
+    }
+
+    t2_geometry::t2_geometry(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_pilotpattern_t pilotpattern, dvbt2_guardinterval_t guardinterval, dvbt2_papr_t paprmode, dvbt2_preamble_t preamble)
+    {
+        int fft = fft_index(fftsize);
+        const carrier_cells &cells = data_cells[carriermode == gr::dvbt2::CARRIERS_NORMAL ? 0 : 1][fft][pilotpattern];
+
+        fft_size = fft_sizes[fft];
+        guard_interval = guard_length(fftsize, guardinterval);
+        N_P2 = p2_symbol_count[fft];
+        C_P2 = siso_preamble(preamble) ? p2_cells_siso[fft] : p2_cells_miso[fft];
+        C_DATA = cells.C_DATA;
+        N_FC = cells.N_FC;
+        C_FC = cells.C_FC;
+        if (paprmode == gr::dvbt2::PAPR_TR || paprmode == gr::dvbt2::PAPR_BOTH)
+        {
+            if (C_DATA != 0)
+            {
+                C_DATA -= tr_carriers[fft];
+            }
+            if (N_FC != 0)
+            {
+                N_FC -= tr_carriers[fft];
+            }
+            if (C_FC != 0)
+            {
+                C_FC -= tr_carriers[fft];
+            }
+        }
+        // Without a frame closing symbol in SISO mode, Table 59 note.
+        if (siso_preamble(preamble))
+        {
+            if ((guardinterval == gr::dvbt2::GI_1_128 && pilotpattern == gr::dvbt2::PILOT_PP7) ||
+                (guardinterval == gr::dvbt2::GI_1_32 && pilotpattern == gr::dvbt2::PILOT_PP4) ||
+                (guardinterval == gr::dvbt2::GI_1_16 && pilotpattern == gr::dvbt2::PILOT_PP2) ||
+                (guardinterval == gr::dvbt2::GI_19_256 && pilotpattern == gr::dvbt2::PILOT_PP2))
+            {
+                N_FC = 0;
+                C_FC = 0;
+            }
+        }
+    }
+
+    int
+    t2_geometry::fft_length(dvbt2_fftsize_t fftsize)
+    {
+        return fft_sizes[fft_index(fftsize)];
+    }
+
+    int
+    t2_geometry::guard_length(dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval)
+    {
+        int fft = fft_length(fftsize);
+
+        switch (guardinterval)
+        {
+            case gr::dvbt2::GI_1_32:
+                return fft / 32;
+            case gr::dvbt2::GI_1_16:
+                return fft / 16;
+            case gr::dvbt2::GI_1_8:
+                return fft / 8;
+            case gr::dvbt2::GI_1_4:
+                return fft / 4;
+            case gr::dvbt2::GI_1_128:
+                return fft / 128;
+            case gr::dvbt2::GI_19_128:
+                return (fft * 19) / 128;
+            default:
+                return (fft * 19) / 256;
+        }
+    }
+
+    int
+    t2_geometry::p2_symbols(dvbt2_fftsize_t fftsize)
+    {
+        return p2_symbol_count[fft_index(fftsize)];
+    }
+
+    bool
+    t2_geometry::allowed(dvbt2_extended_carrier_t carriermode, dvbt2_fftsize_t fftsize, dvbt2_guardinterval_t guardinterval, dvbt2_pilotpattern_t pilotpattern)
+    {
+        // Columns 1/128, 1/32, 1/16, 19/256, 1/8, 19/128, 1/4, one bit
+        // per pattern.
+        static const int patterns[4][7] =
+        {
+            {0x40, 0x28, 0x8a, 0x8a, 0x82, 0x82, 0x00},    // 32K
+            {0x40, 0x68, 0x9a, 0x9a, 0x86, 0x86, 0x81},    // 16K
+            {0x40, 0x48, 0x98, 0x98, 0x86, 0x86, 0x81},    // 8K
+            {0x00, 0x48, 0x18, 0x00, 0x06, 0x00, 0x01}     // 4K, 2K, 1K
+        };
+        static const int columns[7] = {1, 2, 4, 6, 0, 5, 3};
+        int fft = fft_index(fftsize);
+
+        if (carriermode == gr::dvbt2::CARRIERS_EXTENDED && fft < 3)
+        {
+            return false;
+        }
+        if (fftsize == gr::dvbt2::FFTSIZE_1K && guardinterval == gr::dvbt2::GI_1_32)
+        {
+            return false;
+        }
+        return (patterns[fft < 3 ? 3 : 5 - fft][columns[guardinterval]] >> pilotpattern) & 1;
+    }
+
+    int
+    t2_geometry::frame_cells(int numdatasyms) const
+    {
+        if (N_FC == 0)
+        {
+            return (N_P2 * C_P2) + (numdatasyms * C_DATA);
+        }
+        return (N_P2 * C_P2) + ((numdatasyms - 1) * C_DATA) + N_FC;
+    }
+
+    int
+    t2_geometry::frame_samples(int numdatasyms) const
+    {
+        return ((N_P2 + numdatasyms) * (fft_size + guard_interval)) + p1_samples;
+    }
+
+    int
+    t2_geometry::l1_post_bits(dvbt2_l1constellation_t l1constellation) const
+    {
+        static const int eta[4] = {1, 2, 4, 6};
+        int eta_mod = eta[l1constellation];
+        int N_punc_temp = (6 * (l1_kbch - l1_post_info_bits)) / 5;
+        int N_post_temp = l1_post_info_bits + l1_bch_parity + 9000 - N_punc_temp;
+        int step = N_P2 == 1 ? 2 * eta_mod : eta_mod * N_P2;
+
+        return ((N_post_temp + step - 1) / step) * step;
+    }
+
+    int
+    t2_geometry::fec_capacity(int numdatasyms, int cell_size, dvbt2_l1constellation_t l1constellation) const
+    {
+        static const int eta[4] = {1, 2, 4, 6};
+
+        return (frame_cells(numdatasyms) - l1_pre_cells - (l1_post_bits(l1constellation) / eta[l1constellation]) - (N_FC - C_FC)) / cell_size;
+    }
+
+    t2_constraints::t2_constraints()
+      : max_frame_ms(250.0),
+        min_frame_ms(0.0),
+        max_fecblocks(gr::dvbt2::max_fecblocks),
+        max_ti_cells(ti_memory_cells),
+        max_memory_bytes(0.0)
+    {
+    }
+
+    t2_capacity::t2_capacity(const t2_params &params)
+    {
+        t2_geometry geometry(params.carriermode, params.fftsize, params.pilotpattern, params.guardinterval, params.paprmode, params.preamble);
+        int ldpc_bits = params.framesize == gr::dvbt2::FECFRAME_NORMAL ? FRAME_SIZE_NORMAL : FRAME_SIZE_SHORT;
+        int cell_size = ldpc_bits / bits_per_cell(params.constellation);
+        int tiblocks = params.tiblocks > 0 ? params.tiblocks : 1;
+        double bytes;
+
+        fec_capacity = geometry.fec_capacity(params.numdatasyms, cell_size, params.l1constellation);
+        frame_cells = geometry.frame_cells(params.numdatasyms);
+        frame_symbols = geometry.N_P2 + params.numdatasyms;
+        frame_samples = geometry.frame_samples(params.numdatasyms);
+        ti_cells = ((params.fecblocks + tiblocks - 1) / tiblocks) * cell_size;
+        sample_rate = params.sample_rate();
+        frame_seconds = frame_samples / sample_rate;
+
+        // bbheader_bb fills each BBFRAME with DFL bits of user packets
+        // and takes the first one's in-band type B signalling from it.
+        bytes = (double) params.fecblocks * ((bch_info_bits(params.framesize, params.rate) - 80) / 8);
+        if (params.inband == gr::dvbt2::INBAND_ON)
+        {
+            bytes -= 13;
+        }
+        if (params.inputmode == gr::dvbt2::INPUTMODE_HIEFF)
+        {
+            bytes = bytes * 188.0 / 187.0;
+        }
+        bitrate = bytes * 8.0 / frame_seconds;
+        fecframes_per_second = params.fecblocks / frame_seconds;
+        symbols_per_second = frame_symbols / frame_seconds;
+        cells_per_second = frame_cells / frame_seconds;
+
+        double stream_cells = (double) params.fecblocks * cell_size;
+        double chain_cells = stream_cells > frame_cells ? stream_cells : frame_cells;
+        memory_bytes = sizeof(gr_complex) * ((4.0 * chain_cells) + (2.0 * frame_symbols * geometry.fft_size) + stream_cells + (2.0 * frame_cells) + frame_samples);
+    }
+
+    const char *
+    t2_capacity::check(const t2_params &params, const t2_constraints &constraints) const
+    {
+        if (!t2_geometry::allowed(params.carriermode, params.fftsize, params.guardinterval, params.pilotpattern))
+        {
+            return "pilot pattern or carrier mode not allowed with this FFT size and guard interval";
+        }
+        if (params.numdatasyms < 1 || params.numdatasyms > max_numdatasyms)
+        {
+            return "numdatasyms out of range";
+        }
+        if (params.fecblocks < 1 || params.fecblocks > constraints.max_fecblocks)
+        {
+            return "fecblocks out of range";
+        }
+        if (params.fecblocks > fec_capacity)
+        {
+            return "more FEC blocks than the T2 frame has room for";
+        }
+        if (params.tiblocks < 1 || params.tiblocks > params.fecblocks || params.tiblocks > max_tiblocks)
+        {
+            return "tiblocks out of range";
+        }
+        if (ti_cells > constraints.max_ti_cells)
+        {
+            return "TI block larger than the time interleaver memory";
+        }
+        if (frame_seconds * 1e3 > constraints.max_frame_ms)
+        {
+            return "T2 frame too long";
+        }
+        if (frame_seconds * 1e3 < constraints.min_frame_ms)
+        {
+            return "T2 frame too short";
+        }
+        if (constraints.max_memory_bytes > 0.0 && memory_bytes > constraints.max_memory_bytes)
+        {
+            return "frame buffers larger than the memory limit";
+        }
+        return NULL;
+    }
+
+    bool
+    t2_capacity::solve(t2_params &params, const t2_constraints &constraints)
+    {
+        t2_geometry geometry(params.carriermode, params.fftsize, params.pilotpattern, params.guardinterval, params.paprmode, params.preamble);
+        int ldpc_bits = params.framesize == gr::dvbt2::FECFRAME_NORMAL ? FRAME_SIZE_NORMAL : FRAME_SIZE_SHORT;
+        int cell_size = ldpc_bits / bits_per_cell(params.constellation);
+        int blocks_per_ti = constraints.max_ti_cells / cell_size;
+        double symbol_seconds = (geometry.fft_size + geometry.guard_interval) / params.sample_rate();
+        int last = (int) ((constraints.max_frame_ms * 1e-3 - p1_samples / params.sample_rate()) / symbol_seconds) - geometry.N_P2;
+        t2_params best = params;
+        double best_bitrate = 0.0;
+
+        if (blocks_per_ti < 1)
+        {
+            return false;
+        }
+        if (last > max_numdatasyms)
+        {
+            last = max_numdatasyms;
+        }
+        // Each symbol adds C_DATA cells, not always a whole FEC block,
+        // so every frame length is tried.
+        for (int numdatasyms = 1; numdatasyms <= last; numdatasyms++)
+        {
+            t2_params trial = params;
+            int fecblocks = geometry.fec_capacity(numdatasyms, cell_size, params.l1constellation);
+
+            if (fecblocks > constraints.max_fecblocks)
+            {
+                fecblocks = constraints.max_fecblocks;
+            }
+            if (fecblocks < 1)
+            {
+                continue;
+            }
+            trial.numdatasyms = numdatasyms;
+            trial.fecblocks = fecblocks;
+            trial.tiblocks = (fecblocks + blocks_per_ti - 1) / blocks_per_ti;
+            t2_capacity capacity(trial);
+            if (capacity.check(trial, constraints) == NULL && capacity.bitrate > best_bitrate)
+            {
+                best = trial;
+                best_bitrate = capacity.bitrate;
+            }
+        }
+        if (best_bitrate == 0.0)
+        {
+            return false;
+        }
+        params = best;
+        return true;
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
@@ -0,0 +1,506 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dvbt2/t2_params.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+namespace gr {
+  namespace dvbt2 {
+
+struct t2_name
+{
+    const char *name;
+    int value;
+};
+
+// prefix is the length of the part of the names that may be left out.
+struct t2_enum
+{
+    const char *key;
+    int prefix;
+    const t2_name *names;
+};
+
+static const t2_name framesize_names[] = {
+    {"FECFRAME_SHORT", 0},
+    {"FECFRAME_NORMAL", 1},
+    {NULL, 0}
+};
+
+static const t2_name rate_names[] = {
+    {"C1_2", 0},
+    {"C3_5", 1},
+    {"C2_3", 2},
+    {"C3_4", 3},
+    {"C4_5", 4},
+    {"C5_6", 5},
+    {"C1_3", 6},
+    {"C2_5", 7},
+    {NULL, 0}
+};
+
+static const t2_name constellation_names[] = {
+    {"MOD_QPSK", 0},
+    {"MOD_16QAM", 1},
+    {"MOD_64QAM", 2},
+    {"MOD_256QAM", 3},
+    {NULL, 0}
+};
+
+static const t2_name rotation_names[] = {
+    {"ROTATION_OFF", 0},
+    {"ROTATION_ON", 1},
+    {NULL, 0}
+};
+
+static const t2_name carriermode_names[] = {
+    {"CARRIERS_NORMAL", 0},
+    {"CARRIERS_EXTENDED", 1},
+    {NULL, 0}
+};
+
+static const t2_name fftsize_names[] = {
+    {"FFTSIZE_2K", 0},
+    {"FFTSIZE_8K", 1},
+    {"FFTSIZE_4K", 2},
+    {"FFTSIZE_1K", 3},
+    {"FFTSIZE_16K", 4},
+    {"FFTSIZE_32K", 5},
+    {"FFTSIZE_8K_T2GI", 6},
+    {"FFTSIZE_32K_T2GI", 7},
+    {"FFTSIZE_16K_T2GI", 11},
+    {NULL, 0}
+};
+
+static const t2_name guardinterval_names[] = {
+    {"GI_1_32", 0},
+    {"GI_1_16", 1},
+    {"GI_1_8", 2},
+    {"GI_1_4", 3},
+    {"GI_1_128", 4},
+    {"GI_19_128", 5},
+    {"GI_19_256", 6},
+    {NULL, 0}
+};
+
+static const t2_name l1constellation_names[] = {
+    {"L1_MOD_BPSK", 0},
+    {"L1_MOD_QPSK", 1},
+    {"L1_MOD_16QAM", 2},
+    {"L1_MOD_64QAM", 3},
+    {NULL, 0}
+};
+
+static const t2_name pilotpattern_names[] = {
+    {"PILOT_PP1", 0},
+    {"PILOT_PP2", 1},
+    {"PILOT_PP3", 2},
+    {"PILOT_PP4", 3},
+    {"PILOT_PP5", 4},
+    {"PILOT_PP6", 5},
+    {"PILOT_PP7", 6},
+    {"PILOT_PP8", 7},
+    {NULL, 0}
+};
+
+static const t2_name paprmode_names[] = {
+    {"PAPR_OFF", 0},
+    {"PAPR_ACE", 1},
+    {"PAPR_TR", 2},
+    {"PAPR_BOTH", 3},
+    {NULL, 0}
+};
+
+static const t2_name version_names[] = {
+    {"VERSION_111", 0},
+    {"VERSION_121", 1},
+    {"VERSION_131", 2},
+    {NULL, 0}
+};
+
+static const t2_name preamble_names[] = {
+    {"PREAMBLE_T2_SISO", 0},
+    {"PREAMBLE_T2_MISO", 1},
+    {"PREAMBLE_NON_T2", 2},
+    {"PREAMBLE_T2_LITE_SISO", 3},
+    {"PREAMBLE_T2_LITE_MISO", 4},
+    {NULL, 0}
+};
+
+static const t2_name inputmode_names[] = {
+    {"INPUTMODE_NORMAL", 0},
+    {"INPUTMODE_HIEFF", 1},
+    {NULL, 0}
+};
+
+static const t2_name reservedbiasbits_names[] = {
+    {"RESERVED_OFF", 0},
+    {"RESERVED_ON", 1},
+    {NULL, 0}
+};
+
+static const t2_name l1scrambled_names[] = {
+    {"L1_SCRAMBLED_OFF", 0},
+    {"L1_SCRAMBLED_ON", 1},
+    {NULL, 0}
+};
+
+static const t2_name inband_names[] = {
+    {"INBAND_OFF", 0},
+    {"INBAND_ON", 1},
+    {NULL, 0}
+};
+
+static const t2_name misogroup_names[] = {
+    {"MISO_TX1", 0},
+    {"MISO_TX2", 1},
+    {"MISO_BOTH", 2},
+    {NULL, 0}
+};
+
+static const t2_name equalization_names[] = {
+    {"EQUALIZATION_OFF", 0},
+    {"EQUALIZATION_ON", 1},
+    {NULL, 0}
+};
+
+static const t2_name bandwidth_names[] = {
+    {"BANDWIDTH_1_7_MHZ", 0},
+    {"BANDWIDTH_5_0_MHZ", 1},
+    {"BANDWIDTH_6_0_MHZ", 2},
+    {"BANDWIDTH_7_0_MHZ", 3},
+    {"BANDWIDTH_8_0_MHZ", 4},
+    {"BANDWIDTH_10_0_MHZ", 5},
+    {NULL, 0}
+};
+
+static const t2_enum t2_enums[] = {
+    {"framesize", 9, framesize_names},
+    {"rate", 1, rate_names},
+    {"constellation", 4, constellation_names},
+    {"rotation", 9, rotation_names},
+    {"carriermode", 9, carriermode_names},
+    {"fftsize", 8, fftsize_names},
+    {"guardinterval", 3, guardinterval_names},
+    {"l1constellation", 7, l1constellation_names},
+    {"pilotpattern", 6, pilotpattern_names},
+    {"paprmode", 5, paprmode_names},
+    {"version", 8, version_names},
+    {"preamble", 9, preamble_names},
+    {"inputmode", 10, inputmode_names},
+    {"reservedbiasbits", 9, reservedbiasbits_names},
+    {"l1scrambled", 13, l1scrambled_names},
+    {"inband", 7, inband_names},
+    {"misogroup", 5, misogroup_names},
+    {"equalization", 13, equalization_names},
+    {"bandwidth", 10, bandwidth_names},
+    {NULL, 0, NULL}
+};
+
+static const t2_enum *
+find_enum(const char *key)
+{
+    for (int i = 0; t2_enums[i].key != NULL; i++)
+    {
+        if (strcmp(t2_enums[i].key, key) == 0)
+        {
+            return &t2_enums[i];
+        }
+    }
+    return NULL;
+}
+
+static bool
+enum_value(const t2_enum *e, const char *value, int *result)
+{
+    for (int i = 0; e->names[i].name != NULL; i++)
+    {
+        if (strcasecmp(e->names[i].name, value) == 0 || strcasecmp(e->names[i].name + e->prefix, value) == 0)
+        {
+            *result = e->names[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool
+int_value(const char *value, int *result)
+{
+    char *end;
+    long v = strtol(value, &end, 0);
+
+    if (*value == '\0' || *end != '\0')
+    {
+        return false;
+    }
+    *result = (int) v;
+    return true;
+}
+
+static bool
+float_value(const char *value, float *result)
+{
+    char *end;
+    double v = strtod(value, &end);
+
+    if (*value == '\0' || *end != '\0')
+    {
+        return false;
+    }
+    *result = (float) v;
+    return true;
+}
+
+    t2_params::t2_params()
+      : framesize(FECFRAME_NORMAL),
+        rate(C2_3),
+        constellation(MOD_64QAM),
+        rotation(ROTATION_ON),
+        fecblocks(31),
+        tiblocks(3),
+        carriermode(CARRIERS_NORMAL),
+        fftsize(FFTSIZE_4K),
+        guardinterval(GI_1_32),
+        l1constellation(L1_MOD_16QAM),
+        pilotpattern(PILOT_PP7),
+        t2frames(2),
+        numdatasyms(100),
+        paprmode(PAPR_OFF),
+        version(VERSION_111),
+        preamble(PREAMBLE_T2_SISO),
+        inputmode(INPUTMODE_NORMAL),
+        reservedbiasbits(RESERVED_OFF),
+        l1scrambled(L1_SCRAMBLED_OFF),
+        inband(INBAND_OFF),
+        tsrate(4000000),
+        misogroup(MISO_TX1),
+        equalization(EQUALIZATION_ON),
+        bandwidth(BANDWIDTH_8_0_MHZ),
+        vclip(3.3),
+        iterations(3),
+        acevclip(2.5),
+        acegain(2.0),
+        acelimit(1.4),
+        aceiterations(1)
+    {
+    }
+
+    bool
+    t2_params::set(const char *key, const char *value)
+    {
+        const t2_enum *e = find_enum(key);
+        int value_index;
+
+        if (e != NULL)
+        {
+            if (!enum_value(e, value, &value_index))
+            {
+                return false;
+            }
+            if (strcmp(key, "framesize") == 0)
+            {
+                framesize = (dvbt2_framesize_t) value_index;
+            }
+            else if (strcmp(key, "rate") == 0)
+            {
+                rate = (dvbt2_code_rate_t) value_index;
+            }
+            else if (strcmp(key, "constellation") == 0)
+            {
+                constellation = (dvbt2_constellation_t) value_index;
+            }
+            else if (strcmp(key, "rotation") == 0)
+            {
+                rotation = (dvbt2_rotation_t) value_index;
+            }
+            else if (strcmp(key, "carriermode") == 0)
+            {
+                carriermode = (dvbt2_extended_carrier_t) value_index;
+            }
+            else if (strcmp(key, "fftsize") == 0)
+            {
+                fftsize = (dvbt2_fftsize_t) value_index;
+            }
+            else if (strcmp(key, "guardinterval") == 0)
+            {
+                guardinterval = (dvbt2_guardinterval_t) value_index;
+            }
+            else if (strcmp(key, "l1constellation") == 0)
+            {
+                l1constellation = (dvbt2_l1constellation_t) value_index;
+            }
+            else if (strcmp(key, "pilotpattern") == 0)
+            {
+                pilotpattern = (dvbt2_pilotpattern_t) value_index;
+            }
+            else if (strcmp(key, "paprmode") == 0)
+            {
+                paprmode = (dvbt2_papr_t) value_index;
+            }
+            else if (strcmp(key, "version") == 0)
+            {
+                version = (dvbt2_version_t) value_index;
+            }
+            else if (strcmp(key, "preamble") == 0)
+            {
+                preamble = (dvbt2_preamble_t) value_index;
+            }
+            else if (strcmp(key, "inputmode") == 0)
+            {
+                inputmode = (dvbt2_inputmode_t) value_index;
+            }
+            else if (strcmp(key, "reservedbiasbits") == 0)
+            {
+                reservedbiasbits = (dvbt2_reservedbiasbits_t) value_index;
+            }
+            else if (strcmp(key, "l1scrambled") == 0)
+            {
+                l1scrambled = (dvbt2_l1scrambled_t) value_index;
+            }
+            else if (strcmp(key, "inband") == 0)
+            {
+                inband = (dvbt2_inband_t) value_index;
+            }
+            else if (strcmp(key, "misogroup") == 0)
+            {
+                misogroup = (dvbt2_misogroup_t) value_index;
+            }
+            else if (strcmp(key, "equalization") == 0)
+            {
+                equalization = (dvbt2_equalization_t) value_index;
+            }
+            else if (strcmp(key, "bandwidth") == 0)
+            {
+                bandwidth = (dvbt2_bandwidth_t) value_index;
+            }
+            return true;
+        }
+        if (strcmp(key, "fecblocks") == 0)
+        {
+            return int_value(value, &fecblocks);
+        }
+        if (strcmp(key, "tiblocks") == 0)
+        {
+            return int_value(value, &tiblocks);
+        }
+        if (strcmp(key, "t2frames") == 0)
+        {
+            return int_value(value, &t2frames);
+        }
+        if (strcmp(key, "numdatasyms") == 0)
+        {
+            return int_value(value, &numdatasyms);
+        }
+        if (strcmp(key, "tsrate") == 0)
+        {
+            return int_value(value, &tsrate);
+        }
+        if (strcmp(key, "iterations") == 0)
+        {
+            return int_value(value, &iterations);
+        }
+        if (strcmp(key, "aceiterations") == 0)
+        {
+            return int_value(value, &aceiterations);
+        }
+        if (strcmp(key, "vclip") == 0)
+        {
+            return float_value(value, &vclip);
+        }
+        if (strcmp(key, "acevclip") == 0)
+        {
+            return float_value(value, &acevclip);
+        }
+        if (strcmp(key, "acegain") == 0)
+        {
+            return float_value(value, &acegain);
+        }
+        if (strcmp(key, "acelimit") == 0)
+        {
+            return float_value(value, &acelimit);
+        }
+        return false;
+    }
+
+    double
+    t2_params::sample_rate() const
+    {
+        switch (bandwidth)
+        {
+            case BANDWIDTH_1_7_MHZ:
+                return 131000000.0 / 71.0;
+            case BANDWIDTH_5_0_MHZ:
+                return 40000000.0 / 7.0;
+            case BANDWIDTH_6_0_MHZ:
+                return 48000000.0 / 7.0;
+            case BANDWIDTH_7_0_MHZ:
+                return 8000000.0;
+            case BANDWIDTH_10_0_MHZ:
+                return 80000000.0 / 7.0;
+            default:
+                return 64000000.0 / 7.0;
+        }
+    }
+
+    void
+    t2_params::usage(FILE *stream)
+    {
+        static const char *const numbers[] = {
+            "fecblocks",
+            "tiblocks",
+            "t2frames",
+            "numdatasyms",
+            "tsrate",
+            "iterations",
+            "aceiterations",
+            "vclip",
+            "acevclip",
+            "acegain",
+            "acelimit",
+            NULL
+        };
+
+        for (int i = 0; t2_enums[i].key != NULL; i++)
+        {
+            fprintf(stream, "  --%s", t2_enums[i].key);
+            for (int j = 0; t2_enums[i].names[j].name != NULL; j++)
+            {
+                fprintf(stream, "%s%s", j ? "|" : " ", t2_enums[i].names[j].name + t2_enums[i].prefix);
+            }
+            fprintf(stream, "\n");
+        }
+        for (int i = 0; numbers[i] != NULL; i++)
+        {
+            fprintf(stream, "  --%s n\n", numbers[i]);
+        }
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifndef INCLUDED_DVBT2_TRACE_BUFFER_H
+#define INCLUDED_DVBT2_TRACE_BUFFER_H
+
+#include <gnuradio/high_res_timer.h>
+#include <string>
+
+namespace gr {
+  namespace dvbt2 {
+
+    /*
+     * Recording side of dvbt2::tracer. A span is taken with
+     *
+     *   gr::high_res_timer_type start = trace_now();
+     *   ...
+     *   trace_span("ldpc", TRACE_FECFRAME, j, start);
+     *
+     * trace_now() is 0 while the tracer is stopped, and a span that
+     * started at 0 is not recorded. Names must outlive the trace,
+     * string literals or trace_name().
+     */
+    enum trace_unit
+    {
+      TRACE_WORK = 0,
+      TRACE_FECFRAME,
+      TRACE_TIBLOCK,
+      TRACE_SYMBOL,
+      TRACE_T2FRAME,
+      TRACE_UNITS
+    };
+
+    extern int trace_enabled;
+
+    void trace_record(const char *name, int unit, int index, gr::high_res_timer_type start, gr::high_res_timer_type end);
+    const char *trace_name(const std::string &name);
+
+    static inline bool
+    trace_on(void)
+    {
+        return __atomic_load_n(&trace_enabled, __ATOMIC_RELAXED) != 0;
+    }
+
+    static inline gr::high_res_timer_type
+    trace_now(void)
+    {
+        return trace_on() ? gr::high_res_timer_now() : 0;
+    }
+
+    static inline void
+    trace_span(const char *name, int unit, int index, gr::high_res_timer_type start)
+    {
+        if (start != 0)
+        {
+            trace_record(name, unit, index, start, gr::high_res_timer_now());
+        }
+    }
+
+  } // namespace dvbt2
+} // namespace gr
+
+#endif /* INCLUDED_DVBT2_TRACE_BUFFER_H */
+
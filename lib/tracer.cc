@@ -0,0 +1,301 @@
+/* -*- c++ -*- */
+/* 
+ * Copyright 2014 Ron Economos.
+ * 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <dvbt2/tracer.h>
+#include "trace_buffer.h"
+#include <gnuradio/thread/thread.h>
+#include <volk/volk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <set>
+#include <vector>
+#include <unistd.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace gr {
+  namespace dvbt2 {
+
+    int trace_enabled = 0;
+
+    struct trace_event
+    {
+      gr::high_res_timer_type start;
+      gr::high_res_timer_type end;
+      const char *name;
+      int unit;
+      int index;
+    };
+
+    /*
+     * Events of one thread. Only that thread writes, and it publishes
+     * each event by moving head on. A reader copies the ring and then
+     * drops what may have been overwritten meanwhile.
+     */
+    struct trace_ring
+    {
+      trace_event *events;
+      unsigned int mask;
+      unsigned int head;
+      // Events before first were cleared, set under trace_mutex.
+      unsigned int first;
+      long tid;
+      std::string thread;
+    };
+
+    static const char *unit_names[TRACE_UNITS] = {"work", "fecframe", "tiblock", "symbol", "t2frame"};
+    static const char *index_names[TRACE_UNITS] = {"items", "fecframe", "tiblock", "symbol", "frame"};
+
+    static gr::thread::mutex trace_mutex;
+    static std::vector<trace_ring *> trace_rings;
+    static std::set<std::string> trace_names;
+    static unsigned int trace_events = 65536;
+    // Rings of threads that have exited, for the next new thread.
+    static std::vector<trace_ring *> free_rings;
+    static pthread_key_t ring_key;
+    static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+    static __thread trace_ring *thread_ring = NULL;
+
+// Runs when a thread that recorded exits.
+static void
+release_ring(void *ring)
+{
+    gr::thread::scoped_lock lock(trace_mutex);
+    free_rings.push_back((trace_ring *) ring);
+    thread_ring = NULL;
+}
+
+static void
+make_ring_key(void)
+{
+    pthread_key_create(&ring_key, release_ring);
+}
+
+/*
+ * A ring for the calling thread. The ring of a thread that has exited
+ * is taken over, with its events cleared, so threads that come and go
+ * do not each leave a ring behind. NULL without memory, the thread
+ * then records nothing.
+ */
+static trace_ring *
+new_ring(void)
+{
+    trace_ring *ring;
+    char name[17] = "";
+
+    pthread_once(&ring_key_once, make_ring_key);
+    gr::thread::scoped_lock lock(trace_mutex);
+    if (free_rings.size())
+    {
+        ring = free_rings.back();
+        free_rings.pop_back();
+        ring->first = ring->head;
+    }
+    else
+    {
+        ring = new trace_ring;
+        ring->events = (trace_event *) volk_malloc(sizeof(trace_event) * trace_events, volk_get_alignment());
+        if (ring->events == NULL)
+        {
+            fprintf(stderr, "Tracer volk_malloc, Out of memory.\n");
+            delete ring;
+            return NULL;
+        }
+        ring->mask = trace_events - 1;
+        ring->head = 0;
+        ring->first = 0;
+        trace_rings.push_back(ring);
+    }
+#ifdef __linux__
+    ring->tid = syscall(SYS_gettid);
+    prctl(PR_GET_NAME, name, 0, 0, 0);
+#else
+    ring->tid = trace_rings.size();
+#endif
+    ring->thread = name;
+    pthread_setspecific(ring_key, ring);
+    return ring;
+}
+
+// Writes text as a JSON string.
+static void
+json_string(FILE *fp, const char *text)
+{
+    fputc('"', fp);
+    for (const char *c = text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fprintf(fp, "\\%c", *c);
+        }
+        else if ((unsigned char) *c < 0x20)
+        {
+            fprintf(fp, "\\u%04x", (unsigned char) *c);
+        }
+        else
+        {
+            fputc(*c, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+    void
+    trace_record(const char *name, int unit, int index, gr::high_res_timer_type start, gr::high_res_timer_type end)
+    {
+        trace_ring *ring = thread_ring;
+        trace_event *event;
+
+        if (ring == NULL)
+        {
+            ring = thread_ring = new_ring();
+            if (ring == NULL)
+            {
+                return;
+            }
+        }
+        event = &ring->events[ring->head & ring->mask];
+        event->start = start;
+        event->end = end;
+        event->name = name;
+        event->unit = unit;
+        event->index = index;
+        __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+    }
+
+    const char *
+    trace_name(const std::string &name)
+    {
+        gr::thread::scoped_lock lock(trace_mutex);
+        return trace_names.insert(name).first->c_str();
+    }
+
+    void
+    tracer::start(int events)
+    {
+        unsigned int size = 1;
+
+        // Rings are a power of two, and keep their size once made.
+        while (size < (unsigned int) events && size < 0x40000000)
+        {
+            size <<= 1;
+        }
+        gr::thread::scoped_lock lock(trace_mutex);
+        trace_events = size;
+        for (unsigned int i = 0; i < trace_rings.size(); i++)
+        {
+            trace_rings[i]->first = __atomic_load_n(&trace_rings[i]->head, __ATOMIC_ACQUIRE);
+        }
+        __atomic_store_n(&trace_enabled, 1, __ATOMIC_RELAXED);
+    }
+
+    void
+    tracer::stop()
+    {
+        __atomic_store_n(&trace_enabled, 0, __ATOMIC_RELAXED);
+    }
+
+    bool
+    tracer::enabled()
+    {
+        return __atomic_load_n(&trace_enabled, __ATOMIC_RELAXED) != 0;
+    }
+
+    bool
+    tracer::write(const std::string &filename)
+    {
+        FILE *fp = fopen(filename.c_str(), "w");
+        std::vector<std::vector<trace_event> > copies;
+        gr::high_res_timer_type base = 0;
+        double us_per_tick = 1e6 / gr::high_res_timer_tps();
+        bool first = true;
+        long pid = getpid();
+
+        if (fp == NULL)
+        {
+            return false;
+        }
+        gr::thread::scoped_lock lock(trace_mutex);
+        copies.resize(trace_rings.size());
+        for (unsigned int i = 0; i < trace_rings.size(); i++)
+        {
+            trace_ring *ring = trace_rings[i];
+            unsigned int size = ring->mask + 1;
+            unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+            unsigned int from = head - ring->first > size ? head - size : ring->first;
+            std::vector<trace_event> &copy = copies[i];
+
+            for (unsigned int n = from; n != head; n++)
+            {
+                copy.push_back(ring->events[n & ring->mask]);
+            }
+            // The writer may have lapped the copy, keep what is
+            // still older than a full ring.
+            head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+            if (head - from > size)
+            {
+                copy.erase(copy.begin(), copy.begin() + std::min((size_t) (head - from - size), copy.size()));
+            }
+            for (unsigned int n = 0; n < copy.size(); n++)
+            {
+                if (base == 0 || copy[n].start < base)
+                {
+                    base = copy[n].start;
+                }
+            }
+        }
+
+        fprintf(fp, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+        for (unsigned int i = 0; i < trace_rings.size(); i++)
+        {
+            trace_ring *ring = trace_rings[i];
+            fprintf(fp, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %ld, \"tid\": %ld, \"args\": {\"name\": ", first ? "" : ",", pid, ring->tid);
+            json_string(fp, ring->thread.c_str());
+            fprintf(fp, "}}");
+            first = false;
+            for (unsigned int n = 0; n < copies[i].size(); n++)
+            {
+                const trace_event &event = copies[i][n];
+                fprintf(fp, ",\n{\"name\": ");
+                json_string(fp, event.name);
+                fprintf(fp, ", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": %ld, \"tid\": %ld, \"ts\": %.3f, \"dur\": %.3f", unit_names[event.unit], pid, ring->tid, (event.start - base) * us_per_tick, (event.end - event.start) * us_per_tick);
+                if (event.index >= 0)
+                {
+                    fprintf(fp, ", \"args\": {\"%s\": %d}", index_names[event.unit], event.index);
+                }
+                fprintf(fp, "}");
+            }
+        }
+        fprintf(fp, "\n]}\n");
+        return fclose(fp) == 0;
+    }
+
+  } /* namespace dvbt2 */
+} /* namespace gr */
+
@@ -22,6 +22,7 @@
 from gnuradio import gr, gr_unittest
 from gnuradio import blocks
 import dvbt2_swig as dvbt2
+import random
 
 class qa_bbheader_bb (gr_unittest.TestCase):
 
@@ -36,6 +37,122 @@ class qa_bbheader_bb (gr_unittest.TestCase):
         self.tb.run ()
         # check data
 
+    def crc8 (self, data):
+        crc = 0
+        for b in data:
+            crc ^= b
+            for n in range(8):
+                if crc & 0x80:
+                    crc = ((crc << 1) ^ 0xd5) & 0xff
+                else:
+                    crc = (crc << 1) & 0xff
+        return crc
+
+    def field (self, bits, start, length):
+        value = 0
+        for b in bits[start:start + length]:
+            value = (value << 1) | b
+        return value
+
+    def deframe (self, bits, kbch, mode, null):
+        # the transport stream back from the BBFRAMEs, with the DNP
+        # null packets in front of each user packet
+        data = []
+        if mode == dvbt2.INPUTMODE_NORMAL:
+            length = 189
+        else:
+            length = 188
+        for f in range(0, len(bits), kbch):
+            self.assertEqual(bits[f + 5], 1)
+            if mode == dvbt2.INPUTMODE_NORMAL:
+                self.assertEqual(self.field(bits, f + 16, 16), 188 * 8)
+                self.assertEqual(self.field(bits, f + 48, 8), 0x47)
+            else:
+                self.assertEqual(self.field(bits, f + 16, 16), 0)
+                self.assertEqual(self.field(bits, f + 48, 8), 0)
+            # SYNCD points at the first user packet that starts in
+            # this data field
+            self.assertEqual(self.field(bits, f + 56, 16), ((length - len(data) % length) % length) * 8)
+            dfl = self.field(bits, f + 32, 16)
+            for i in range(f + 80, f + 80 + dfl, 8):
+                data.append(self.field(bits, i, 8))
+        ts = []
+        crc = 0
+        for p in range(0, len(data) - length + 1, length):
+            packet = data[p:p + length]
+            ts += null * packet[-1]
+            if mode == dvbt2.INPUTMODE_NORMAL:
+                self.assertEqual(packet[0], crc)
+                crc = self.crc8(packet[1:])
+                ts += [0x47] + packet[1:-1]
+            else:
+                ts += [0x47] + packet[:-1]
+        return ts
+
+    def user_packet (self):
+        pid = random.randint(0, 0x1ffe)
+        return [0x47, pid >> 8, pid & 0xff] + [random.randint(0, 255) for j in range(185)]
+
+    def run_npd (self, data, mode, buffer = None):
+        tb = gr.top_block()
+        src = blocks.vector_source_b(data, False)
+        if buffer is not None:
+            src.set_max_output_buffer(buffer)
+        bbheader = dvbt2.bbheader_bb(dvbt2.FECFRAME_SHORT, dvbt2.C1_2, mode, dvbt2.INBAND_OFF, 2, 4000000, dvbt2.NPD_ON)
+        dst = blocks.vector_sink_b()
+        tb.connect(src, bbheader, dst)
+        tb.run()
+        return dst.data()
+
+    def test_002_npd (self):
+        # null packets deleted and put back from the DNP bytes, with a
+        # run longer than DNP can count
+        kbch = 7032
+        null = [0x47, 0x1f, 0xff, 0x10] + [0xff] * 184
+        random.seed(1)
+        data = []
+        for i in range(800):
+            if (i >= 100 and i < 400) or random.randint(0, 3) == 0:
+                data += null
+            else:
+                data += self.user_packet()
+        for mode in (dvbt2.INPUTMODE_NORMAL, dvbt2.INPUTMODE_HIEFF):
+            result = self.run_npd(data, mode)
+            self.assertEqual(len(result) % kbch, 0)
+            ts = self.deframe(result, kbch, mode, null)
+            self.assertTrue(len(ts) > 188 * 700)
+            self.assertEqual(tuple(data[:len(ts)]), tuple(ts))
+
+    def test_003_npd_all_null (self):
+        # only null packets, every 256th goes out as a user packet
+        kbch = 7032
+        null = [0x47, 0x1f, 0xff, 0x10] + [0xff] * 184
+        data = null * (256 * 12)
+        for mode in (dvbt2.INPUTMODE_NORMAL, dvbt2.INPUTMODE_HIEFF):
+            result = self.run_npd(data, mode)
+            self.assertEqual(len(result), 2 * kbch)
+            ts = self.deframe(result, kbch, mode, null)
+            self.assertEqual(tuple(data[:len(ts)]), tuple(ts))
+
+    def test_004_npd_long_burst (self):
+        # a null packet burst far longer than the buffer in front of
+        # the block
+        kbch = 7032
+        null = [0x47, 0x1f, 0xff, 0x10] + [0xff] * 184
+        random.seed(2)
+        data = []
+        for i in range(40):
+            data += self.user_packet()
+        data += null * 200
+        for i in range(40):
+            data += self.user_packet()
+        for mode in (dvbt2.INPUTMODE_NORMAL, dvbt2.INPUTMODE_HIEFF):
+            result = self.run_npd(data, mode, 4096)
+            self.assertEqual(len(result) % kbch, 0)
+            ts = self.deframe(result, kbch, mode, null)
+            self.assertTrue(len(ts) > 188 * 270)
+            self.assertEqual(tuple(data[:len(ts)]), tuple(ts))
+
 
 if __name__ == '__main__':
     gr_unittest.run(qa_bbheader_bb, "qa_bbheader_bb.xml")
@@ -0,0 +1,169 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+# 
+# Copyright 2014 Ron Economos.
+# 
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+# 
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+# 
+
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import dvbt2_swig as dvbt2
+import json
+import os
+import random
+import tempfile
+
+class qa_gateway_bc (gr_unittest.TestCase):
+
+    def setUp (self):
+        self.tb = gr.top_block ()
+
+    def tearDown (self):
+        self.tb = None
+
+    def test_001_t (self):
+        # must match the separate blocks from bbheader_bb to gi_p1_insertion_cc
+        fftsize = 1024
+        fecblocks = 2
+        numdatasyms = 20
+        random.seed(1)
+        data = []
+        for i in range(60):
+            data += [0x47] + [random.randint(0, 255) for j in range(187)]
+        framesize = dvbt2.FECFRAME_SHORT
+        rate = dvbt2.C1_2
+        constellation = dvbt2.MOD_16QAM
+        rotation = dvbt2.ROTATION_ON
+        src = blocks.vector_source_b(data, False)
+        bbheader = dvbt2.bbheader_bb(framesize, rate, dvbt2.INPUTMODE_NORMAL, dvbt2.INBAND_OFF, fecblocks, 4000000)
+        bbscrambler = dvbt2.bbscrambler_bb(framesize, rate)
+        bch = dvbt2.bch_bb(framesize, rate)
+        ldpc = dvbt2.ldpc_bb(framesize, rate)
+        interleaver = dvbt2.interleaver_bb(framesize, rate, constellation)
+        modulator = dvbt2.modulator_bc(framesize, constellation, rotation)
+        cellinterleaver = dvbt2.cellinterleaver_cc(framesize, constellation, fecblocks, 1)
+        framemapper = dvbt2.framemapper_cc(framesize, rate, constellation, rotation, fecblocks, 1, dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.GI_1_8, dvbt2.L1_MOD_QPSK, dvbt2.PILOT_PP4, 2, numdatasyms, dvbt2.PAPR_TR, dvbt2.VERSION_131, dvbt2.PREAMBLE_T2_SISO, dvbt2.INPUTMODE_NORMAL, dvbt2.RESERVED_OFF, dvbt2.L1_SCRAMBLED_OFF, dvbt2.INBAND_OFF)
+        freqinterleaver = dvbt2.freqinterleaver_cc(dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.PILOT_PP4, dvbt2.GI_1_8, numdatasyms, dvbt2.PAPR_TR, dvbt2.VERSION_131, dvbt2.PREAMBLE_T2_SISO)
+        pilotgenerator = dvbt2.pilotgenerator_cc(dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.PILOT_PP4, dvbt2.GI_1_8, numdatasyms, dvbt2.PAPR_TR, dvbt2.VERSION_131, dvbt2.PREAMBLE_T2_SISO, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, fftsize)
+        paprtr = dvbt2.paprtr_cc(dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.PILOT_PP4, dvbt2.GI_1_8, numdatasyms, dvbt2.PAPR_TR, dvbt2.VERSION_131, 3.3, 3, fftsize)
+        gi_p1_insertion = dvbt2.gi_p1_insertion_cc(dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.GI_1_8, numdatasyms, dvbt2.PREAMBLE_T2_SISO)
+        gateway = dvbt2.gateway_bc(framesize, rate, constellation, rotation, fecblocks, 1, dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.GI_1_8, dvbt2.L1_MOD_QPSK, dvbt2.PILOT_PP4, 2, numdatasyms, dvbt2.PAPR_TR, dvbt2.VERSION_131, dvbt2.PREAMBLE_T2_SISO, dvbt2.INPUTMODE_NORMAL, dvbt2.RESERVED_OFF, dvbt2.L1_SCRAMBLED_OFF, dvbt2.INBAND_OFF, 4000000, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, 3.3, 3)
+        expected = blocks.vector_sink_c()
+        result = blocks.vector_sink_c()
+        self.tb.connect(src, bbheader, bbscrambler, bch, ldpc, interleaver, modulator, cellinterleaver)
+        self.tb.connect(cellinterleaver, framemapper, freqinterleaver, pilotgenerator, paprtr, gi_p1_insertion, expected)
+        self.tb.connect(src, gateway, result)
+        self.tb.run()
+        self.assertTrue(len(result.data()) > 0)
+        self.assertEqual(len(expected.data()), len(result.data()))
+        self.assertComplexTuplesAlmostEqual(expected.data(), result.data(), 6)
+
+    def test_002_pipeline (self):
+        # the pipeline engines must match the single thread engine
+        random.seed(2)
+        data = []
+        for i in range(120):
+            data += [0x47] + [random.randint(0, 255) for j in range(187)]
+        args = (dvbt2.FECFRAME_SHORT, dvbt2.C2_3, dvbt2.MOD_64QAM, dvbt2.ROTATION_ON, 3, 1, dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.GI_1_8, dvbt2.L1_MOD_QPSK, dvbt2.PILOT_PP4, 2, 20, dvbt2.PAPR_OFF, dvbt2.VERSION_111, dvbt2.PREAMBLE_T2_MISO, dvbt2.INPUTMODE_NORMAL, dvbt2.RESERVED_OFF, dvbt2.L1_SCRAMBLED_OFF, dvbt2.INBAND_OFF, 4000000, dvbt2.MISO_TX2, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, 3.3, 3, 2.5, 2.0, 1.4, 1)
+        src = blocks.vector_source_b(data, False)
+        single = dvbt2.gateway_bc(*(args + (dvbt2.ENGINE_SINGLE, 2, [])))
+        poll = dvbt2.gateway_bc(*(args + (dvbt2.ENGINE_PIPELINE_POLL, 1, [])))
+        futex = dvbt2.gateway_bc(*(args + (dvbt2.ENGINE_PIPELINE_FUTEX, 3, [])))
+        expected = blocks.vector_sink_c()
+        result1 = blocks.vector_sink_c()
+        result2 = blocks.vector_sink_c()
+        self.tb.connect(src, single, expected)
+        self.tb.connect(src, poll, result1)
+        self.tb.connect(src, futex, result2)
+        self.tb.run()
+        self.assertTrue(len(expected.data()) > 0)
+        self.assertEqual(expected.data(), result1.data())
+        self.assertEqual(expected.data(), result2.data())
+
+    def test_003_parallel (self):
+        # frames finished out of order by the workers must come back
+        # in order, with the right frame numbers in L1
+        random.seed(3)
+        data = []
+        for i in range(200):
+            data += [0x47] + [random.randint(0, 255) for j in range(187)]
+        args = (dvbt2.FECFRAME_SHORT, dvbt2.C1_2, dvbt2.MOD_16QAM, dvbt2.ROTATION_ON, 2, 1, dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.GI_1_8, dvbt2.L1_MOD_QPSK, dvbt2.PILOT_PP4, 3, 20, dvbt2.PAPR_OFF, dvbt2.VERSION_111, dvbt2.PREAMBLE_T2_SISO, dvbt2.INPUTMODE_NORMAL, dvbt2.RESERVED_OFF, dvbt2.L1_SCRAMBLED_OFF, dvbt2.INBAND_OFF, 4000000, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, 3.3, 3, 2.5, 2.0, 1.4, 1)
+        src = blocks.vector_source_b(data, False)
+        single = dvbt2.gateway_bc(*(args + (dvbt2.ENGINE_SINGLE, 2, [])))
+        one = dvbt2.gateway_bc(*(args + (dvbt2.ENGINE_PARALLEL, 1, [-1])))
+        four = dvbt2.gateway_bc(*(args + (dvbt2.ENGINE_PARALLEL, 2, [-1, -1, -1, -1])))
+        expected = blocks.vector_sink_c()
+        result1 = blocks.vector_sink_c()
+        result2 = blocks.vector_sink_c()
+        self.tb.connect(src, single, expected)
+        self.tb.connect(src, one, result1)
+        self.tb.connect(src, four, result2)
+        self.tb.run()
+        self.assertTrue(len(expected.data()) > 0)
+        self.assertEqual(expected.data(), result1.data())
+        self.assertEqual(expected.data(), result2.data())
+
+    def test_004_perf (self):
+        # the counters must match what came out
+        random.seed(4)
+        data = []
+        for i in range(60):
+            data += [0x47] + [random.randint(0, 255) for j in range(187)]
+        args = (dvbt2.FECFRAME_SHORT, dvbt2.C1_2, dvbt2.MOD_16QAM, dvbt2.ROTATION_ON, 2, 1, dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.GI_1_8, dvbt2.L1_MOD_QPSK, dvbt2.PILOT_PP4, 2, 20, dvbt2.PAPR_OFF, dvbt2.VERSION_111, dvbt2.PREAMBLE_T2_SISO, dvbt2.INPUTMODE_NORMAL, dvbt2.RESERVED_OFF, dvbt2.L1_SCRAMBLED_OFF, dvbt2.INBAND_OFF, 4000000, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, 3.3, 3)
+        src = blocks.vector_source_b(data, False)
+        gateway = dvbt2.gateway_bc(*args)
+        gateway.set_hardware_counters(True)
+        result = blocks.vector_sink_c()
+        self.tb.connect(src, gateway, result)
+        self.tb.run()
+        perf = gateway.perf()
+        self.assertTrue(perf.frames > 0)
+        self.assertEqual(perf.items, len(result.data()))
+        self.assertEqual(perf.frames, len(result.data()) // gateway.output_multiple())
+        self.assertTrue(perf.work_ns > 0)
+        gateway.reset_perf()
+        self.assertEqual(gateway.perf().work_calls, 0)
+
+    def test_005_trace (self):
+        # the trace must be valid Chrome trace JSON with the chain's units
+        random.seed(5)
+        data = []
+        for i in range(60):
+            data += [0x47] + [random.randint(0, 255) for j in range(187)]
+        args = (dvbt2.FECFRAME_SHORT, dvbt2.C1_2, dvbt2.MOD_16QAM, dvbt2.ROTATION_ON, 2, 1, dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.GI_1_8, dvbt2.L1_MOD_QPSK, dvbt2.PILOT_PP4, 2, 20, dvbt2.PAPR_OFF, dvbt2.VERSION_111, dvbt2.PREAMBLE_T2_SISO, dvbt2.INPUTMODE_NORMAL, dvbt2.RESERVED_OFF, dvbt2.L1_SCRAMBLED_OFF, dvbt2.INBAND_OFF, 4000000, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, 3.3, 3)
+        src = blocks.vector_source_b(data, False)
+        gateway = dvbt2.gateway_bc(*args)
+        result = blocks.vector_sink_c()
+        self.tb.connect(src, gateway, result)
+        dvbt2.tracer.start()
+        self.tb.run()
+        dvbt2.tracer.stop()
+        (fd, path) = tempfile.mkstemp(suffix = ".json")
+        os.close(fd)
+        self.assertTrue(dvbt2.tracer.write(path))
+        events = json.load(open(path))["traceEvents"]
+        os.remove(path)
+        frames = len(result.data()) // gateway.output_multiple()
+        self.assertEqual(len([e for e in events if e["name"] == "t2_frame"]), frames)
+        self.assertEqual(len([e for e in events if e["name"] == "ldpc_bb"]), frames * 2)
+        self.assertEqual(len([e for e in events if e["name"] == "ofdm_symbol"]), frames * 36)
+        self.assertTrue(len([e for e in events if e.get("cat") == "work"]) > 0)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_gateway_bc, "qa_gateway_bc.xml")
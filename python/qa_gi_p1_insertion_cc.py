@@ -0,0 +1,59 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+# 
+# Copyright 2014 Ron Economos.
+# 
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+# 
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+# 
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+from gnuradio import digital
+import dvbt2_swig as dvbt2
+import random
+
+class qa_gi_p1_insertion_cc (gr_unittest.TestCase):
+
+    def setUp (self):
+        self.tb = gr.top_block ()
+
+    def tearDown (self):
+        self.tb = None
+
+    def test_001_t (self):
+        # must match an OFDM cyclic prefixer followed by p1insertion_cc
+        fftsize = 1024
+        numdatasyms = 4
+        frames = 3
+        random.seed(1)
+        data = [complex(random.random(), random.random()) for i in range(fftsize * (numdatasyms + 16) * frames)]
+        for (guardinterval, gi) in [(dvbt2.GI_1_32, fftsize / 32), (dvbt2.GI_1_4, fftsize / 4), (dvbt2.GI_1_128, fftsize / 128), (dvbt2.GI_19_128, (fftsize * 19) / 128), (dvbt2.GI_19_256, (fftsize * 19) / 256)]:
+            src = blocks.vector_source_c(data, False, fftsize)
+            prefixer = digital.ofdm_cyclic_prefixer(fftsize, fftsize + gi, 0, "")
+            p1 = dvbt2.p1insertion_cc(dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, guardinterval, numdatasyms, dvbt2.PREAMBLE_T2_SISO, dvbt2.SHOWLEVELS_OFF, 3.3)
+            expected = blocks.vector_sink_c()
+            gip1 = dvbt2.gi_p1_insertion_cc(dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, guardinterval, numdatasyms, dvbt2.PREAMBLE_T2_SISO)
+            result = blocks.vector_sink_c()
+            tb = gr.top_block()
+            tb.connect(src, prefixer, p1, expected)
+            tb.connect(src, gip1, result)
+            tb.run()
+            self.assertEqual(len(result.data()), ((numdatasyms + 16) * (fftsize + gi) + 2048) * frames)
+            self.assertComplexTuplesAlmostEqual(expected.data(), result.data(), 6)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_gi_p1_insertion_cc, "qa_gi_p1_insertion_cc.xml")
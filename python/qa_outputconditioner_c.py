@@ -0,0 +1,74 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+# 
+# Copyright 2014 Ron Economos.
+# 
+# This is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+# 
+# This software is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with this software; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+# 
+
+from gnuradio import gr, gr_unittest
+from gnuradio import blocks
+import dvbt2_swig as dvbt2
+
+class qa_outputconditioner_c (gr_unittest.TestCase):
+
+    def setUp (self):
+        self.tb = gr.top_block ()
+
+    def tearDown (self):
+        self.tb = None
+
+    def test_001_t (self):
+        # gain and clipping on complex float output
+        data = (complex(1.0, -2.0), complex(6.0, 0.5), complex(-8.0, 8.0), complex(0.0, -4.0))
+        src = blocks.vector_source_c(data)
+        conditioner = dvbt2.outputconditioner_c(0.2, dvbt2.CLIPPING_ON, 1.0, dvbt2.OUTPUT_FC32)
+        dst = blocks.vector_sink_c()
+        self.tb.connect(src, conditioner, dst)
+        self.tb.run()
+        expected = (complex(0.2, -0.4), complex(1.0, 0.1), complex(-1.0, 1.0), complex(0.0, -0.8))
+        self.assertComplexTuplesAlmostEqual(expected, dst.data(), 6)
+        self.assertEqual(conditioner.clipped_samples(), 3)
+        self.assertEqual(conditioner.total_samples(), 8)
+
+    def test_002_t (self):
+        # interleaved 16 bit output, 1.0 is full scale
+        data = (complex(0.5, -0.5), complex(1.0, -1.0), complex(0.25, 0.0))
+        src = blocks.vector_source_c(data)
+        conditioner = dvbt2.outputconditioner_c(1.0, dvbt2.CLIPPING_OFF, 1.0, dvbt2.OUTPUT_SC16)
+        dst = blocks.vector_sink_s(2)
+        self.tb.connect(src, conditioner, dst)
+        self.tb.run()
+        self.assertEqual(dst.data(), (16384, -16384, 32767, -32767, 8192, 0))
+
+    def test_003_t (self):
+        # the second output carries the conditioned samples as complex float
+        data = (complex(0.5, -0.5), complex(3.0, -1.0), complex(0.25, 0.0))
+        src = blocks.vector_source_c(data)
+        conditioner = dvbt2.outputconditioner_c(0.5, dvbt2.CLIPPING_ON, 1.0, dvbt2.OUTPUT_SC16)
+        dst = blocks.vector_sink_s(2)
+        dstc = blocks.vector_sink_c()
+        self.tb.connect(src, conditioner)
+        self.tb.connect((conditioner, 0), dst)
+        self.tb.connect((conditioner, 1), dstc)
+        self.tb.run()
+        self.assertEqual(dst.data(), (8192, -8192, 32767, -16384, 4096, 0))
+        self.assertComplexTuplesAlmostEqual((complex(0.25, -0.25), complex(1.0, -0.5), complex(0.125, 0.0)), dstc.data(), 6)
+        self.assertEqual(conditioner.clipped_samples(), 1)
+
+
+if __name__ == '__main__':
+    gr_unittest.run(qa_outputconditioner_c, "qa_outputconditioner_c.xml")
@@ -22,6 +22,9 @@
 from gnuradio import gr, gr_unittest
 from gnuradio import blocks
 import dvbt2_swig as dvbt2
+import math
+import numpy
+import random
 
 class qa_paprtr_cc (gr_unittest.TestCase):
 
@@ -31,10 +34,55 @@ class qa_paprtr_cc (gr_unittest.TestCase):
     def tearDown (self):
         self.tb = None
 
+    def run_tr (self, data, iterations, peaks, separation, budget = 0.0):
+        src = blocks.vector_source_c(data, False, self.vlength)
+        tr = dvbt2.paprtr_cc(dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.PILOT_PP3, dvbt2.GI_1_4, self.numdatasyms, dvbt2.PAPR_TR, dvbt2.VERSION_131, self.vclip, iterations, self.vlength, peaks, separation, 0.01, budget)
+        dst = blocks.vector_sink_c(self.vlength)
+        tb = gr.top_block()
+        tb.connect(src, tr, dst)
+        tb.run()
+        return (dst.data(), tr)
+
+    def gaussian (self, frames):
+        # Gaussian samples stand in for the OFDM symbols from pilotgenerator_cc
+        self.vlength = 1024
+        self.numdatasyms = 10
+        self.vclip = 2.8
+        random.seed(1)
+        scale = 1.0 / math.sqrt(2.0)
+        # 1K has 16 P2 symbols
+        return [complex(random.gauss(0, scale), random.gauss(0, scale)) for i in range(self.vlength * (self.numdatasyms + 16) * frames)]
+
     def test_001_t (self):
-        # set up fg
-        self.tb.run ()
-        # check data
+        # tone reservation only moves the reserved tones, 10 in 1K,
+        # and never raises the PAPR
+        data = self.gaussian(20)
+        before = numpy.array(data).reshape(-1, self.vlength)
+        for (iterations, peaks, separation) in [(1, 1, 1), (10, 1, 1), (40, 1, 1), (5, 8, 16), (3, 16, 16)]:
+            (out, tr) = self.run_tr(data, iterations, peaks, separation)
+            after = numpy.array(out).reshape(-1, self.vlength)
+            self.assertEqual(len(after), len(before))
+            change = numpy.abs(numpy.fft.fft(after - before, axis = 1)) ** 2
+            change.sort(axis = 1)
+            for symbol in change:
+                self.assertLessEqual(numpy.sum(symbol[:-10]), 1.0e-6 * numpy.sum(symbol) + 1.0e-9)
+            self.assertLessEqual(tr.papr_after(), tr.papr_before())
+            ccdf = tr.ccdf()
+            self.assertEqual(len(ccdf), 160)
+            for k in range(1, len(ccdf)):
+                self.assertLessEqual(ccdf[k], ccdf[k - 1])
+            self.assertLessEqual(tr.total_iterations(), tr.processed_symbols() * iterations)
+
+    def test_002_budget (self):
+        # a frame budget far below the cost of one iteration stops
+        # symbols short, and counts them
+        data = self.gaussian(10)
+        (out, unlimited) = self.run_tr(data, 40, 1, 1)
+        (out, limited) = self.run_tr(data, 40, 1, 1, 0.001)
+        self.assertEqual(unlimited.under_processed_symbols(), 0)
+        self.assertEqual(limited.processed_symbols(), unlimited.processed_symbols())
+        self.assertGreater(limited.under_processed_symbols(), 0)
+        self.assertLess(limited.total_iterations(), unlimited.total_iterations())
 
 
 if __name__ == '__main__':
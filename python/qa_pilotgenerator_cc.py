@@ -22,6 +22,9 @@
 from gnuradio import gr, gr_unittest
 from gnuradio import blocks
 import dvbt2_swig as dvbt2
+import math
+import numpy
+import random
 
 class qa_pilotgenerator_cc (gr_unittest.TestCase):
 
@@ -36,6 +39,93 @@ class qa_pilotgenerator_cc (gr_unittest.TestCase):
         self.tb.run ()
         # check data
 
+    def test_002_miso_both (self):
+        # must match miso_cc followed by a TX1 and a TX2 pilot generator
+        fftsize = 1024
+        numdatasyms = 4
+        random.seed(1)
+        data = [complex(random.choice([-0.7071, 0.7071]), random.choice([-0.7071, 0.7071])) for i in range(40000)]
+        args = (dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.PILOT_PP1, dvbt2.GI_1_8, numdatasyms, dvbt2.PAPR_OFF, dvbt2.VERSION_111, dvbt2.PREAMBLE_T2_MISO)
+        src = blocks.vector_source_c(data, False)
+        miso = dvbt2.miso_cc(*args[:6])
+        tx1 = dvbt2.pilotgenerator_cc(*(args + (dvbt2.MISO_TX1, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, fftsize)))
+        tx2 = dvbt2.pilotgenerator_cc(*(args + (dvbt2.MISO_TX2, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, fftsize)))
+        both = dvbt2.pilotgenerator_cc(*(args + (dvbt2.MISO_BOTH, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, fftsize)))
+        expected1 = blocks.vector_sink_c(fftsize)
+        expected2 = blocks.vector_sink_c(fftsize)
+        result1 = blocks.vector_sink_c(fftsize)
+        result2 = blocks.vector_sink_c(fftsize)
+        self.tb.connect(src, miso)
+        self.tb.connect((miso, 0), tx1, expected1)
+        self.tb.connect((miso, 1), tx2, expected2)
+        self.tb.connect(src, both)
+        self.tb.connect((both, 0), result1)
+        self.tb.connect((both, 1), result2)
+        self.tb.run()
+        self.assertTrue(len(result1.data()) >= 3 * (numdatasyms + 16) * fftsize)
+        self.assertEqual(len(result1.data()), len(result2.data()))
+        self.assertComplexTuplesAlmostEqual(expected1.data(), result1.data(), 6)
+        self.assertComplexTuplesAlmostEqual(expected2.data(), result2.data(), 6)
+
+    def run_ace (self, data, paprmode, rotation):
+        fftsize = 1024
+        tb = gr.top_block()
+        src = blocks.vector_source_c(data, False)
+        pilotgenerator = dvbt2.pilotgenerator_cc(dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.PILOT_PP3, dvbt2.GI_1_4, 4, paprmode, dvbt2.VERSION_131, dvbt2.PREAMBLE_T2_SISO, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, fftsize, dvbt2.MOD_16QAM, rotation, 2.5, 2.0, 1.4, 2)
+        dst = blocks.vector_sink_c(fftsize)
+        tb.connect(src, pilotgenerator, dst)
+        tb.run()
+        # the data symbols, after the 16 P2 symbols of each frame
+        symbols = numpy.array(dst.data()).reshape(-1, 20, fftsize)[:, 16:, :].reshape(-1, fftsize)
+        return (symbols, numpy.fft.fft(symbols, axis = 1))
+
+    def papr (self, symbols):
+        power = numpy.abs(symbols) ** 2
+        return numpy.max(power) / numpy.mean(power)
+
+    def test_003_ace (self):
+        # against the same cells without ACE, only outer 16QAM
+        # components move and only away from the origin, and the
+        # PAPR drops
+        random.seed(1)
+        levels = [-3.0 / math.sqrt(10.0), -1.0 / math.sqrt(10.0), 1.0 / math.sqrt(10.0), 3.0 / math.sqrt(10.0)]
+        data = [complex(random.choice(levels), random.choice(levels)) for i in range(40000)]
+        for (paprmode, reference) in [(dvbt2.PAPR_ACE, dvbt2.PAPR_OFF), (dvbt2.PAPR_BOTH, dvbt2.PAPR_TR)]:
+            (before, cells) = self.run_ace(data, reference, dvbt2.ROTATION_OFF)
+            (after, extended) = self.run_ace(data, paprmode, dvbt2.ROTATION_OFF)
+            self.assertTrue(len(before) >= 3 * 4)
+            self.assertEqual(len(after), len(before))
+            self.assertLess(self.papr(after), self.papr(before))
+            original = numpy.concatenate((cells.real, cells.imag)).flatten()
+            moved = numpy.concatenate((extended.real, extended.imag)).flatten()
+            tolerance = 1.0e-4 * numpy.max(numpy.abs(original))
+            self.assertTrue(numpy.all(numpy.sign(original) * moved >= numpy.abs(original) - tolerance))
+            changed = numpy.abs(moved - original) > tolerance
+            self.assertTrue(numpy.any(changed))
+            inner = numpy.min(numpy.abs(original)[numpy.abs(original) > tolerance])
+            self.assertTrue(numpy.all(numpy.abs(numpy.abs(original[changed]) - 3.0 * inner) < 1.0e-3 * inner))
+
+    def run_papr (self, data, paprmode, *rest):
+        fftsize = 1024
+        tb = gr.top_block()
+        src = blocks.vector_source_c(data, False)
+        pilotgenerator = dvbt2.pilotgenerator_cc(*((dvbt2.CARRIERS_NORMAL, dvbt2.FFTSIZE_1K, dvbt2.PILOT_PP3, dvbt2.GI_1_4, 4, paprmode, dvbt2.VERSION_131, dvbt2.PREAMBLE_T2_SISO, dvbt2.MISO_TX1, dvbt2.EQUALIZATION_OFF, dvbt2.BANDWIDTH_8_0_MHZ, fftsize) + rest))
+        dst = blocks.vector_sink_c(fftsize)
+        tb.connect(src, pilotgenerator, dst)
+        tb.run()
+        return dst.data()
+
+    def test_004_ace_rotation (self):
+        # with rotation on ACE is left out and the rest runs as without
+        # it, also for the argument list from before ACE
+        random.seed(1)
+        data = [complex(random.choice([-0.7071, 0.7071]), random.choice([-0.7071, 0.7071])) for i in range(40000)]
+        for (paprmode, reference) in [(dvbt2.PAPR_ACE, dvbt2.PAPR_OFF), (dvbt2.PAPR_BOTH, dvbt2.PAPR_TR)]:
+            expected = self.run_papr(data, reference)
+            self.assertTrue(len(expected) >= 3 * 20 * 1024)
+            self.assertComplexTuplesAlmostEqual(expected, self.run_papr(data, paprmode), 6)
+            self.assertComplexTuplesAlmostEqual(expected, self.run_papr(data, paprmode, dvbt2.MOD_QPSK, dvbt2.ROTATION_ON), 6)
+
 
 if __name__ == '__main__':
     gr_unittest.run(qa_pilotgenerator_cc, "qa_pilotgenerator_cc.xml")
@@ -9,6 +9,8 @@
 
 %{
 #include "dvbt2/dvbt2_config.h"
+#include "dvbt2/perf_block.h"
+#include "dvbt2/tracer.h"
 #include "dvbt2/bbheader_bb.h"
 #include "dvbt2/bbscrambler_bb.h"
 #include "dvbt2/bch_bb.h"
@@ -20,12 +22,17 @@
 #include "dvbt2/freqinterleaver_cc.h"
 #include "dvbt2/pilotgenerator_cc.h"
 #include "dvbt2/p1insertion_cc.h"
+#include "dvbt2/gi_p1_insertion_cc.h"
+#include "dvbt2/outputconditioner_c.h"
 #include "dvbt2/paprtr_cc.h"
 #include "dvbt2/miso_cc.h"
+#include "dvbt2/gateway_bc.h"
 %}
 
 
 %include "dvbt2/dvbt2_config.h"
+%include "dvbt2/perf_block.h"
+%include "dvbt2/tracer.h"
 %include "dvbt2/bbheader_bb.h"
 GR_SWIG_BLOCK_MAGIC2(dvbt2, bbheader_bb);
 %include "dvbt2/bbscrambler_bb.h"
@@ -49,7 +56,13 @@ GR_SWIG_BLOCK_MAGIC2(dvbt2, freqinterleaver_cc);
 GR_SWIG_BLOCK_MAGIC2(dvbt2, pilotgenerator_cc);
 %include "dvbt2/p1insertion_cc.h"
 GR_SWIG_BLOCK_MAGIC2(dvbt2, p1insertion_cc);
+%include "dvbt2/gi_p1_insertion_cc.h"
+GR_SWIG_BLOCK_MAGIC2(dvbt2, gi_p1_insertion_cc);
+%include "dvbt2/outputconditioner_c.h"
+GR_SWIG_BLOCK_MAGIC2(dvbt2, outputconditioner_c);
 %include "dvbt2/paprtr_cc.h"
 GR_SWIG_BLOCK_MAGIC2(dvbt2, paprtr_cc);
 %include "dvbt2/miso_cc.h"
 GR_SWIG_BLOCK_MAGIC2(dvbt2, miso_cc);
+%include "dvbt2/gateway_bc.h"
+GR_SWIG_BLOCK_MAGIC2(dvbt2, gateway_bc);